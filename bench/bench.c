@@ -0,0 +1,47 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include "bench.h"
+
+#ifdef _WIN32
+#include <windows.h>
+
+double bench_time()
+{
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+}
+#else
+#include <time.h>
+
+double bench_time()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+#endif
+
+static uint32_t bench_state = 0x9E3779B9u;
+
+void bench_seed(uint32_t seed)
+{
+    bench_state = seed ? seed : 0x9E3779B9u;
+}
+
+uint32_t bench_rand()
+{
+    uint32_t x = bench_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return bench_state = x;
+}
+
+float bench_randf(float min, float max)
+{
+    return min + (max - min) * ((float)(bench_rand() >> 8) / 16777216.0f);
+}
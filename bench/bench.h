@@ -0,0 +1,85 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* monotonic time in seconds */
+double bench_time();
+
+/* xorshift rng so every run generates the same scenes */
+void bench_seed(uint32_t seed);
+uint32_t bench_rand();
+float bench_randf(float min, float max);
+
+// ---------------| SCENE |------------------------------
+#include "gjk.h"
+
+#define BENCH_MAX_VERTS 12
+
+/* random circles and convex polygons moving around in a square area */
+typedef struct
+{
+    gjk_shape* shapes;
+    gjk_vec2* velocities;
+    gjk_vec2* vertices;
+    size_t count;
+    float area;
+} bench_scene;
+
+void bench_scene_create(bench_scene* scene, size_t count, float area, float min_radius, float max_radius);
+void bench_scene_destroy(bench_scene* scene);
+
+void bench_scene_step(bench_scene* scene, float dt);
+
+// ---------------| GJK |--------------------------------
+void bench_gjk_batch();
+void bench_gjk_hill_climb();
+void bench_gjk_simd();
+void bench_gjk_shapes();
+void bench_gjk_intersect();
+void bench_gjk_distance();
+void bench_gjk_warm_start();
+void bench_gjk_bounds();
+void bench_epa();
+
+// ---------------| GJK3D |------------------------------
+void bench_gjk3d();
+
+// ---------------| BROADPHASE |-------------------------
+void bench_aabb_tree();
+void bench_spatial_hash();
+void bench_sweep_prune();
+
+// ---------------| QUERIES |----------------------------
+void bench_raycast();
+
+// ---------------| NARROWPHASE |------------------------
+void bench_narrowphase();
+void bench_manifold();
+
+// ---------------| CONTINUOUS |-------------------------
+void bench_toi();
+
+// ---------------| MATH |-------------------------------
+void bench_mat4();
+void bench_vec3_batch();
+void bench_math_inline();
+void bench_quat();
+
+/* linmath.h reference, the matrices are 16 floats in column major order */
+void bench_linmath_multiply(float* result, const float* l, const float* r, size_t count);
+void bench_linmath_invert(float* result, const float* m, size_t count);
+void bench_linmath_rotate_x(float* result, const float* m, const float* angles, size_t count);
+void bench_linmath_look_at(float* result, const float* eyes, const float* targets, size_t count);
+void bench_linmath_from_quat(float* result, const float* quats, size_t count);
+float bench_linmath_vec3_chain(const float* a, const float* b, size_t count);
+void bench_linmath_translate_multiply(float* result, const float* m, const float* positions, size_t count);
+
+// ---------------| SCENE |------------------------------
+void bench_scene_graph();
+
+// ---------------| DYNAMICS |---------------------------
+void bench_world();
+
+#endif // !BENCH_H
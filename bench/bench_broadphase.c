@@ -0,0 +1,270 @@
+#include "bench.h"
+
+#include "aabb_tree.h"
+#include "spatial_hash.h"
+#include "sweep_prune.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define BENCH_TREE_SHAPES   50000
+#define BENCH_TREE_TICKS    60
+#define BENCH_TREE_MARGIN   0.1f
+#define BENCH_DT            (1.0f / 60.0f)
+
+static size_t bench_count_collisions(const gjk_shape* shapes, const gjk_pair* pairs, size_t count, gjk_result** results, size_t* capacity)
+{
+    if (count > *capacity)
+    {
+        *capacity = count;
+        *results = realloc(*results, sizeof(gjk_result) * count);
+    }
+
+    gjk_collide_batch(shapes, pairs, count, *results);
+
+    size_t collisions = 0;
+    for (size_t i = 0; i < count; ++i)
+        collisions += (*results)[i].collision;
+    return collisions;
+}
+
+/* brute force reference, rejects pairs by their aabbs before running gjk */
+static size_t bench_all_pairs(const gjk_shape* shapes, size_t count)
+{
+    gjk_aabb* aabbs = malloc(sizeof(gjk_aabb) * count);
+    for (size_t i = 0; i < count; ++i)
+        aabbs[i] = gjk_shape_aabb(&shapes[i]);
+
+    size_t collisions = 0;
+    for (size_t i = 0; i < count; ++i)
+        for (size_t j = i + 1; j < count; ++j)
+            if (gjk_aabb_overlap(aabbs[i], aabbs[j]))
+                collisions += gjk_collision(&shapes[i], &shapes[j], NULL);
+
+    free(aabbs);
+    return collisions;
+}
+
+void bench_aabb_tree()
+{
+    bench_scene scene;
+    aabb_tree tree;
+    gjk_result* results = NULL;
+    size_t capacity = 0;
+
+    /* validate against all pairs on a small scene */
+    bench_seed(2);
+    bench_scene_create(&scene, 2000, 60.0f, 0.5f, 1.5f);
+    aabb_tree_init(&tree, BENCH_TREE_MARGIN);
+
+    int32_t* proxies = malloc(sizeof(int32_t) * BENCH_TREE_SHAPES);
+    for (size_t i = 0; i < scene.count; ++i)
+        proxies[i] = aabb_tree_insert(&tree, gjk_shape_aabb(&scene.shapes[i]), (uint32_t)i);
+
+    size_t pairs = aabb_tree_update_pairs(&tree);
+    size_t collisions = bench_count_collisions(scene.shapes, tree.pairs, pairs, &results, &capacity);
+    size_t expected = bench_all_pairs(scene.shapes, scene.count);
+
+    printf("aabb_tree: %zu shapes, %zu candidates, %zu collisions, %zu expected\n", scene.count, pairs, collisions, expected);
+
+    aabb_tree_destroy(&tree);
+    bench_scene_destroy(&scene);
+
+    /* moving scene */
+    bench_seed(3);
+    bench_scene_create(&scene, BENCH_TREE_SHAPES, 700.0f, 0.5f, 1.5f);
+    aabb_tree_init(&tree, BENCH_TREE_MARGIN);
+
+    /* the first update queries every leaf, it is part of the build */
+    double start = bench_time();
+    for (size_t i = 0; i < scene.count; ++i)
+        proxies[i] = aabb_tree_insert(&tree, gjk_shape_aabb(&scene.shapes[i]), (uint32_t)i);
+    aabb_tree_update_pairs(&tree);
+    double build_time = bench_time() - start;
+
+    double move_time = 0.0, pair_time = 0.0, narrow_time = 0.0;
+    size_t reinserted = 0;
+    pairs = collisions = 0;
+
+    for (int tick = 0; tick < BENCH_TREE_TICKS; ++tick)
+    {
+        bench_scene_step(&scene, BENCH_DT);
+
+        start = bench_time();
+        for (size_t i = 0; i < scene.count; ++i)
+        {
+            gjk_vec2 displacement = { scene.velocities[i].x * BENCH_DT, scene.velocities[i].y * BENCH_DT };
+            reinserted += aabb_tree_move(&tree, proxies[i], gjk_shape_aabb(&scene.shapes[i]), displacement);
+        }
+        move_time += bench_time() - start;
+
+        start = bench_time();
+        pairs += aabb_tree_update_pairs(&tree);
+        pair_time += bench_time() - start;
+
+        start = bench_time();
+        collisions += bench_count_collisions(scene.shapes, tree.pairs, tree.pair_count, &results, &capacity);
+        narrow_time += bench_time() - start;
+    }
+
+    double ms = 1000.0 / BENCH_TREE_TICKS;
+    printf("aabb_tree: %d moving shapes, height %d, build %.2f ms\n", BENCH_TREE_SHAPES, aabb_tree_get_height(&tree), build_time * 1000.0);
+    printf("  move:        %8.3f ms/tick (%zu reinserts/tick)\n", move_time * ms, reinserted / BENCH_TREE_TICKS);
+    printf("  pairs:       %8.3f ms/tick (%zu candidates/tick)\n", pair_time * ms, pairs / BENCH_TREE_TICKS);
+    printf("  narrowphase: %8.3f ms/tick (%zu collisions/tick)\n", narrow_time * ms, collisions / BENCH_TREE_TICKS);
+    printf("  tick:        %8.3f ms/tick, %8.3f ms without the narrowphase (60 Hz: %.1f ms)\n",
+        (move_time + pair_time + narrow_time) * ms, (move_time + pair_time) * ms, BENCH_DT * 1000.0f);
+
+    aabb_tree_destroy(&tree);
+    bench_scene_destroy(&scene);
+    free(proxies);
+    free(results);
+}
+
+static size_t bench_collide_pairs(const gjk_shape* shapes, const gjk_pair* pairs, size_t count)
+{
+    size_t collisions = 0;
+    for (size_t i = 0; i < count; ++i)
+        collisions += gjk_collision(&shapes[pairs[i].a], &shapes[pairs[i].b], NULL);
+    return collisions;
+}
+
+void bench_spatial_hash()
+{
+    printf("spatial_hash: crossover against all pairs and aabb_tree (ns/frame)\n");
+    printf("  %6s %14s %14s %14s %10s\n", "shapes", "all pairs", "spatial_hash", "aabb_tree*", "collisions");
+
+    size_t crossover = 0;
+    for (size_t n = 8; n <= 8192; n *= 2)
+    {
+        bench_scene scene;
+        spatial_hash hash;
+        aabb_tree tree;
+
+        /* keep the density constant */
+        bench_seed(4);
+        bench_scene_create(&scene, n, sqrtf((float)n) * 4.0f, 0.5f, 1.5f);
+        spatial_hash_init(&hash, 3.0f);
+        aabb_tree_init(&tree, BENCH_TREE_MARGIN);
+
+        for (size_t i = 0; i < scene.count; ++i)
+            aabb_tree_insert(&tree, gjk_shape_aabb(&scene.shapes[i]), (uint32_t)i);
+        aabb_tree_update_pairs(&tree);
+
+        size_t repeat = 1 + (1 << 24) / (n * n);
+        size_t all_collisions = 0, hash_collisions = 0, tree_collisions = 0;
+
+        double start = bench_time();
+        for (size_t r = 0; r < repeat; ++r)
+            all_collisions = bench_all_pairs(scene.shapes, n);
+        double all_time = bench_time() - start;
+
+        start = bench_time();
+        for (size_t r = 0; r < repeat; ++r)
+        {
+            spatial_hash_build(&hash, scene.shapes, n);
+            spatial_hash_update_pairs(&hash);
+            hash_collisions = bench_collide_pairs(scene.shapes, hash.pairs, hash.pair_count);
+        }
+        double hash_time = bench_time() - start;
+
+        start = bench_time();
+        for (size_t r = 0; r < repeat; ++r)
+        {
+            aabb_tree_update_pairs(&tree);
+            tree_collisions = bench_collide_pairs(scene.shapes, tree.pairs, tree.pair_count);
+        }
+        double tree_time = bench_time() - start;
+
+        if (!crossover && hash_time < all_time) crossover = n;
+
+        printf("  %6zu %14.0f %14.0f %14.0f %10zu", n, all_time * 1e9 / repeat, hash_time * 1e9 / repeat, tree_time * 1e9 / repeat, hash_collisions);
+        if ((all_collisions != hash_collisions || all_collisions != tree_collisions))
+            printf(" (mismatch: %zu all pairs, %zu tree)", all_collisions, tree_collisions);
+        printf("\n");
+
+        spatial_hash_destroy(&hash);
+        aabb_tree_destroy(&tree);
+        bench_scene_destroy(&scene);
+    }
+
+    printf("  * prebuilt tree and pairs, nothing moves between the updates\n");
+    printf("  spatial_hash beats all pairs from %zu shapes\n", crossover);
+}
+
+#define BENCH_SWEEP_GRID 16
+
+/* boxes on a grid touch their neighbours exactly, inserting them one by one has to find the pairs of a full build */
+static void bench_sweep_prune_ties()
+{
+    gjk_shape* boxes = malloc(sizeof(gjk_shape) * BENCH_SWEEP_GRID * BENCH_SWEEP_GRID);
+    for (int y = 0; y < BENCH_SWEEP_GRID; ++y)
+        for (int x = 0; x < BENCH_SWEEP_GRID; ++x)
+            gjk_box(&boxes[y * BENCH_SWEEP_GRID + x], (gjk_vec2){ (float)x, (float)y }, (gjk_vec2){ 0.5f, 0.5f });
+
+    sweep_prune built, inserted;
+    sweep_prune_init(&built);
+    sweep_prune_init(&inserted);
+
+    sweep_prune_build(&built, boxes, BENCH_SWEEP_GRID * BENCH_SWEEP_GRID);
+    for (uint32_t i = 0; i < BENCH_SWEEP_GRID * BENCH_SWEEP_GRID; ++i)
+        sweep_prune_insert(&inserted, i, gjk_shape_aabb(&boxes[i]));
+
+    printf("  touching grid: %zu pairs built, %zu pairs inserted\n", built.pair_count, inserted.pair_count);
+
+    sweep_prune_destroy(&built);
+    sweep_prune_destroy(&inserted);
+    free(boxes);
+}
+
+void bench_sweep_prune()
+{
+    printf("sweep_prune: coherent scenes (ms/tick)\n");
+    printf("  %6s %10s %10s %10s %12s %12s\n", "shapes", "build", "move", "narrow", "pairs/tick", "events/tick");
+
+    for (size_t n = 1000; n <= 64000; n *= 4)
+    {
+        bench_scene scene;
+        sweep_prune sp;
+        gjk_result* results = NULL;
+        size_t capacity = 0;
+
+        bench_seed(5);
+        bench_scene_create(&scene, n, sqrtf((float)n) * 3.0f, 0.5f, 1.5f);
+        sweep_prune_init(&sp);
+
+        double start = bench_time();
+        sweep_prune_build(&sp, scene.shapes, scene.count);
+        double build_time = bench_time() - start;
+
+        double move_time = 0.0, narrow_time = 0.0;
+        size_t pairs = 0, events = 0;
+        for (int tick = 0; tick < BENCH_TREE_TICKS; ++tick)
+        {
+            sweep_prune_clear_events(&sp);
+            bench_scene_step(&scene, BENCH_DT);
+
+            start = bench_time();
+            for (size_t i = 0; i < scene.count; ++i)
+                sweep_prune_move(&sp, (uint32_t)i, gjk_shape_aabb(&scene.shapes[i]));
+            move_time += bench_time() - start;
+
+            start = bench_time();
+            bench_count_collisions(scene.shapes, sp.pairs, sp.pair_count, &results, &capacity);
+            narrow_time += bench_time() - start;
+
+            pairs += sp.pair_count;
+            events += sp.added_count + sp.removed_count;
+        }
+
+        double ms = 1000.0 / BENCH_TREE_TICKS;
+        printf("  %6zu %10.3f %10.3f %10.3f %12zu %12zu\n", n, build_time * 1000.0, move_time * ms, narrow_time * ms, pairs / BENCH_TREE_TICKS, events / BENCH_TREE_TICKS);
+
+        sweep_prune_destroy(&sp);
+        bench_scene_destroy(&scene);
+        free(results);
+    }
+
+    bench_sweep_prune_ties();
+}
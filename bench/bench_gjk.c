@@ -0,0 +1,937 @@
+#include "bench.h"
+
+#include "sweep_prune.h"
+#include "aabb_tree.h"
+#include "gjk_simd.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <float.h>
+
+#define BENCH_SHAPES     4096
+#define BENCH_PAIRS      65536
+#define BENCH_REPEAT     16
+
+static void bench_random_shape(gjk_shape* shape, gjk_shape_type type, gjk_vec2* vertices);
+
+/* loop over gjk_collision against gjk_collide_batch on the same pairs */
+static void bench_gjk_batch_run(const char* name, const gjk_shape* shapes, const gjk_pair* pairs, gjk_result* loop_results, gjk_result* batch_results)
+{
+    double start = bench_time();
+    for (int r = 0; r < BENCH_REPEAT; ++r)
+    {
+        for (size_t i = 0; i < BENCH_PAIRS; ++i)
+        {
+            const gjk_pair* pair = &pairs[i];
+            loop_results[i].collision = gjk_collision(&shapes[pair->a], &shapes[pair->b], loop_results[i].simplex);
+        }
+    }
+    double loop_time = bench_time() - start;
+
+    start = bench_time();
+    for (int r = 0; r < BENCH_REPEAT; ++r)
+        gjk_collide_batch(shapes, pairs, BENCH_PAIRS, batch_results);
+    double batch_time = bench_time() - start;
+
+    size_t collisions = 0, mismatches = 0;
+    for (size_t i = 0; i < BENCH_PAIRS; ++i)
+    {
+        collisions += batch_results[i].collision;
+        mismatches += batch_results[i].collision != loop_results[i].collision;
+    }
+
+    double queries = (double)BENCH_PAIRS * BENCH_REPEAT;
+    printf("  %s: %zu colliding, %zu mismatches\n", name, collisions, mismatches);
+    printf("    gjk_collision loop: %8.2f ns/pair\n", loop_time * 1e9 / queries);
+    printf("    gjk_collide_batch:  %8.2f ns/pair (%.2fx)\n", batch_time * 1e9 / queries, loop_time / batch_time);
+}
+
+void bench_gjk_batch()
+{
+    bench_scene scene;
+    gjk_pair* pairs = malloc(sizeof(gjk_pair) * BENCH_PAIRS);
+    gjk_result* loop_results = malloc(sizeof(gjk_result) * BENCH_PAIRS);
+    gjk_result* batch_results = malloc(sizeof(gjk_result) * BENCH_PAIRS);
+
+    bench_seed(1);
+    bench_scene_create(&scene, BENCH_SHAPES, 8.0f, 0.5f, 1.5f);
+    for (size_t i = 0; i < BENCH_PAIRS; ++i)
+    {
+        pairs[i].a = bench_rand() % BENCH_SHAPES;
+        pairs[i].b = bench_rand() % BENCH_SHAPES;
+    }
+
+    printf("gjk_collide_batch: %d pairs\n", BENCH_PAIRS);
+    bench_gjk_batch_run("circles and polygons", scene.shapes, pairs, loop_results, batch_results);
+
+    /* the same pairs on every shape type, most of them take the generic path */
+    gjk_shape* mixed = malloc(sizeof(gjk_shape) * BENCH_SHAPES);
+    gjk_vec2* vertices = malloc(sizeof(gjk_vec2) * 6 * BENCH_SHAPES);
+    for (size_t i = 0; i < BENCH_SHAPES; ++i)
+    {
+        bench_random_shape(&mixed[i], (gjk_shape_type)(i % GJK_SHAPE_COUNT), vertices + 6 * i);
+        gjk_set_center(&mixed[i], (gjk_vec2){ bench_randf(-8.0f, 8.0f), bench_randf(-8.0f, 8.0f) });
+    }
+    bench_gjk_batch_run("all shape types", mixed, pairs, loop_results, batch_results);
+
+    bench_scene_destroy(&scene);
+    free(mixed);
+    free(vertices);
+    free(pairs);
+    free(loop_results);
+    free(batch_results);
+}
+
+#define BENCH_HULL_PAIRS 1024
+
+static void bench_hull(gjk_vec2* vertices, size_t count, gjk_vec2 center, float radius)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        float a = 6.2831853f * (float)i / (float)count;
+        vertices[i].x = center.x + radius * cosf(a);
+        vertices[i].y = center.y + radius * sinf(a);
+    }
+}
+
+/* square with collinear points along every side */
+static void bench_square(gjk_vec2* vertices, size_t per_side, float half)
+{
+    const gjk_vec2 corners[4] = { { -half, -half }, { half, -half }, { half, half }, { -half, half } };
+    for (size_t side = 0; side < 4; ++side)
+    {
+        gjk_vec2 a = corners[side], b = corners[(side + 1) % 4];
+        for (size_t i = 0; i < per_side; ++i)
+        {
+            float t = (float)i / (float)per_side;
+            vertices[side * per_side + i] = (gjk_vec2){ a.x + t * (b.x - a.x), a.y + t * (b.y - a.y) };
+        }
+    }
+}
+
+/* hull at sorted random angles, with runs of nearly duplicated vertices */
+static void bench_random_hull(gjk_vec2* vertices, size_t count, float radius)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        float a = (i && bench_rand() % 4 == 0) ? vertices[i - 1].x + bench_randf(0.0f, 1e-5f) : bench_randf(0.0f, 6.2831853f);
+        size_t j = i;
+        for (; j > 0 && vertices[j - 1].x > a; --j)
+            vertices[j] = vertices[j - 1];
+        vertices[j].x = a;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        float a = vertices[i].x;
+        vertices[i] = (gjk_vec2){ radius * cosf(a), radius * sinf(a) };
+    }
+}
+
+/* checks warm started supports against a brute force scan, returns the number of wrong ones */
+static size_t bench_hill_climb_check(gjk_shape* shape, size_t queries, size_t* checks)
+{
+    shape->hill_climb = 1;
+
+    size_t wrong = 0;
+    size_t hint = GJK_NO_HINT;
+    for (size_t q = 0; q < queries; ++q)
+    {
+        /* axis aligned directions hit the plateaus, every other query restarts from a random hint */
+        gjk_vec2 d;
+        if (q % 4 == 0) d = (gjk_vec2){ (float)(bench_rand() % 3) - 1.0f, (float)(bench_rand() % 3) - 1.0f };
+        else            d = (gjk_vec2){ bench_randf(-1.0f, 1.0f), bench_randf(-1.0f, 1.0f) };
+        if (d.x == 0.0f && d.y == 0.0f) d.x = 1.0f;
+        if (q & 1) hint = bench_rand() % shape->count;
+
+        gjk_vec2 p = gjk_furthest_point_hint(shape, d, &hint);
+
+        float max_dot = -FLT_MAX;
+        for (size_t i = 0; i < shape->count; ++i)
+            max_dot = fmaxf(max_dot, gjk_dot_product(d, gjk_get_vertex(shape, i)));
+
+        float scale = sqrtf(gjk_dot_product(d, d)) * shape->bounding_radius;
+        wrong += gjk_dot_product(d, p) < max_dot - 1e-4f * scale;
+    }
+
+    *checks += queries;
+    return wrong;
+}
+
+void bench_gjk_hill_climb()
+{
+    gjk_vec2* check = malloc(sizeof(gjk_vec2) * 4096);
+    size_t checks = 0, wrong = 0;
+
+    bench_seed(5);
+    for (size_t count = 16; count <= 4096; count *= 4)
+    {
+        gjk_shape shape;
+        bench_hull(check, count, (gjk_vec2){ 0.0f, 0.0f }, 10.0f);
+        gjk_poly(&shape, check, count);
+        gjk_set_transform(&shape, (gjk_vec2){ 3.0f, -2.0f }, gjk_rotation(0.7f));
+        wrong += bench_hill_climb_check(&shape, 2048, &checks);
+
+        bench_square(check, count / 4, 8.0f);
+        gjk_poly(&shape, check, count);
+        wrong += bench_hill_climb_check(&shape, 2048, &checks);
+    }
+
+    for (size_t i = 0; i < 256; ++i)
+    {
+        gjk_shape shape;
+        size_t count = 8 + bench_rand() % 248;
+        bench_random_hull(check, count, bench_randf(0.5f, 20.0f));
+        gjk_poly(&shape, check, count);
+        wrong += bench_hill_climb_check(&shape, 256, &checks);
+    }
+    free(check);
+
+    printf("hill climbing: %zu supports checked against a scan, %zu wrong\n", checks, wrong);
+    printf("  gjk + epa against large hulls (ns/query)\n");
+    printf("  %8s %12s %12s %8s\n", "vertices", "scan", "hill climb", "speedup");
+
+    epa_arena arena = { 0 };
+    gjk_vec2* hull = malloc(sizeof(gjk_vec2) * 4096);
+    gjk_vec2* probes = malloc(sizeof(gjk_vec2) * BENCH_HULL_PAIRS * 3);
+    gjk_shape* shapes = malloc(sizeof(gjk_shape) * BENCH_HULL_PAIRS);
+
+    /* small triangles around the rim of the hull, most of them overlapping */
+    bench_seed(6);
+    for (size_t i = 0; i < BENCH_HULL_PAIRS; ++i)
+    {
+        float a = bench_randf(0.0f, 6.2831853f);
+        float r = bench_randf(9.0f, 10.5f);
+        gjk_vec2 c = { r * cosf(a), r * sinf(a) };
+
+        gjk_vec2* v = probes + i * 3;
+        v[0] = (gjk_vec2){ c.x + 1.0f, c.y };
+        v[1] = (gjk_vec2){ c.x - 0.5f, c.y + 0.8f };
+        v[2] = (gjk_vec2){ c.x - 0.5f, c.y - 0.8f };
+        gjk_poly(&shapes[i], v, 3);
+    }
+
+    for (size_t count = 16; count <= 4096; count *= 4)
+    {
+        gjk_shape shape;
+        bench_hull(hull, count, (gjk_vec2){ 0.0f, 0.0f }, 10.0f);
+        gjk_poly(&shape, hull, count);
+
+        double time[2];
+        float depth[2] = { 0.0f, 0.0f };
+        for (int climb = 0; climb < 2; ++climb)
+        {
+            shape.hill_climb = (uint8_t)climb;
+
+            double start = bench_time();
+            for (int r = 0; r < BENCH_REPEAT; ++r)
+            {
+                for (size_t i = 0; i < BENCH_HULL_PAIRS; ++i)
+                {
+                    gjk_vec2 simplex[3], n;
+                    if (gjk_collision(&shape, &shapes[i], simplex))
+                        depth[climb] += epa(&shape, &shapes[i], simplex, &n, &arena, NULL);
+                }
+            }
+            time[climb] = bench_time() - start;
+        }
+
+        double queries = (double)BENCH_HULL_PAIRS * BENCH_REPEAT;
+        printf("  %8zu %12.1f %12.1f %7.2fx", count, time[0] * 1e9 / queries, time[1] * 1e9 / queries, time[0] / time[1]);
+        if (fabsf(depth[0] - depth[1]) > 1e-3f * fabsf(depth[0])) printf(" (depth mismatch)");
+        printf("\n");
+    }
+
+    epa_arena_free(&arena);
+    free(hull);
+    free(probes);
+    free(shapes);
+}
+
+#define BENCH_SIMD_VERTS      4096
+#define BENCH_SIMD_DIRECTIONS 1024
+
+void bench_gjk_simd()
+{
+    gjk_kernel best = gjk_kernel_detect();
+    printf("simd support kernels: detected %s\n", gjk_kernel_name(best));
+
+    float* soa = malloc(sizeof(float) * BENCH_SIMD_VERTS * 2);
+    gjk_vec2* directions = malloc(sizeof(gjk_vec2) * BENCH_SIMD_DIRECTIONS);
+
+    /* verify every kernel against the scalar scan, including ties from duplicated vertices */
+    bench_seed(9);
+    size_t checks = 0, mismatches = 0;
+    for (size_t count = 1; count <= 256; ++count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            soa[i] = (float)(bench_rand() % 16);
+            soa[count + i] = (float)(bench_rand() % 16);
+        }
+
+        for (size_t k = 0; k < 32; ++k)
+        {
+            gjk_vec2 d = { (float)(bench_rand() % 5) - 2.0f, (float)(bench_rand() % 5) - 2.0f };
+            if (k & 1) d = (gjk_vec2){ bench_randf(-1.0f, 1.0f), bench_randf(-1.0f, 1.0f) };
+
+            size_t expected = gjk_kernel_get(GJK_KERNEL_SCALAR)(soa, soa + count, count, d);
+            for (int kernel = GJK_KERNEL_SSE2; kernel < GJK_KERNEL_COUNT; ++kernel)
+            {
+                gjk_support_kernel func = gjk_kernel_get((gjk_kernel)kernel);
+                if (!func) continue;
+
+                mismatches += func(soa, soa + count, count, d) != expected;
+                checks++;
+            }
+        }
+    }
+    printf("  %zu checks against scalar, %zu mismatches\n", checks, mismatches);
+
+    /* raw kernel throughput on a hull */
+    for (size_t i = 0; i < BENCH_SIMD_DIRECTIONS; ++i)
+    {
+        float a = bench_randf(0.0f, 6.2831853f);
+        directions[i] = (gjk_vec2){ cosf(a), sinf(a) };
+    }
+
+    printf("  %8s", "vertices");
+    for (int kernel = 0; kernel < GJK_KERNEL_COUNT; ++kernel)
+        printf(" %10s", gjk_kernel_name((gjk_kernel)kernel));
+    printf("   (ns/query)\n");
+
+    volatile size_t sink = 0;
+    for (size_t count = 4; count <= BENCH_SIMD_VERTS; count *= 4)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            float a = 6.2831853f * (float)i / (float)count;
+            soa[i] = 10.0f * cosf(a);
+            soa[count + i] = 10.0f * sinf(a);
+        }
+
+        printf("  %8zu", count);
+        for (int kernel = 0; kernel < GJK_KERNEL_COUNT; ++kernel)
+        {
+            gjk_support_kernel func = gjk_kernel_get((gjk_kernel)kernel);
+            if (!func)
+            {
+                printf(" %10s", "-");
+                continue;
+            }
+
+            double start = bench_time();
+            for (int r = 0; r < BENCH_REPEAT; ++r)
+                for (size_t i = 0; i < BENCH_SIMD_DIRECTIONS; ++i)
+                    sink += func(soa, soa + count, count, directions[i]);
+            double time = bench_time() - start;
+
+            printf(" %10.1f", time * 1e9 / ((double)BENCH_SIMD_DIRECTIONS * BENCH_REPEAT));
+        }
+        printf("\n");
+    }
+
+    /* gjk + epa against a hull that is not hill climbed */
+    gjk_shape hull;
+    gjk_vec2* vertices = malloc(sizeof(gjk_vec2) * BENCH_SIMD_VERTS);
+    bench_hull(vertices, 256, (gjk_vec2){ 0.0f, 0.0f }, 10.0f);
+    gjk_poly(&hull, vertices, 256);
+    hull.hill_climb = 0;
+
+    epa_arena arena = { 0 };
+    double time[2];
+    for (int layout = 0; layout < 2; ++layout)
+    {
+        if (layout) gjk_poly_soa(&hull, soa);
+
+        double start = bench_time();
+        for (int r = 0; r < BENCH_REPEAT; ++r)
+        {
+            for (size_t i = 0; i < BENCH_SIMD_DIRECTIONS; ++i)
+            {
+                gjk_shape probe;
+                gjk_circle(&probe, (gjk_vec2){ directions[i].x * 10.0f, directions[i].y * 10.0f }, 1.0f);
+
+                gjk_vec2 simplex[3], n;
+                if (gjk_collision(&hull, &probe, simplex))
+                    epa(&hull, &probe, simplex, &n, &arena, NULL);
+            }
+        }
+        time[layout] = bench_time() - start;
+    }
+
+    double queries = (double)BENCH_SIMD_DIRECTIONS * BENCH_REPEAT;
+    printf("  gjk + epa, 256 vertices: aos %.1f ns/query, soa %.1f ns/query (%.2fx)\n",
+        time[0] * 1e9 / queries, time[1] * 1e9 / queries, time[0] / time[1]);
+
+    epa_arena_free(&arena);
+    free(vertices);
+    free(soa);
+    free(directions);
+}
+
+#define BENCH_WARM_SHAPES 16000
+#define BENCH_WARM_TICKS  60
+
+void bench_gjk_warm_start()
+{
+    bench_scene scene;
+    sweep_prune sp;
+
+    bench_seed(7);
+    bench_scene_create(&scene, BENCH_WARM_SHAPES, 360.0f, 0.5f, 1.5f);
+    sweep_prune_init(&sp);
+    sweep_prune_build(&sp, scene.shapes, scene.count);
+
+    gjk_result* cold = NULL;
+    gjk_result* warm = NULL;
+    size_t capacity = 0;
+
+    double cold_time = 0.0, warm_time = 0.0;
+    size_t pairs = 0, mismatches = 0;
+    for (int tick = 0; tick < BENCH_WARM_TICKS; ++tick)
+    {
+        bench_scene_step(&scene, 1.0f / 60.0f);
+        for (size_t i = 0; i < scene.count; ++i)
+            sweep_prune_move(&sp, (uint32_t)i, gjk_shape_aabb(&scene.shapes[i]));
+
+        if (sp.pair_count > capacity)
+        {
+            capacity = sp.pair_count * 2;
+            cold = realloc(cold, sizeof(gjk_result) * capacity);
+            warm = realloc(warm, sizeof(gjk_result) * capacity);
+        }
+
+        double start = bench_time();
+        gjk_collide_batch(scene.shapes, sp.pairs, sp.pair_count, cold);
+        cold_time += bench_time() - start;
+
+        start = bench_time();
+        gjk_collide_batch_cached(scene.shapes, sp.pairs, sp.caches, sp.pair_count, warm);
+        warm_time += bench_time() - start;
+
+        for (size_t i = 0; i < sp.pair_count; ++i)
+            mismatches += cold[i].collision != warm[i].collision;
+        pairs += sp.pair_count;
+    }
+
+    printf("warm starting: %d shapes, %zu pairs/tick, %zu disagreements on touching pairs\n", BENCH_WARM_SHAPES, pairs / BENCH_WARM_TICKS, mismatches);
+    printf("  cold: %8.2f ns/pair\n", cold_time * 1e9 / (double)pairs);
+    printf("  warm: %8.2f ns/pair (%.2fx)\n", warm_time * 1e9 / (double)pairs, cold_time / warm_time);
+
+    sweep_prune_destroy(&sp);
+    bench_scene_destroy(&scene);
+    free(cold);
+    free(warm);
+}
+
+#define BENCH_BOUNDS_SHAPES 20000
+#define BENCH_BOUNDS_REPEAT 16
+
+/* candidates of a broadphase with fattened aabbs in a sparse scene, with and without the bounds test */
+void bench_gjk_bounds()
+{
+    bench_scene scene;
+    aabb_tree tree;
+
+    bench_seed(19);
+    bench_scene_create(&scene, BENCH_BOUNDS_SHAPES, 400.0f, 0.5f, 1.5f);
+    aabb_tree_init(&tree, 1.0f);
+    for (size_t i = 0; i < scene.count; ++i)
+        aabb_tree_insert(&tree, gjk_shape_aabb(&scene.shapes[i]), (uint32_t)i);
+    size_t pair_count = aabb_tree_update_pairs(&tree);
+
+    /* copies with bounds that always overlap go straight to the support queries */
+    gjk_shape* unbounded = malloc(sizeof(gjk_shape) * scene.count);
+    for (size_t i = 0; i < scene.count; ++i)
+    {
+        unbounded[i] = scene.shapes[i];
+        unbounded[i].aabb = (gjk_aabb) { { -FLT_MAX, -FLT_MAX }, { FLT_MAX, FLT_MAX } };
+        unbounded[i].bounding_radius = FLT_MAX;
+    }
+
+    size_t rejected = 0, collisions = 0, mismatches = 0;
+    for (size_t i = 0; i < pair_count; ++i)
+    {
+        const gjk_pair* pair = &tree.pairs[i];
+        uint8_t bounded = gjk_collision(&scene.shapes[pair->a], &scene.shapes[pair->b], NULL);
+        rejected += !gjk_bounds_overlap(&scene.shapes[pair->a], &scene.shapes[pair->b]);
+        collisions += bounded;
+        mismatches += bounded != gjk_collision(&unbounded[pair->a], &unbounded[pair->b], NULL);
+    }
+
+    double start = bench_time();
+    for (int r = 0; r < BENCH_BOUNDS_REPEAT; ++r)
+        for (size_t i = 0; i < pair_count; ++i)
+            collisions += gjk_collision(&unbounded[tree.pairs[i].a], &unbounded[tree.pairs[i].b], NULL);
+    double full_time = bench_time() - start;
+
+    start = bench_time();
+    for (int r = 0; r < BENCH_BOUNDS_REPEAT; ++r)
+        for (size_t i = 0; i < pair_count; ++i)
+            collisions += gjk_collision(&scene.shapes[tree.pairs[i].a], &scene.shapes[tree.pairs[i].b], NULL);
+    double bounded_time = bench_time() - start;
+
+    double queries = (double)pair_count * BENCH_BOUNDS_REPEAT;
+    printf("gjk bounds: %zu candidate pairs, %zu rejected by the bounds, %zu mismatches\n", pair_count, rejected, mismatches);
+    printf("  without bounds test: %8.2f ns/pair\n", full_time * 1e9 / queries);
+    printf("  with bounds test:    %8.2f ns/pair (%.2fx)\n", bounded_time * 1e9 / queries, full_time / bounded_time);
+
+    /* the setters never touch the vertices, rotating a large hull costs the same as a small one */
+    gjk_vec2* hull = malloc(sizeof(gjk_vec2) * 4096);
+    printf("  %8s %14s %14s\n", "vertices", "set_transform", "outside aabb");
+    for (size_t count = 4; count <= 4096; count *= 8)
+    {
+        gjk_shape shape;
+        bench_hull(hull, count, (gjk_vec2){ 2.0f, 1.0f }, 10.0f);
+        gjk_poly(&shape, hull, count);
+
+        size_t outside = 0;
+        for (int k = 0; k < 64; ++k)
+        {
+            gjk_set_transform(&shape, (gjk_vec2){ bench_randf(-5.0f, 5.0f), bench_randf(-5.0f, 5.0f) }, gjk_rotation(bench_randf(0.0f, 6.2831853f)));
+            gjk_aabb aabb = gjk_shape_aabb(&shape);
+            for (size_t i = 0; i < count; ++i)
+            {
+                gjk_vec2 v = gjk_get_vertex(&shape, i);
+                outside += v.x < aabb.min.x - 1e-4f || v.x > aabb.max.x + 1e-4f || v.y < aabb.min.y - 1e-4f || v.y > aabb.max.y + 1e-4f;
+            }
+        }
+
+        start = bench_time();
+        for (int r = 0; r < 65536; ++r)
+            gjk_set_transform(&shape, (gjk_vec2){ (float)(r & 7), 0.0f }, gjk_rotation(0.001f * (float)r));
+        double time = bench_time() - start;
+
+        printf("  %8zu %11.1f ns %14zu\n", count, time * 1e9 / 65536.0, outside);
+    }
+    free(hull);
+
+    free(unbounded);
+    aabb_tree_destroy(&tree);
+    bench_scene_destroy(&scene);
+}
+
+#define BENCH_EPA_PAIRS 4096
+
+void bench_epa()
+{
+    gjk_shape* circles = malloc(sizeof(gjk_shape) * BENCH_EPA_PAIRS * 2);
+    epa_arena arena = { 0 };
+
+    /* deeply overlapping circles with a known penetration depth */
+    bench_seed(8);
+    for (size_t i = 0; i < BENCH_EPA_PAIRS; ++i)
+    {
+        float r1 = bench_randf(0.5f, 2.0f);
+        float r2 = bench_randf(0.5f, 2.0f);
+        float a = bench_randf(0.0f, 6.2831853f);
+        float dist = bench_randf(0.1f, 0.9f) * (r1 + r2);
+
+        gjk_circle(&circles[2 * i], (gjk_vec2){ 0.0f, 0.0f }, r1);
+        gjk_circle(&circles[2 * i + 1], (gjk_vec2){ dist * cosf(a), dist * sinf(a) }, r2);
+    }
+
+    for (int use_arena = 0; use_arena < 2; ++use_arena)
+    {
+        size_t failures = 0;
+        size_t capped = 0;
+        float max_error = 0.0f;
+
+        double time = 0.0;
+        for (int r = 0; r < BENCH_REPEAT; ++r)
+        {
+            for (size_t i = 0; i < BENCH_EPA_PAIRS; ++i)
+            {
+                const gjk_shape* s1 = &circles[2 * i];
+                const gjk_shape* s2 = &circles[2 * i + 1];
+
+                gjk_vec2 simplex[3], n;
+                if (!gjk_collision(s1, s2, simplex)) { failures++; continue; }
+
+                double start = bench_time();
+                uint8_t converged;
+                float depth = epa(s1, s2, simplex, &n, use_arena ? &arena : NULL, &converged);
+                time += bench_time() - start;
+
+                if (!converged) capped++;
+
+                float expected = s1->radius + s2->radius - sqrtf(gjk_length_Squared(gjk_sub(s2->center, s1->center)));
+                if (depth < 0.0f) failures++;
+                else if (fabsf(depth - expected) > max_error) max_error = fabsf(depth - expected);
+            }
+        }
+
+        printf("epa: deep circle overlaps %s arena: %8.1f ns/query, max error %g, %zu failures, %zu capped\n",
+            use_arena ? "with   " : "without", time * 1e9 / ((double)BENCH_EPA_PAIRS * BENCH_REPEAT), max_error, failures, capped);
+    }
+
+    epa_arena_free(&arena);
+    free(circles);
+}
+
+#define BENCH_SHAPE_PROBES 4096
+
+static double bench_gjk_probe(const gjk_shape* shape, const gjk_shape* probes, uint8_t* results)
+{
+    double start = bench_time();
+    for (int r = 0; r < BENCH_REPEAT; ++r)
+    {
+        for (size_t i = 0; i < BENCH_SHAPE_PROBES; ++i)
+        {
+            gjk_vec2 simplex[3];
+            results[i] = gjk_collision(shape, &probes[i], simplex);
+        }
+    }
+    return (bench_time() - start) * 1e9 / ((double)BENCH_SHAPE_PROBES * BENCH_REPEAT);
+}
+
+void bench_gjk_shapes()
+{
+    printf("analytic shapes: gjk against small triangles (ns/query)\n");
+    printf("  %8s %10s %10s %10s %10s %14s\n", "shape", "analytic", "poly 16", "poly 64", "poly 256", "disagreements");
+
+    gjk_vec2* probe_verts = malloc(sizeof(gjk_vec2) * BENCH_SHAPE_PROBES * 3);
+    gjk_shape* probes = malloc(sizeof(gjk_shape) * BENCH_SHAPE_PROBES);
+    uint8_t* expected = malloc(BENCH_SHAPE_PROBES);
+    uint8_t* results = malloc(BENCH_SHAPE_PROBES);
+    gjk_vec2* hull = malloc(sizeof(gjk_vec2) * 256);
+    gjk_vec2 box[4] = { { -1.0f, -0.5f }, { 1.0f, -0.5f }, { 1.0f, 0.5f }, { -1.0f, 0.5f } };
+
+    bench_seed(10);
+    for (size_t i = 0; i < BENCH_SHAPE_PROBES; ++i)
+    {
+        gjk_vec2 c = { bench_randf(-3.0f, 3.0f), bench_randf(-3.0f, 3.0f) };
+        gjk_vec2* v = probe_verts + i * 3;
+        v[0] = (gjk_vec2){ c.x + 0.4f, c.y };
+        v[1] = (gjk_vec2){ c.x - 0.2f, c.y + 0.3f };
+        v[2] = (gjk_vec2){ c.x - 0.2f, c.y - 0.3f };
+        gjk_poly(&probes[i], v, 3);
+    }
+
+    gjk_shape shapes[5];
+    gjk_segment(&shapes[0], (gjk_vec2){ -1.5f, 0.0f }, (gjk_vec2){ 1.5f, 0.0f });
+    gjk_capsule(&shapes[1], (gjk_vec2){ -1.0f, 0.0f }, (gjk_vec2){ 1.0f, 0.0f }, 0.75f);
+    gjk_box(&shapes[2], (gjk_vec2){ 0.0f, 0.0f }, (gjk_vec2){ 1.5f, 0.75f });
+    gjk_ellipse(&shapes[3], (gjk_vec2){ 0.0f, 0.0f }, (gjk_vec2){ 2.0f, 1.0f });
+    gjk_rounded(&shapes[4], box, 4, 0.5f);
+
+    size_t disagreements = 0;
+    for (int s = 0; s < 5; ++s)
+    {
+        gjk_shape* shape = &shapes[s];
+        gjk_set_rotation(shape, 0.3f);
+
+        static const char* names[] = { "segment", "capsule", "box", "ellipse", "rounded" };
+        printf("  %8s %10.1f", names[s], bench_gjk_probe(shape, probes, expected));
+
+        /* sampling the support function gives polygons inscribed into the round shapes */
+        uint8_t round = shape->type == GJK_CAPSULE || shape->type == GJK_ELLIPSE || shape->type == GJK_ROUNDED;
+        disagreements = 0;
+        for (size_t count = 16; count <= 256; count *= 4)
+        {
+            if (!round)
+            {
+                printf(" %10s", "-");
+                continue;
+            }
+
+            gjk_shape local = *shape;
+            gjk_set_center(&local, (gjk_vec2){ 0.0f, 0.0f });
+            gjk_set_rotation(&local, 0.0f);
+            for (size_t i = 0; i < count; ++i)
+            {
+                float a = 6.2831853f * (float)i / (float)count;
+                hull[i] = gjk_furthest_point(&local, (gjk_vec2){ cosf(a), sinf(a) });
+            }
+
+            gjk_shape poly;
+            gjk_poly(&poly, hull, count);
+            gjk_set_transform(&poly, gjk_add(shape->center, gjk_rotate(shape->rot, poly.centroid)), shape->rot);
+
+            printf(" %10.1f", bench_gjk_probe(&poly, probes, results));
+
+            disagreements = 0;
+            for (size_t i = 0; i < BENCH_SHAPE_PROBES; ++i)
+                disagreements += results[i] != expected[i];
+        }
+        if (round) printf(" %14zu", disagreements);
+        printf("\n");
+    }
+    printf("  disagreements are probes grazing the gap between the shape and its 256 vertex polygon\n");
+
+    free(probe_verts);
+    free(probes);
+    free(expected);
+    free(results);
+    free(hull);
+}
+
+#define BENCH_INTERSECT_PAIRS 4096
+
+static void bench_random_shape(gjk_shape* shape, gjk_shape_type type, gjk_vec2* vertices)
+{
+    gjk_vec2 center = { bench_randf(-1.0f, 1.0f), bench_randf(-1.0f, 1.0f) };
+    float size = bench_randf(0.5f, 1.5f);
+
+    if (type == GJK_POLY || type == GJK_ROUNDED)
+    {
+        for (size_t v = 0; v < 6; ++v)
+        {
+            float a = 6.2831853f * (float)v / 6.0f;
+            vertices[v] = (gjk_vec2){ size * cosf(a), size * sinf(a) };
+        }
+    }
+
+    switch (type)
+    {
+    case GJK_CIRCLE:  gjk_circle(shape, center, size); break;
+    case GJK_POLY:    gjk_poly(shape, vertices, 6); break;
+    case GJK_ROUNDED: gjk_rounded(shape, vertices, 6, 0.25f * size); break;
+    case GJK_SEGMENT: gjk_segment(shape, (gjk_vec2){ -size, 0.0f }, (gjk_vec2){ size, 0.0f }); break;
+    case GJK_CAPSULE: gjk_capsule(shape, (gjk_vec2){ -size, 0.0f }, (gjk_vec2){ size, 0.0f }, 0.5f * size); break;
+    case GJK_BOX:     gjk_box(shape, center, (gjk_vec2){ size, bench_randf(0.25f, 1.0f) }); break;
+    case GJK_ELLIPSE: gjk_ellipse(shape, center, (gjk_vec2){ size, 0.5f * size }); break;
+    default: break;
+    }
+
+    gjk_set_center(shape, center);
+    gjk_set_rotation(shape, bench_randf(0.0f, 6.2831853f));
+}
+
+void bench_gjk_intersect()
+{
+    static const struct { gjk_shape_type t1, t2; const char* name; } combinations[] = {
+        { GJK_CIRCLE,  GJK_CIRCLE,  "circle-circle"  },
+        { GJK_CIRCLE,  GJK_POLY,    "circle-poly"    },
+        { GJK_POLY,    GJK_CIRCLE,  "poly-circle"    },
+        { GJK_ROUNDED, GJK_CIRCLE,  "rounded-circle" },
+        { GJK_CIRCLE,  GJK_BOX,     "circle-box"     },
+        { GJK_BOX,     GJK_CIRCLE,  "box-circle"     },
+        { GJK_CAPSULE, GJK_CIRCLE,  "capsule-circle" },
+        { GJK_CIRCLE,  GJK_SEGMENT, "circle-segment" },
+        { GJK_BOX,     GJK_BOX,     "box-box"        },
+        { GJK_POLY,    GJK_POLY,    "poly-poly"      },
+        { GJK_CAPSULE, GJK_BOX,     "capsule-box"    },
+        { GJK_BOX,     GJK_SEGMENT, "box-segment"    },
+    };
+
+    printf("intersect: closed form tests against gjk + epa (ns/pair)\n");
+    printf("  %14s %10s %10s %8s %10s %12s %8s %8s\n", "pair", "intersect", "gjk + epa", "speedup", "collisions", "depth error", "normals", "capped");
+
+    gjk_shape* shapes = malloc(sizeof(gjk_shape) * BENCH_INTERSECT_PAIRS * 2);
+    gjk_vec2* vertices = malloc(sizeof(gjk_vec2) * BENCH_INTERSECT_PAIRS * 2 * 6);
+    gjk_penetration* fast = malloc(sizeof(gjk_penetration) * BENCH_INTERSECT_PAIRS);
+    gjk_penetration* slow = malloc(sizeof(gjk_penetration) * BENCH_INTERSECT_PAIRS);
+    uint8_t* hit_fast = malloc(BENCH_INTERSECT_PAIRS);
+    uint8_t* hit_slow = malloc(BENCH_INTERSECT_PAIRS);
+    uint8_t* converged = malloc(BENCH_INTERSECT_PAIRS);
+
+    bench_seed(11);
+    for (size_t c = 0; c < sizeof(combinations) / sizeof(combinations[0]); ++c)
+    {
+        for (size_t i = 0; i < BENCH_INTERSECT_PAIRS; ++i)
+        {
+            bench_random_shape(&shapes[2 * i], combinations[c].t1, vertices + 12 * i);
+            bench_random_shape(&shapes[2 * i + 1], combinations[c].t2, vertices + 12 * i + 6);
+        }
+
+        double start = bench_time();
+        for (int r = 0; r < BENCH_REPEAT; ++r)
+            for (size_t i = 0; i < BENCH_INTERSECT_PAIRS; ++i)
+                hit_fast[i] = gjk_intersect(&shapes[2 * i], &shapes[2 * i + 1], &fast[i]);
+        double time_fast = bench_time() - start;
+
+        start = bench_time();
+        for (int r = 0; r < BENCH_REPEAT; ++r)
+        {
+            for (size_t i = 0; i < BENCH_INTERSECT_PAIRS; ++i)
+            {
+                gjk_vec2 simplex[3];
+                hit_slow[i] = gjk_collision(&shapes[2 * i], &shapes[2 * i + 1], simplex);
+                if (hit_slow[i]) slow[i].depth = epa(&shapes[2 * i], &shapes[2 * i + 1], simplex, &slow[i].normal, NULL, &converged[i]);
+            }
+        }
+        double time_slow = bench_time() - start;
+
+        /*
+         * normals are only compared for clear overlaps, touching pairs have no defined normal.
+         * Results where epa ran out of iterations are only estimates and are counted apart.
+         */
+        size_t collisions = 0, normals = 0, capped = 0;
+        float max_error = 0.0f;
+        for (size_t i = 0; i < BENCH_INTERSECT_PAIRS; ++i)
+        {
+            collisions += hit_fast[i];
+            if (!hit_fast[i] || !hit_slow[i]) continue;
+            if (!converged[i])
+            {
+                capped++;
+                continue;
+            }
+
+            float error = fabsf(fast[i].depth - slow[i].depth);
+            if (error > max_error) max_error = error;
+            if (slow[i].depth > 1e-3f && gjk_dot_product(fast[i].normal, slow[i].normal) < 0.999f) normals++;
+        }
+
+        double pairs = (double)BENCH_INTERSECT_PAIRS * BENCH_REPEAT;
+        printf("  %14s %10.1f %10.1f %7.2fx %10zu %12g %8zu %8zu\n", combinations[c].name,
+            time_fast * 1e9 / pairs, time_slow * 1e9 / pairs, time_slow / time_fast, collisions, max_error, normals, capped);
+    }
+    printf("  normals counts clear overlaps whose normal differs from epa, capped counts\n");
+    printf("  overlaps where epa stopped at its limits, like almost concentric circles\n");
+
+    free(shapes);
+    free(vertices);
+    free(fast);
+    free(slow);
+    free(hit_fast);
+    free(hit_slow);
+    free(converged);
+}
+
+#define BENCH_DISTANCE_PAIRS     4096
+#define BENCH_DISTANCE_CLEARANCE 0.5f
+#define BENCH_BISECTION_STEPS    16
+
+static float bench_segment_distance(gjk_vec2 p, gjk_vec2 a, gjk_vec2 b)
+{
+    gjk_vec2 e = gjk_sub(b, a);
+    float t = gjk_dot_product(gjk_sub(p, a), e) / gjk_length_Squared(e);
+    t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+    return sqrtf(gjk_length_Squared(gjk_sub((gjk_vec2){ a.x + e.x * t, a.y + e.y * t }, p)));
+}
+
+/* brute force over all edge pairs of two separated polygons */
+static float bench_poly_distance(const gjk_shape* s1, const gjk_shape* s2)
+{
+    float min = FLT_MAX;
+    for (size_t i = 0; i < s1->count; ++i)
+    {
+        gjk_vec2 a0 = gjk_get_vertex(s1, i), a1 = gjk_get_vertex(s1, (i + 1) % s1->count);
+        for (size_t j = 0; j < s2->count; ++j)
+        {
+            gjk_vec2 b0 = gjk_get_vertex(s2, j), b1 = gjk_get_vertex(s2, (j + 1) % s2->count);
+            float d = fminf(fminf(bench_segment_distance(a0, b0, b1), bench_segment_distance(a1, b0, b1)),
+                            fminf(bench_segment_distance(b0, a0, a1), bench_segment_distance(b1, a0, a1)));
+            if (d < min) min = d;
+        }
+    }
+    return min;
+}
+
+/* the old way to ask for a distance: overlap tests against s1 inflated by a radius */
+static uint8_t bench_inflated_overlap(const gjk_shape* s1, const gjk_shape* s2, float radius)
+{
+    gjk_shape inflated = *s1;
+    inflated.type = GJK_ROUNDED;
+    inflated.radius = radius;
+    gjk_update_bounds(&inflated);
+    return gjk_collision(&inflated, s2, NULL);
+}
+
+void bench_gjk_distance()
+{
+    gjk_shape* shapes = malloc(sizeof(gjk_shape) * BENCH_DISTANCE_PAIRS * 2);
+    gjk_vec2* vertices = malloc(sizeof(gjk_vec2) * BENCH_DISTANCE_PAIRS * 2 * 6);
+
+    /* separated polygon pairs */
+    bench_seed(15);
+    size_t count = 0;
+    while (count < BENCH_DISTANCE_PAIRS)
+    {
+        gjk_shape* s = &shapes[2 * count];
+        bench_random_shape(&s[0], GJK_POLY, vertices + 12 * count);
+        bench_random_shape(&s[1], GJK_POLY, vertices + 12 * count + 6);
+        gjk_set_center(&s[1], gjk_add(s[1].center, (gjk_vec2){ bench_randf(0.0f, 4.0f), bench_randf(-2.0f, 2.0f) }));
+        if (!gjk_collision(&s[0], &s[1], NULL)) count++;
+    }
+
+    float max_error = 0.0f, max_point_error = 0.0f;
+    for (size_t i = 0; i < count; ++i)
+    {
+        gjk_proximity p;
+        gjk_closest_points(&shapes[2 * i], &shapes[2 * i + 1], FLT_MAX, &p);
+
+        float error = fabsf(p.distance - bench_poly_distance(&shapes[2 * i], &shapes[2 * i + 1]));
+        if (error > max_error) max_error = error;
+
+        float point_error = fabsf(sqrtf(gjk_length_Squared(gjk_sub(p.point2, p.point1))) - p.distance);
+        if (point_error > max_point_error) max_point_error = point_error;
+    }
+    printf("distance: %zu separated polygon pairs, max error %g, closest points max error %g\n", count, max_error, max_point_error);
+
+    /* exact distance against bisection with inflated overlap tests */
+    double start = bench_time();
+    volatile float sink = 0.0f;
+    for (int r = 0; r < BENCH_REPEAT; ++r)
+        for (size_t i = 0; i < count; ++i)
+            sink += gjk_distance(&shapes[2 * i], &shapes[2 * i + 1], NULL);
+    double time_distance = bench_time() - start;
+
+    start = bench_time();
+    float bisection_error = 0.0f;
+    for (int r = 0; r < BENCH_REPEAT; ++r)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            float lo = 0.0f, hi = 8.0f;
+            for (int step = 0; step < BENCH_BISECTION_STEPS; ++step)
+            {
+                float mid = 0.5f * (lo + hi);
+                if (bench_inflated_overlap(&shapes[2 * i], &shapes[2 * i + 1], mid)) hi = mid;
+                else lo = mid;
+            }
+            if (r == 0) bisection_error = fmaxf(bisection_error, fabsf(lo - gjk_distance(&shapes[2 * i], &shapes[2 * i + 1], NULL)));
+        }
+    }
+    double time_bisection = bench_time() - start;
+
+    double queries = (double)count * BENCH_REPEAT;
+    printf("  gjk_distance:          %8.1f ns/query\n", time_distance * 1e9 / queries);
+    printf("  %d inflated overlaps:  %8.1f ns/query, max error %g\n", BENCH_BISECTION_STEPS, time_bisection * 1e9 / queries, bisection_error);
+
+    /* clearance checks: closer than a margin or not */
+    size_t disagreements = 0, close = 0;
+    uint32_t iterations = 0;
+    start = bench_time();
+    for (int r = 0; r < BENCH_REPEAT; ++r)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            gjk_proximity p;
+            gjk_closest_points(&shapes[2 * i], &shapes[2 * i + 1], BENCH_DISTANCE_CLEARANCE, &p);
+            if (r == 0)
+            {
+                close += p.distance <= BENCH_DISTANCE_CLEARANCE;
+                iterations += p.iterations;
+            }
+        }
+    }
+    double time_clearance = bench_time() - start;
+
+    start = bench_time();
+    for (int r = 0; r < BENCH_REPEAT; ++r)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint8_t inflated = bench_inflated_overlap(&shapes[2 * i], &shapes[2 * i + 1], BENCH_DISTANCE_CLEARANCE);
+            if (r == 0)
+            {
+                gjk_proximity p;
+                gjk_closest_points(&shapes[2 * i], &shapes[2 * i + 1], BENCH_DISTANCE_CLEARANCE, &p);
+                disagreements += inflated != (p.distance <= BENCH_DISTANCE_CLEARANCE);
+            }
+        }
+    }
+    double time_inflated = bench_time() - start;
+
+    printf("  clearance %.1f: closest points with early out %8.1f ns/query (%.2f iterations), inflated overlap %8.1f ns/query\n",
+        BENCH_DISTANCE_CLEARANCE, time_clearance * 1e9 / queries, (double)iterations / (double)count, time_inflated * 1e9 / queries);
+    printf("  %zu of %zu pairs within clearance, %zu disagreements\n", close, count, disagreements);
+
+    free(shapes);
+    free(vertices);
+}
@@ -0,0 +1,175 @@
+#include "bench.h"
+
+#include "gjk3d.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define BENCH_GJK3D_PAIRS 16384
+
+static const vec3 bench_gjk3d_octahedron[] = {
+    {  0.6f,  0.0f,  0.0f }, { -0.6f,  0.0f,  0.0f },
+    {  0.0f,  0.6f,  0.0f }, {  0.0f, -0.6f,  0.0f },
+    {  0.0f,  0.0f,  0.6f }, {  0.0f,  0.0f, -0.6f }
+};
+
+static vec3 bench_gjk3d_vec(float min, float max)
+{
+    return (vec3) { bench_randf(min, max), bench_randf(min, max), bench_randf(min, max) };
+}
+
+static void bench_gjk3d_shape(gjk3d_shape* shape, gjk3d_shape_type type)
+{
+    vec3 center = bench_gjk3d_vec(-1.0f, 1.0f);
+    switch (type)
+    {
+    case GJK3D_SPHERE:
+        gjk3d_sphere(shape, center, bench_randf(0.3f, 0.8f));
+        break;
+    case GJK3D_BOX:
+        gjk3d_box(shape, center, bench_gjk3d_vec(0.2f, 0.7f));
+        break;
+    case GJK3D_CAPSULE:
+    {
+        vec3 h = bench_gjk3d_vec(-0.5f, 0.5f);
+        gjk3d_capsule(shape, vec3_sub(center, h), vec3_add(center, h), bench_randf(0.2f, 0.5f));
+        break;
+    }
+    default:
+        gjk3d_hull(shape, center, bench_gjk3d_octahedron, sizeof(bench_gjk3d_octahedron) / sizeof(vec3));
+        break;
+    }
+
+    if (type != GJK3D_SPHERE && type != GJK3D_CAPSULE)
+        gjk3d_set_rotation(shape, bench_gjk3d_vec(-1.0f, 1.0f), bench_randf(0.0f, 3.1415926f));
+}
+
+static const char* bench_gjk3d_names[GJK3D_SHAPE_COUNT] = { "sphere", "box", "capsule", "hull" };
+
+/* collision and penetration time for every pair of shape types */
+static void bench_gjk3d_pairs(gjk3d_shape* a, gjk3d_shape* b)
+{
+    printf("  %16s %10s %10s %10s %10s\n", "pair", "colliding", "gjk ns", "epa ns", "capped");
+    for (int ta = 0; ta < GJK3D_SHAPE_COUNT; ++ta)
+    {
+        for (int tb = ta; tb < GJK3D_SHAPE_COUNT; ++tb)
+        {
+            bench_seed(11 + ta * GJK3D_SHAPE_COUNT + tb);
+            for (size_t i = 0; i < BENCH_GJK3D_PAIRS; ++i)
+            {
+                bench_gjk3d_shape(&a[i], ta);
+                bench_gjk3d_shape(&b[i], tb);
+            }
+
+            size_t collisions = 0;
+            double start = bench_time();
+            for (size_t i = 0; i < BENCH_GJK3D_PAIRS; ++i)
+                collisions += gjk3d_collision(&a[i], &b[i], NULL);
+            double gjk_time = bench_time() - start;
+
+            /* capped queries stopped at the epa limits and only have an estimate */
+            volatile float sink = 0.0f;
+            size_t capped = 0;
+            start = bench_time();
+            for (size_t i = 0; i < BENCH_GJK3D_PAIRS; ++i)
+            {
+                gjk3d_penetration penetration;
+                if (!gjk3d_intersect(&a[i], &b[i], &penetration)) continue;
+
+                sink += penetration.depth;
+                capped += !penetration.converged;
+            }
+            double epa_time = bench_time() - start - gjk_time;
+            (void)sink;
+
+            char name[32];
+            snprintf(name, sizeof(name), "%s-%s", bench_gjk3d_names[ta], bench_gjk3d_names[tb]);
+            printf("  %16s %10zu %10.1f %10.1f %10zu\n", name, collisions, gjk_time * 1e9 / BENCH_GJK3D_PAIRS,
+                collisions ? epa_time * 1e9 / collisions : 0.0, capped);
+        }
+    }
+}
+
+/* depth against pairs with an exact answer: spheres and axis aligned boxes */
+static void bench_gjk3d_accuracy(gjk3d_shape* a, gjk3d_shape* b)
+{
+    printf("  %16s %10s %10s %10s %10s %10s %10s\n", "exact", "expected", "found", "missed", "max error", "capped", "capped err");
+    for (int type = GJK3D_SPHERE; type <= GJK3D_BOX; ++type)
+    {
+        bench_seed(7 + type);
+        for (size_t i = 0; i < BENCH_GJK3D_PAIRS; ++i)
+        {
+            vec3 ca = bench_gjk3d_vec(-1.0f, 1.0f), cb = bench_gjk3d_vec(-1.0f, 1.0f);
+            if (type == GJK3D_SPHERE)
+            {
+                gjk3d_sphere(&a[i], ca, bench_randf(0.3f, 0.8f));
+                gjk3d_sphere(&b[i], cb, bench_randf(0.3f, 0.8f));
+            }
+            else
+            {
+                gjk3d_box(&a[i], ca, bench_gjk3d_vec(0.2f, 0.7f));
+                gjk3d_box(&b[i], cb, bench_gjk3d_vec(0.2f, 0.7f));
+            }
+        }
+
+        size_t expected = 0, found = 0, missed = 0, capped = 0;
+        float max_error = 0.0f, capped_error = 0.0f;
+        for (size_t i = 0; i < BENCH_GJK3D_PAIRS; ++i)
+        {
+            vec3 d = vec3_sub(b[i].center, a[i].center);
+            float depth;
+            if (type == GJK3D_SPHERE)
+            {
+                depth = a[i].radius + b[i].radius - sqrtf(vec3_dot(d, d));
+            }
+            else
+            {
+                vec3 e = vec3_add(a[i].extents, b[i].extents);
+                depth = fminf(fminf(e.x - fabsf(d.x), e.y - fabsf(d.y)), e.z - fabsf(d.z));
+            }
+
+            /* leave out grazing pairs, where the result depends on rounding */
+            if (fabsf(depth) < 1e-3f) continue;
+
+            gjk3d_penetration penetration;
+            uint8_t hit = gjk3d_intersect(&a[i], &b[i], &penetration);
+            expected += depth > 0.0f;
+            found += hit;
+
+            if (hit != (depth > 0.0f))
+            {
+                missed++;
+                continue;
+            }
+            if (!hit) continue;
+
+            /* the converged results have to be exact, the capped ones are reported apart */
+            float error = fabsf(penetration.depth - depth);
+            if (penetration.converged)
+            {
+                max_error = fmaxf(max_error, error);
+            }
+            else
+            {
+                capped++;
+                capped_error = fmaxf(capped_error, error);
+            }
+        }
+
+        printf("  %16s %10zu %10zu %10zu %10.6f %10zu %10.6f\n", bench_gjk3d_names[type], expected, found, missed, max_error, capped, capped_error);
+    }
+}
+
+void bench_gjk3d()
+{
+    gjk3d_shape* a = malloc(sizeof(gjk3d_shape) * BENCH_GJK3D_PAIRS);
+    gjk3d_shape* b = malloc(sizeof(gjk3d_shape) * BENCH_GJK3D_PAIRS);
+
+    printf("gjk3d: %d random pairs per combination\n", BENCH_GJK3D_PAIRS);
+    bench_gjk3d_pairs(a, b);
+    bench_gjk3d_accuracy(a, b);
+
+    free(a);
+    free(b);
+}
@@ -0,0 +1,67 @@
+#include "bench.h"
+
+/*
+ * linmath.h defines its own vec3, quat and mat4 names, so the reference
+ * implementation lives in this unit and only works on plain float arrays.
+ */
+#include "linmath.h"
+
+void bench_linmath_multiply(float* result, const float* l, const float* r, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        mat4x4_mul((vec4*)(result + 16 * i), (const vec4*)(l + 16 * i), (const vec4*)(r + 16 * i));
+}
+
+void bench_linmath_invert(float* result, const float* m, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        mat4x4_invert((vec4*)(result + 16 * i), (const vec4*)(m + 16 * i));
+}
+
+void bench_linmath_rotate_x(float* result, const float* m, const float* angles, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        mat4x4_rotate_X((vec4*)(result + 16 * i), (const vec4*)(m + 16 * i), angles[i]);
+}
+
+void bench_linmath_look_at(float* result, const float* eyes, const float* targets, size_t count)
+{
+    vec3 up = { 0.0f, 1.0f, 0.0f };
+    for (size_t i = 0; i < count; ++i)
+        mat4x4_look_at((vec4*)(result + 16 * i), eyes + 3 * i, targets + 3 * i, up);
+}
+
+void bench_linmath_from_quat(float* result, const float* quats, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        mat4x4_from_quat((vec4*)(result + 16 * i), quats + 4 * i);
+}
+
+float bench_linmath_vec3_chain(const float* a, const float* b, size_t count)
+{
+    float sum = 0.0f;
+    for (size_t i = 0; i < count; ++i)
+    {
+        vec3 c, n, l;
+        vec3_mul_cross(c, a + 3 * i, b + 3 * i);
+        vec3_norm(n, c);
+
+        /* linmath has no lerp, a + (b - a) * t */
+        vec3_sub(l, b + 3 * i, a + 3 * i);
+        vec3_scale(l, l, 0.5f);
+        vec3_add(l, l, a + 3 * i);
+        sum += vec3_mul_inner(n, l);
+    }
+    return sum;
+}
+
+void bench_linmath_translate_multiply(float* result, const float* m, const float* positions, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        mat4x4 t;
+        const float* p = positions + 3 * i;
+        mat4x4_translate(t, p[0], p[1], p[2]);
+        mat4x4_mul((vec4*)(result + 16 * i), (const vec4*)(m + 16 * i), t);
+    }
+}
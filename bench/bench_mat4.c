@@ -0,0 +1,167 @@
+#include "bench.h"
+
+#include "math/mat4.h"
+#include "math/quat.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define BENCH_MAT4_COUNT   4096
+#define BENCH_MAT4_REPEAT  64
+
+typedef struct
+{
+    mat4* a;
+    mat4* b;
+    mat4* result;
+    mat4* reference;
+    vec3* eyes;
+    vec3* targets;
+    quat* quats;
+    float* angles;
+} bench_mat4_data;
+
+/* random rotation, translation and scale, well conditioned enough to invert */
+static mat4 bench_mat4_random()
+{
+    vec3 axis = { bench_randf(-1.0f, 1.0f), bench_randf(-1.0f, 1.0f), bench_randf(-1.0f, 1.0f) };
+    vec3 scale = { bench_randf(0.5f, 2.0f), bench_randf(0.5f, 2.0f), bench_randf(0.5f, 2.0f) };
+    vec3 pos = { bench_randf(-10.0f, 10.0f), bench_randf(-10.0f, 10.0f), bench_randf(-10.0f, 10.0f) };
+
+    mat4 m = mat4_multiply(mat4_translation(pos), mat4_rotation(vec3_normalize(axis), bench_randf(0.0f, 6.2831853f)));
+    return mat4_multiply(m, mat4_scale(scale));
+}
+
+static float bench_mat4_error(const mat4* a, const mat4* b, size_t count)
+{
+    float error = 0.0f;
+    for (size_t i = 0; i < count; ++i)
+        for (int e = 0; e < 16; ++e)
+            error = fmaxf(error, fabsf(a[i].v[e / 4][e % 4] - b[i].v[e / 4][e % 4]));
+    return error;
+}
+
+static void bench_mat4_print(const char* name, double time, double reference, float error)
+{
+    double ops = (double)BENCH_MAT4_COUNT * BENCH_MAT4_REPEAT;
+    printf("  %12s %10.2f %10.2f %8.2fx %12g\n", name, time * 1e9 / ops, reference * 1e9 / ops, reference / time, error);
+}
+
+void bench_mat4()
+{
+    bench_mat4_data d;
+    d.a = malloc(sizeof(mat4) * BENCH_MAT4_COUNT);
+    d.b = malloc(sizeof(mat4) * BENCH_MAT4_COUNT);
+    d.result = malloc(sizeof(mat4) * BENCH_MAT4_COUNT);
+    d.reference = malloc(sizeof(mat4) * BENCH_MAT4_COUNT);
+    d.eyes = malloc(sizeof(vec3) * BENCH_MAT4_COUNT);
+    d.targets = malloc(sizeof(vec3) * BENCH_MAT4_COUNT);
+    d.quats = malloc(sizeof(quat) * BENCH_MAT4_COUNT);
+    d.angles = malloc(sizeof(float) * BENCH_MAT4_COUNT);
+
+    bench_seed(21);
+    for (size_t i = 0; i < BENCH_MAT4_COUNT; ++i)
+    {
+        d.a[i] = bench_mat4_random();
+        d.b[i] = bench_mat4_random();
+        d.eyes[i] = (vec3) { bench_randf(-10.0f, 10.0f), bench_randf(-10.0f, 10.0f), bench_randf(-10.0f, 10.0f) };
+        d.targets[i] = (vec3) { bench_randf(-1.0f, 1.0f), bench_randf(-1.0f, 1.0f), bench_randf(-1.0f, 1.0f) };
+        d.angles[i] = bench_randf(0.0f, 6.2831853f);
+
+        quat q = { bench_randf(-1.0f, 1.0f), bench_randf(-1.0f, 1.0f), bench_randf(-1.0f, 1.0f), bench_randf(-1.0f, 1.0f) };
+        float l = 1.0f / sqrtf(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+        d.quats[i] = (quat) { q.x * l, q.y * l, q.z * l, q.w * l };
+    }
+
+    printf("mat4: %d matrices, %d repeats, ns per operation against linmath.h\n", BENCH_MAT4_COUNT, BENCH_MAT4_REPEAT);
+    printf("  %12s %10s %10s %9s %12s\n", "operation", "mat4", "linmath", "speedup", "max error");
+
+    double start, time, reference;
+
+    /* multiply */
+    start = bench_time();
+    for (int r = 0; r < BENCH_MAT4_REPEAT; ++r)
+        for (size_t i = 0; i < BENCH_MAT4_COUNT; ++i)
+            d.result[i] = mat4_multiply(d.a[i], d.b[i]);
+    time = bench_time() - start;
+
+    start = bench_time();
+    for (int r = 0; r < BENCH_MAT4_REPEAT; ++r)
+        bench_linmath_multiply(d.reference[0].v[0], d.a[0].v[0], d.b[0].v[0], BENCH_MAT4_COUNT);
+    reference = bench_time() - start;
+    bench_mat4_print("multiply", time, reference, bench_mat4_error(d.result, d.reference, BENCH_MAT4_COUNT));
+
+    /* invert */
+    start = bench_time();
+    for (int r = 0; r < BENCH_MAT4_REPEAT; ++r)
+        for (size_t i = 0; i < BENCH_MAT4_COUNT; ++i)
+            d.result[i] = mat4_invert(d.a[i]);
+    time = bench_time() - start;
+
+    start = bench_time();
+    for (int r = 0; r < BENCH_MAT4_REPEAT; ++r)
+        bench_linmath_invert(d.reference[0].v[0], d.a[0].v[0], BENCH_MAT4_COUNT);
+    reference = bench_time() - start;
+    bench_mat4_print("invert", time, reference, bench_mat4_error(d.result, d.reference, BENCH_MAT4_COUNT));
+
+    /* rotate x */
+    start = bench_time();
+    for (int r = 0; r < BENCH_MAT4_REPEAT; ++r)
+        for (size_t i = 0; i < BENCH_MAT4_COUNT; ++i)
+            d.result[i] = mat4_rotate_x(d.a[i], d.angles[i]);
+    time = bench_time() - start;
+
+    start = bench_time();
+    for (int r = 0; r < BENCH_MAT4_REPEAT; ++r)
+        bench_linmath_rotate_x(d.reference[0].v[0], d.a[0].v[0], d.angles, BENCH_MAT4_COUNT);
+    reference = bench_time() - start;
+    bench_mat4_print("rotate x", time, reference, bench_mat4_error(d.result, d.reference, BENCH_MAT4_COUNT));
+
+    /* look at */
+    start = bench_time();
+    for (int r = 0; r < BENCH_MAT4_REPEAT; ++r)
+        for (size_t i = 0; i < BENCH_MAT4_COUNT; ++i)
+            d.result[i] = mat4_look_at(d.eyes[i], d.targets[i], (vec3) { 0.0f, 1.0f, 0.0f });
+    time = bench_time() - start;
+
+    start = bench_time();
+    for (int r = 0; r < BENCH_MAT4_REPEAT; ++r)
+        bench_linmath_look_at(d.reference[0].v[0], &d.eyes[0].x, &d.targets[0].x, BENCH_MAT4_COUNT);
+    reference = bench_time() - start;
+    bench_mat4_print("look at", time, reference, bench_mat4_error(d.result, d.reference, BENCH_MAT4_COUNT));
+
+    /* quaternion to matrix */
+    start = bench_time();
+    for (int r = 0; r < BENCH_MAT4_REPEAT; ++r)
+        for (size_t i = 0; i < BENCH_MAT4_COUNT; ++i)
+            d.result[i] = mat4_cast(d.quats[i]);
+    time = bench_time() - start;
+
+    start = bench_time();
+    for (int r = 0; r < BENCH_MAT4_REPEAT; ++r)
+        bench_linmath_from_quat(d.reference[0].v[0], &d.quats[0].x, BENCH_MAT4_COUNT);
+    reference = bench_time() - start;
+    bench_mat4_print("cast", time, reference, bench_mat4_error(d.result, d.reference, BENCH_MAT4_COUNT));
+
+    /* round trip through quat_cast, against the input */
+    for (size_t i = 0; i < BENCH_MAT4_COUNT; ++i)
+        d.reference[i] = mat4_cast(d.quats[i]);
+
+    start = bench_time();
+    for (int r = 0; r < BENCH_MAT4_REPEAT; ++r)
+        for (size_t i = 0; i < BENCH_MAT4_COUNT; ++i)
+            d.result[i] = mat4_cast(quat_cast(d.reference[i]));
+    time = bench_time() - start;
+    printf("  %12s %10.2f %10s %9s %12g\n", "quat cast", time * 1e9 / ((double)BENCH_MAT4_COUNT * BENCH_MAT4_REPEAT),
+        "-", "-", bench_mat4_error(d.result, d.reference, BENCH_MAT4_COUNT));
+
+    free(d.a);
+    free(d.b);
+    free(d.result);
+    free(d.reference);
+    free(d.eyes);
+    free(d.targets);
+    free(d.quats);
+    free(d.angles);
+}
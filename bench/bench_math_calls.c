@@ -0,0 +1,20 @@
+#include "math/mat4.h"
+#include "math/vec2.h"
+
+/*
+ * The header only math behind a call. This unit is compiled on its own, so
+ * without link time optimization the benchmark pays for every call the way
+ * it did before the math moved into the headers.
+ */
+
+vec2 bench_call_vec2_sub(vec2 a, vec2 b)     { return vec2_sub(a, b); }
+vec2 bench_call_vec2_mult(vec2 v, float f)   { return vec2_mult(v, f); }
+float bench_call_vec2_dot(vec2 a, vec2 b)    { return vec2_dot(a, b); }
+
+vec3 bench_call_vec3_cross(vec3 a, vec3 b)            { return vec3_cross(a, b); }
+vec3 bench_call_vec3_normalize(vec3 v)                { return vec3_normalize(v); }
+vec3 bench_call_vec3_lerp(vec3 a, vec3 b, float t)    { return vec3_lerp(a, b, t); }
+float bench_call_vec3_dot(vec3 a, vec3 b)             { return vec3_dot(a, b); }
+
+mat4 bench_call_mat4_translation(vec3 v)     { return mat4_translation(v); }
+mat4 bench_call_mat4_multiply(mat4 l, mat4 r) { return mat4_multiply(l, r); }
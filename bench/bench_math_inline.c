@@ -0,0 +1,227 @@
+#include "bench.h"
+
+#include "math/mat4.h"
+#include "math/vec2.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+/*
+ * Call overhead of the small math functions in tight loops. Every loop runs
+ * three times: through the same functions out of line (bench_math_calls.c),
+ * inlined from the headers, and with the arrays of linmath.h or the inlined
+ * helpers of gjk.h where they exist.
+ */
+
+#define BENCH_INLINE_COUNT   65536
+#define BENCH_INLINE_REPEAT  32
+#define BENCH_INLINE_VERTS   8
+
+/* defined in bench_math_calls.c, a unit of its own so they can not be inlined */
+vec2 bench_call_vec2_sub(vec2 a, vec2 b);
+vec2 bench_call_vec2_mult(vec2 v, float f);
+float bench_call_vec2_dot(vec2 a, vec2 b);
+vec3 bench_call_vec3_cross(vec3 a, vec3 b);
+vec3 bench_call_vec3_normalize(vec3 v);
+vec3 bench_call_vec3_lerp(vec3 a, vec3 b, float t);
+float bench_call_vec3_dot(vec3 a, vec3 b);
+mat4 bench_call_mat4_translation(vec3 v);
+mat4 bench_call_mat4_multiply(mat4 l, mat4 r);
+
+static void bench_inline_print(const char* name, double calls, double inlined, double reference, const char* reference_name)
+{
+    double ops = (double)BENCH_INLINE_COUNT * BENCH_INLINE_REPEAT;
+    printf("  %12s %10.2f %10.2f %8.2fx %10.2f  %s\n", name, calls * 1e9 / ops, inlined * 1e9 / ops, calls / inlined,
+        reference * 1e9 / ops, reference_name);
+}
+
+// ---------------| VEC2 |-------------------------------
+/* the inner loops of gjk: a support scan over the vertices and a triple product */
+static double bench_inline_gjk_helpers(const gjk_vec2* vertices, const gjk_vec2* dirs, float* sink)
+{
+    double start = bench_time();
+    for (int r = 0; r < BENCH_INLINE_REPEAT; ++r)
+    {
+        for (size_t i = 0; i < BENCH_INLINE_COUNT; ++i)
+        {
+            const gjk_vec2* v = vertices + i * BENCH_INLINE_VERTS;
+            gjk_vec2 d = dirs[i];
+
+            size_t best = 0;
+            float max_dot = gjk_dot_product(v[0], d);
+            for (size_t k = 1; k < BENCH_INLINE_VERTS; ++k)
+            {
+                float dot = gjk_dot_product(v[k], d);
+                if (dot > max_dot) { max_dot = dot; best = k; }
+            }
+
+            gjk_vec2 ab = gjk_sub(v[best], v[0]);
+            gjk_vec2 n = gjk_triple_product(ab, gjk_negate(v[0]), ab);
+            *sink += n.x + n.y;
+        }
+    }
+    return bench_time() - start;
+}
+
+static double bench_inline_vec2_calls(const vec2* vertices, const vec2* dirs, float* sink)
+{
+    double start = bench_time();
+    for (int r = 0; r < BENCH_INLINE_REPEAT; ++r)
+    {
+        for (size_t i = 0; i < BENCH_INLINE_COUNT; ++i)
+        {
+            const vec2* v = vertices + i * BENCH_INLINE_VERTS;
+            vec2 d = dirs[i];
+
+            size_t best = 0;
+            float max_dot = bench_call_vec2_dot(v[0], d);
+            for (size_t k = 1; k < BENCH_INLINE_VERTS; ++k)
+            {
+                float dot = bench_call_vec2_dot(v[k], d);
+                if (dot > max_dot) { max_dot = dot; best = k; }
+            }
+
+            vec2 ab = bench_call_vec2_sub(v[best], v[0]);
+            vec2 ao = bench_call_vec2_mult(v[0], -1.0f);
+            vec2 n = bench_call_vec2_sub(bench_call_vec2_mult(ao, bench_call_vec2_dot(ab, ab)),
+                                         bench_call_vec2_mult(ab, bench_call_vec2_dot(ao, ab)));
+            *sink += n.x + n.y;
+        }
+    }
+    return bench_time() - start;
+}
+
+static double bench_inline_vec2(const vec2* vertices, const vec2* dirs, float* sink)
+{
+    double start = bench_time();
+    for (int r = 0; r < BENCH_INLINE_REPEAT; ++r)
+    {
+        for (size_t i = 0; i < BENCH_INLINE_COUNT; ++i)
+        {
+            const vec2* v = vertices + i * BENCH_INLINE_VERTS;
+            vec2 d = dirs[i];
+
+            size_t best = 0;
+            float max_dot = vec2_dot(v[0], d);
+            for (size_t k = 1; k < BENCH_INLINE_VERTS; ++k)
+            {
+                float dot = vec2_dot(v[k], d);
+                if (dot > max_dot) { max_dot = dot; best = k; }
+            }
+
+            vec2 ab = vec2_sub(v[best], v[0]);
+            vec2 ao = vec2_mult(v[0], -1.0f);
+            vec2 n = vec2_sub(vec2_mult(ao, vec2_dot(ab, ab)), vec2_mult(ab, vec2_dot(ao, ab)));
+            *sink += n.x + n.y;
+        }
+    }
+    return bench_time() - start;
+}
+
+// ---------------| VEC3 |-------------------------------
+static double bench_inline_vec3_calls(const vec3* a, const vec3* b, float* sink)
+{
+    double start = bench_time();
+    for (int r = 0; r < BENCH_INLINE_REPEAT; ++r)
+    {
+        for (size_t i = 0; i < BENCH_INLINE_COUNT; ++i)
+        {
+            vec3 n = bench_call_vec3_normalize(bench_call_vec3_cross(a[i], b[i]));
+            *sink += bench_call_vec3_dot(n, bench_call_vec3_lerp(a[i], b[i], 0.5f));
+        }
+    }
+    return bench_time() - start;
+}
+
+static double bench_inline_vec3(const vec3* a, const vec3* b, float* sink)
+{
+    double start = bench_time();
+    for (int r = 0; r < BENCH_INLINE_REPEAT; ++r)
+    {
+        for (size_t i = 0; i < BENCH_INLINE_COUNT; ++i)
+        {
+            vec3 n = vec3_normalize(vec3_cross(a[i], b[i]));
+            *sink += vec3_dot(n, vec3_lerp(a[i], b[i], 0.5f));
+        }
+    }
+    return bench_time() - start;
+}
+
+// ---------------| MAT4 |-------------------------------
+static double bench_inline_mat4_calls(const mat4* m, const vec3* p, mat4* out)
+{
+    double start = bench_time();
+    for (int r = 0; r < BENCH_INLINE_REPEAT; ++r)
+        for (size_t i = 0; i < BENCH_INLINE_COUNT; ++i)
+            out[i] = bench_call_mat4_multiply(m[i], bench_call_mat4_translation(p[i]));
+    return bench_time() - start;
+}
+
+static double bench_inline_mat4(const mat4* m, const vec3* p, mat4* out)
+{
+    double start = bench_time();
+    for (int r = 0; r < BENCH_INLINE_REPEAT; ++r)
+        for (size_t i = 0; i < BENCH_INLINE_COUNT; ++i)
+            out[i] = mat4_multiply(m[i], mat4_translation(p[i]));
+    return bench_time() - start;
+}
+
+void bench_math_inline()
+{
+    vec2* vertices = malloc(sizeof(vec2) * BENCH_INLINE_COUNT * BENCH_INLINE_VERTS);
+    vec2* dirs = malloc(sizeof(vec2) * BENCH_INLINE_COUNT);
+    vec3* a = malloc(sizeof(vec3) * BENCH_INLINE_COUNT);
+    vec3* b = malloc(sizeof(vec3) * BENCH_INLINE_COUNT);
+    mat4* m = malloc(sizeof(mat4) * BENCH_INLINE_COUNT);
+    mat4* out = malloc(sizeof(mat4) * BENCH_INLINE_COUNT);
+
+    bench_seed(23);
+    for (size_t i = 0; i < BENCH_INLINE_COUNT * BENCH_INLINE_VERTS; ++i)
+        vertices[i] = (vec2) { bench_randf(-1.0f, 1.0f), bench_randf(-1.0f, 1.0f) };
+
+    for (size_t i = 0; i < BENCH_INLINE_COUNT; ++i)
+    {
+        dirs[i] = (vec2) { bench_randf(-1.0f, 1.0f), bench_randf(-1.0f, 1.0f) };
+        a[i] = (vec3) { bench_randf(-1.0f, 1.0f), bench_randf(-1.0f, 1.0f), bench_randf(-1.0f, 1.0f) };
+        b[i] = (vec3) { bench_randf(-1.0f, 1.0f), bench_randf(-1.0f, 1.0f), bench_randf(-1.0f, 1.0f) };
+        m[i] = mat4_rotation(vec3_normalize(a[i]), bench_randf(0.0f, 6.2831853f));
+    }
+
+    printf("math inline: %d elements, %d repeats, ns per element\n", BENCH_INLINE_COUNT, BENCH_INLINE_REPEAT);
+    printf("  %12s %10s %10s %9s %10s\n", "loop", "calls", "inline", "speedup", "reference");
+
+    /* gjk_vec2 and vec2 share the layout, the helpers of gjk.h are the reference */
+    float sink = 0.0f;
+    double calls = bench_inline_vec2_calls(vertices, dirs, &sink);
+    double inlined = bench_inline_vec2(vertices, dirs, &sink);
+    double reference = bench_inline_gjk_helpers((const gjk_vec2*)vertices, (const gjk_vec2*)dirs, &sink);
+    bench_inline_print("gjk support", calls, inlined, reference, "gjk.h helpers");
+
+    calls = bench_inline_vec3_calls(a, b, &sink);
+    inlined = bench_inline_vec3(a, b, &sink);
+
+    double start = bench_time();
+    for (int r = 0; r < BENCH_INLINE_REPEAT; ++r)
+        sink += bench_linmath_vec3_chain(&a[0].x, &b[0].x, BENCH_INLINE_COUNT);
+    reference = bench_time() - start;
+    bench_inline_print("vec3 chain", calls, inlined, reference, "linmath.h");
+
+    calls = bench_inline_mat4_calls(m, a, out);
+    inlined = bench_inline_mat4(m, a, out);
+
+    start = bench_time();
+    for (int r = 0; r < BENCH_INLINE_REPEAT; ++r)
+        bench_linmath_translate_multiply(out[0].v[0], m[0].v[0], &a[0].x, BENCH_INLINE_COUNT);
+    reference = bench_time() - start;
+    bench_inline_print("mat4 chain", calls, inlined, reference, "linmath.h");
+
+    printf("  (sink %g)\n", sink);
+
+    free(vertices);
+    free(dirs);
+    free(a);
+    free(b);
+    free(m);
+    free(out);
+}
@@ -0,0 +1,169 @@
+#include "bench.h"
+
+#include "narrowphase.h"
+#include "manifold.h"
+#include "spatial_hash.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define BENCH_NARROW_SHAPES 100000
+#define BENCH_NARROW_REPEAT 8
+
+void bench_narrowphase()
+{
+    bench_scene scene;
+    spatial_hash hash;
+
+    /* dense scene with about 100k candidate pairs */
+    bench_seed(12);
+    bench_scene_create(&scene, BENCH_NARROW_SHAPES, 880.0f, 0.5f, 1.5f);
+    spatial_hash_init(&hash, 3.0f);
+    spatial_hash_build(&hash, scene.shapes, scene.count);
+    size_t pair_count = spatial_hash_update_pairs(&hash);
+
+    uint32_t hardware = job_hardware_threads();
+    printf("narrowphase: %zu pairs, %u cores (ms/run)\n", pair_count, hardware);
+    printf("  %8s %10s %8s %10s %10s\n", "workers", "time", "speedup", "contacts", "checksum");
+
+    double base = 0.0;
+    size_t expected = 0;
+    for (uint32_t workers = 1; workers <= 16; workers *= 2)
+    {
+        job_system* jobs = workers > 1 ? job_system_create(workers) : NULL;
+        narrowphase np;
+        narrowphase_init(&np, jobs);
+
+        /* untimed run to grow the contact buffers and warm the caches and the threads */
+        size_t contacts = narrowphase_run(&np, jobs, scene.shapes, hash.pairs, pair_count);
+
+        double start = bench_time();
+        for (int r = 0; r < BENCH_NARROW_REPEAT; ++r)
+            contacts = narrowphase_run(&np, jobs, scene.shapes, hash.pairs, pair_count);
+        double time = (bench_time() - start) / BENCH_NARROW_REPEAT;
+
+        /* the order of the contacts depends on the scheduling, the sum does not */
+        double checksum = 0.0;
+        for (uint32_t w = 0; w < np.buffer_count; ++w)
+            for (size_t i = 0; i < np.buffers[w].count; ++i)
+                checksum += np.buffers[w].contacts[i].penetration.depth;
+
+        if (workers == 1)
+        {
+            base = time;
+            expected = contacts;
+        }
+
+        /* more workers than cores only measure the scheduling overhead */
+        char speedup[16] = "-";
+        if (workers <= hardware) snprintf(speedup, sizeof(speedup), "%.2fx", base / time);
+
+        printf("  %8u %10.3f %8s %10zu %10.4f%s\n", workers, time * 1e3, speedup, contacts, checksum,
+            contacts == expected ? "" : " (mismatch)");
+
+        narrowphase_destroy(&np);
+        job_system_destroy(jobs);
+    }
+    if (hardware < 16) printf("  speedups are only shown up to one worker per core\n");
+
+    spatial_hash_destroy(&hash);
+    bench_scene_destroy(&scene);
+}
+
+#define BENCH_STACKS         1024
+#define BENCH_MANIFOLD_TICKS 60
+
+/* resting boxes with a little jitter every frame, like a settled stack in a solver */
+static void bench_stack_jitter(gjk_shape* boxes, const gjk_vec2* rest, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        gjk_set_center(&boxes[i], (gjk_vec2){ rest[i].x + bench_randf(-0.001f, 0.001f), rest[i].y + bench_randf(-0.001f, 0.001f) });
+        gjk_set_rotation(&boxes[i], bench_randf(-0.002f, 0.002f));
+    }
+}
+
+void bench_manifold()
+{
+    /* polygons instead of gjk_box, so every fresh manifold pays for gjk and epa */
+    static const gjk_vec2 unit[4] = { { -0.5f, -0.5f }, { 0.5f, -0.5f }, { 0.5f, 0.5f }, { -0.5f, 0.5f } };
+    gjk_vec2 floor_verts[4] = { { -2000.0f, -1.0f }, { 2000.0f, -1.0f }, { 2000.0f, 0.0f }, { -2000.0f, 0.0f } };
+
+    gjk_shape ground;
+    gjk_poly(&ground, floor_verts, 4);
+
+    /* two boxes per stack, pairs are bottom/ground and top/bottom */
+    size_t count = BENCH_STACKS * 2;
+    gjk_shape* boxes = malloc(sizeof(gjk_shape) * count);
+    gjk_vec2* rest = malloc(sizeof(gjk_vec2) * count);
+    manifold_cache* caches = calloc(count, sizeof(manifold_cache));
+    manifold* fresh = malloc(sizeof(manifold) * count);
+
+    for (size_t i = 0; i < BENCH_STACKS; ++i)
+    {
+        float x = (float)i * 2.0f - (float)BENCH_STACKS;
+        rest[2 * i] = (gjk_vec2){ x, 0.495f };
+        rest[2 * i + 1] = (gjk_vec2){ x, 1.49f };
+        gjk_poly(&boxes[2 * i], unit, 4);
+        gjk_poly(&boxes[2 * i + 1], unit, 4);
+    }
+
+    bench_seed(13);
+    double time_fresh = 0.0, time_cached = 0.0;
+    size_t points = 0, matched = 0, count_mismatches = 0;
+    float max_error = 0.0f;
+    for (int tick = 0; tick < BENCH_MANIFOLD_TICKS; ++tick)
+    {
+        bench_stack_jitter(boxes, rest, count);
+
+        double start = bench_time();
+        for (size_t i = 0; i < count; ++i)
+        {
+            const gjk_shape* s2 = i & 1 ? &boxes[i - 1] : &ground;
+            gjk_penetration penetration;
+            fresh[i].count = 0;
+            if (gjk_intersect(&boxes[i], s2, &penetration))
+                manifold_build(&boxes[i], s2, penetration.normal, &fresh[i]);
+        }
+        time_fresh += bench_time() - start;
+
+        start = bench_time();
+        for (size_t i = 0; i < count; ++i)
+            manifold_collide(&boxes[i], i & 1 ? &boxes[i - 1] : &ground, &caches[i]);
+        time_cached += bench_time() - start;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            manifold* m = &caches[i].manifold;
+            if (m->count != fresh[i].count)
+            {
+                count_mismatches++;
+                continue;
+            }
+
+            for (uint8_t p = 0; p < m->count; ++p)
+            {
+                /* the solver would write impulses here, count the ones that survived from the last tick */
+                points++;
+                matched += m->points[p].normal_impulse == 1.0f;
+                m->points[p].normal_impulse = 1.0f;
+
+                float error = fabsf(m->points[p].separation - fresh[i].points[p].separation);
+                if (error > max_error) max_error = error;
+            }
+        }
+    }
+
+    double pairs = (double)count * BENCH_MANIFOLD_TICKS;
+    printf("manifold: %zu resting pairs, %zu points\n", count, points / BENCH_MANIFOLD_TICKS);
+    printf("  fresh gjk + epa + clip: %8.1f ns/pair\n", time_fresh * 1e9 / pairs);
+    printf("  cached normal + clip:   %8.1f ns/pair (%.2fx)\n", time_cached * 1e9 / pairs, time_fresh / time_cached);
+    printf("  %zu count mismatches, max separation error %g, %.1f%% points kept their impulse\n",
+        count_mismatches, max_error, 100.0 * (double)matched / (double)points);
+
+    free(boxes);
+    free(rest);
+    free(caches);
+    free(fresh);
+}
@@ -0,0 +1,165 @@
+#include "bench.h"
+
+#include "math/quat.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+/*
+ * An animation frame for a crowd of transforms: every transform blends
+ * between two keyframes at its own time and is converted to a world
+ * matrix. The errors are the rotation angles to the exact slerp.
+ */
+
+#define BENCH_QUAT_TRANSFORMS 10000
+#define BENCH_QUAT_FRAMES     64
+
+typedef struct
+{
+    quat* q0;
+    quat* q1;
+    vec3* p0;
+    vec3* p1;
+    float* phases;
+    float* values;
+    quat* rotations;
+    quat* reference;
+    vec3* positions;
+    mat4* matrices;
+} bench_quat_data;
+
+static quat bench_quat_random()
+{
+    vec3 axis = { bench_randf(-1.0f, 1.0f), bench_randf(-1.0f, 1.0f), bench_randf(-1.0f, 1.0f) };
+    return quat_from_axis_angle(vec3_normalize(axis), bench_randf(0.0f, 6.2831853f));
+}
+
+/* angle of the rotation between a and b, in double so small angles survive */
+static double bench_quat_angle(quat a, quat b)
+{
+    double x = (double)b.w * a.x - (double)b.x * a.w - (double)b.y * a.z + (double)b.z * a.y;
+    double y = (double)b.w * a.y + (double)b.x * a.z - (double)b.y * a.w - (double)b.z * a.x;
+    double z = (double)b.w * a.z - (double)b.x * a.y + (double)b.y * a.x - (double)b.z * a.w;
+    double w = (double)b.w * a.w + (double)b.x * a.x + (double)b.y * a.y + (double)b.z * a.z;
+    return 2.0 * atan2(sqrt(x * x + y * y + z * z), fabs(w));
+}
+
+static void bench_quat_values(bench_quat_data* d, int frame)
+{
+    for (size_t i = 0; i < BENCH_QUAT_TRANSFORMS; ++i)
+    {
+        float t = d->phases[i] + (float)frame / BENCH_QUAT_FRAMES;
+        d->values[i] = t - floorf(t);
+        d->positions[i] = vec3_lerp(d->p0[i], d->p1[i], d->values[i]);
+    }
+}
+
+typedef enum
+{
+    BENCH_QUAT_SCALAR,
+    BENCH_QUAT_SLERP,
+    BENCH_QUAT_NLERP,
+    BENCH_QUAT_APPROX
+} bench_quat_method;
+
+/* runs every frame with one method, returns the time per frame and the largest error */
+static double bench_quat_run(bench_quat_data* d, bench_quat_method method, double* max_error)
+{
+    double time = 0.0;
+    *max_error = 0.0;
+    for (int frame = 0; frame < BENCH_QUAT_FRAMES; ++frame)
+    {
+        bench_quat_values(d, frame);
+
+        double start = bench_time();
+        switch (method)
+        {
+        case BENCH_QUAT_SCALAR:
+            for (size_t i = 0; i < BENCH_QUAT_TRANSFORMS; ++i)
+            {
+                d->rotations[i] = quat_slerp(d->q0[i], d->q1[i], d->values[i]);
+                d->matrices[i] = mat4_multiply(mat4_translation(d->positions[i]), mat4_cast(d->rotations[i]));
+            }
+            break;
+        case BENCH_QUAT_SLERP:
+            quat_batch_slerp(d->q0, d->q1, d->values, d->rotations, BENCH_QUAT_TRANSFORMS);
+            break;
+        case BENCH_QUAT_NLERP:
+            quat_batch_nlerp(d->q0, d->q1, d->values, d->rotations, BENCH_QUAT_TRANSFORMS);
+            break;
+        case BENCH_QUAT_APPROX:
+            quat_batch_slerp_approx(d->q0, d->q1, d->values, d->rotations, BENCH_QUAT_TRANSFORMS);
+            break;
+        }
+        if (method != BENCH_QUAT_SCALAR)
+            quat_batch_to_mat4(d->rotations, d->positions, d->matrices, BENCH_QUAT_TRANSFORMS);
+        time += bench_time() - start;
+
+        quat_batch_slerp(d->q0, d->q1, d->values, d->reference, BENCH_QUAT_TRANSFORMS);
+        for (size_t i = 0; i < BENCH_QUAT_TRANSFORMS; ++i)
+        {
+            double error = bench_quat_angle(d->rotations[i], d->reference[i]);
+            if (error > *max_error) *max_error = error;
+        }
+    }
+    return time / BENCH_QUAT_FRAMES;
+}
+
+void bench_quat()
+{
+    bench_quat_data d;
+    d.q0 = malloc(sizeof(quat) * BENCH_QUAT_TRANSFORMS);
+    d.q1 = malloc(sizeof(quat) * BENCH_QUAT_TRANSFORMS);
+    d.p0 = malloc(sizeof(vec3) * BENCH_QUAT_TRANSFORMS);
+    d.p1 = malloc(sizeof(vec3) * BENCH_QUAT_TRANSFORMS);
+    d.phases = malloc(sizeof(float) * BENCH_QUAT_TRANSFORMS);
+    d.values = malloc(sizeof(float) * BENCH_QUAT_TRANSFORMS);
+    d.rotations = malloc(sizeof(quat) * BENCH_QUAT_TRANSFORMS);
+    d.reference = malloc(sizeof(quat) * BENCH_QUAT_TRANSFORMS);
+    d.positions = malloc(sizeof(vec3) * BENCH_QUAT_TRANSFORMS);
+    d.matrices = malloc(sizeof(mat4) * BENCH_QUAT_TRANSFORMS);
+
+    bench_seed(24);
+    for (size_t i = 0; i < BENCH_QUAT_TRANSFORMS; ++i)
+    {
+        d.q0[i] = bench_quat_random();
+        d.q1[i] = bench_quat_random();
+        d.p0[i] = (vec3) { bench_randf(-10.0f, 10.0f), bench_randf(-10.0f, 10.0f), bench_randf(-10.0f, 10.0f) };
+        d.p1[i] = (vec3) { bench_randf(-10.0f, 10.0f), bench_randf(-10.0f, 10.0f), bench_randf(-10.0f, 10.0f) };
+        d.phases[i] = bench_randf(0.0f, 1.0f);
+    }
+
+    printf("quat: %d transforms, %d frames, interpolation and world matrices per frame\n", BENCH_QUAT_TRANSFORMS, BENCH_QUAT_FRAMES);
+    printf("  %22s %10s %10s %14s\n", "method", "us/frame", "ns/xform", "max error rad");
+
+    const char* names[] = { "slerp + mat4 per xform", "batch slerp", "batch nlerp", "batch slerp approx" };
+    for (int method = BENCH_QUAT_SCALAR; method <= BENCH_QUAT_APPROX; ++method)
+    {
+        double error;
+        double time = bench_quat_run(&d, method, &error);
+        printf("  %22s %10.1f %10.2f %14.6f\n", names[method], time * 1e6, time * 1e9 / BENCH_QUAT_TRANSFORMS, error);
+    }
+
+    /* the matrices of the batch against mat4_cast */
+    float max_diff = 0.0f;
+    quat_batch_to_mat4(d.q0, d.p0, d.matrices, BENCH_QUAT_TRANSFORMS);
+    for (size_t i = 0; i < BENCH_QUAT_TRANSFORMS; ++i)
+    {
+        mat4 m = mat4_multiply(mat4_translation(d.p0[i]), mat4_cast(d.q0[i]));
+        for (int e = 0; e < 16; ++e)
+            max_diff = fmaxf(max_diff, fabsf(m.v[e / 4][e % 4] - d.matrices[i].v[e / 4][e % 4]));
+    }
+    printf("  batch matrices differ from mat4_cast by %g\n", max_diff);
+
+    free(d.q0);
+    free(d.q1);
+    free(d.p0);
+    free(d.p1);
+    free(d.phases);
+    free(d.values);
+    free(d.rotations);
+    free(d.reference);
+    free(d.positions);
+    free(d.matrices);
+}
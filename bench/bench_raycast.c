@@ -0,0 +1,209 @@
+#include "bench.h"
+
+#include "aabb_tree.h"
+#include "raycast.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define BENCH_RAY_SHAPES    20000
+#define BENCH_RAY_AREA      400.0f
+#define BENCH_RAY_VIEWERS   256
+#define BENCH_RAY_FAN       64    /* rays per viewer */
+#define BENCH_RAY_RANGE     40.0f
+#define BENCH_RAY_THICKNESS 0.01f /* of the polygons used as rays before */
+#define BENCH_RAY_REPEAT    4
+#define BENCH_RAY_CASTS     4096
+
+typedef struct
+{
+    const gjk_shape* shapes;
+    const gjk_shape* ray;
+    uint8_t blocked;
+} bench_thin_query;
+
+static void bench_thin_callback(void* user, uint32_t shape)
+{
+    bench_thin_query* query = user;
+    if (!query->blocked) query->blocked = gjk_collision(query->ray, &query->shapes[shape], NULL);
+}
+
+typedef struct
+{
+    const gjk_shape* shapes;
+    raycast_ray ray;
+    raycast_hit hit;
+} bench_ray_query;
+
+static void bench_ray_callback(void* user, uint32_t shape)
+{
+    bench_ray_query* query = user;
+    float max_fraction = query->hit.hit ? query->hit.fraction : 1.0f;
+
+    raycast_hit hit;
+    if (raycast_shape(&query->shapes[shape], query->ray, max_fraction, &hit))
+    {
+        hit.shape = shape;
+        query->hit = hit;
+    }
+}
+
+static gjk_aabb bench_ray_aabb(raycast_ray ray)
+{
+    gjk_vec2 end = gjk_add(ray.origin, ray.translation);
+    gjk_aabb aabb;
+    aabb.min = (gjk_vec2) { fminf(ray.origin.x, end.x), fminf(ray.origin.y, end.y) };
+    aabb.max = (gjk_vec2) { fmaxf(ray.origin.x, end.x), fmaxf(ray.origin.y, end.y) };
+    return aabb;
+}
+
+static size_t bench_count_hits(const raycast_hit* hits, size_t count)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < count; ++i)
+        n += hits[i].hit;
+    return n;
+}
+
+void bench_raycast()
+{
+    bench_scene scene;
+    aabb_tree tree;
+
+    bench_seed(16);
+    bench_scene_create(&scene, BENCH_RAY_SHAPES, BENCH_RAY_AREA, 0.5f, 1.5f);
+    aabb_tree_init(&tree, 0.0f);
+    for (size_t i = 0; i < scene.count; ++i)
+        aabb_tree_insert(&tree, gjk_shape_aabb(&scene.shapes[i]), (uint32_t)i);
+
+    /* every viewer looks at targets around it, its rays are next to each other */
+    size_t count = BENCH_RAY_VIEWERS * BENCH_RAY_FAN;
+    raycast_ray* rays = malloc(sizeof(raycast_ray) * count);
+    raycast_ray* shuffled = malloc(sizeof(raycast_ray) * count);
+    raycast_hit* hits = malloc(sizeof(raycast_hit) * count);
+    raycast_hit* shuffled_hits = malloc(sizeof(raycast_hit) * count);
+    for (size_t v = 0; v < BENCH_RAY_VIEWERS; ++v)
+    {
+        gjk_vec2 origin = { bench_randf(0.0f, BENCH_RAY_AREA), bench_randf(0.0f, BENCH_RAY_AREA) };
+        for (size_t i = 0; i < BENCH_RAY_FAN; ++i)
+        {
+            float angle = bench_randf(0.0f, 6.2831853f);
+            float length = bench_randf(1.0f, BENCH_RAY_RANGE);
+            rays[v * BENCH_RAY_FAN + i] = (raycast_ray) { origin, { cosf(angle) * length, sinf(angle) * length } };
+        }
+    }
+
+    /* the same rays in random order */
+    size_t* order = malloc(sizeof(size_t) * count);
+    for (size_t i = 0; i < count; ++i) order[i] = i;
+    for (size_t i = count - 1; i > 0; --i)
+    {
+        size_t j = bench_rand() % (i + 1);
+        size_t t = order[i]; order[i] = order[j]; order[j] = t;
+    }
+    for (size_t i = 0; i < count; ++i) shuffled[i] = rays[order[i]];
+
+    /* line of sight with thin polygons, only tells if something is in the way */
+    size_t blocked = 0, disagreements = 0;
+    double start = bench_time();
+    for (int r = 0; r < BENCH_RAY_REPEAT; ++r)
+    {
+        blocked = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            gjk_vec2 a = rays[i].origin;
+            gjk_vec2 b = gjk_add(a, rays[i].translation);
+            gjk_vec2 n = gjk_perpendicular(gjk_normalize(rays[i].translation));
+            n = (gjk_vec2) { n.x * BENCH_RAY_THICKNESS, n.y * BENCH_RAY_THICKNESS };
+
+            gjk_vec2 quad[4] = { gjk_sub(a, n), gjk_sub(b, n), gjk_add(b, n), gjk_add(a, n) };
+            gjk_shape thin;
+            gjk_poly(&thin, quad, 4);
+
+            bench_thin_query query = { scene.shapes, &thin, 0 };
+            aabb_tree_query(&tree, gjk_shape_aabb(&thin), bench_thin_callback, &query);
+            blocked += query.blocked;
+        }
+    }
+    double time_thin = bench_time() - start;
+
+    /* one ray at a time, aabb query along the ray and keep the nearest hit */
+    start = bench_time();
+    for (int r = 0; r < BENCH_RAY_REPEAT; ++r)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            bench_ray_query query = { .shapes = scene.shapes, .ray = rays[i] };
+            aabb_tree_query(&tree, bench_ray_aabb(rays[i]), bench_ray_callback, &query);
+            hits[i] = query.hit;
+        }
+    }
+    double time_query = bench_time() - start;
+    size_t query_hits = bench_count_hits(hits, count);
+
+    start = bench_time();
+    for (int r = 0; r < BENCH_RAY_REPEAT; ++r)
+        raycast_batch(&tree, scene.shapes, shuffled, count, shuffled_hits);
+    double time_shuffled = bench_time() - start;
+
+    start = bench_time();
+    for (int r = 0; r < BENCH_RAY_REPEAT; ++r)
+        raycast_batch(&tree, scene.shapes, rays, count, hits);
+    double time_batch = bench_time() - start;
+    size_t batch_hits = bench_count_hits(hits, count);
+
+    /* the thin polygons are a bit wider than the rays, only count real disagreements */
+    size_t order_mismatches = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const raycast_hit* s = &shuffled_hits[i];
+        const raycast_hit* h = &hits[order[i]];
+        if (s->hit != h->hit || (s->hit && s->fraction != h->fraction)) order_mismatches++;
+    }
+    disagreements = blocked > batch_hits ? blocked - batch_hits : batch_hits - blocked;
+
+    double rays_total = (double)count * BENCH_RAY_REPEAT;
+    printf("raycast: %d shapes, %zu rays from %d viewers, %zu hits (%zu thin polygons blocked, %zu aabb query hits)\n",
+        BENCH_RAY_SHAPES, count, BENCH_RAY_VIEWERS, batch_hits, blocked, query_hits);
+    printf("  thin polygons:         %8.1f ns/ray (no hit point)\n", time_thin * 1e9 / rays_total);
+    printf("  aabb query per ray:    %8.1f ns/ray\n", time_query * 1e9 / rays_total);
+    printf("  batch, shuffled rays:  %8.1f ns/ray\n", time_shuffled * 1e9 / rays_total);
+    printf("  batch, coherent rays:  %8.1f ns/ray\n", time_batch * 1e9 / rays_total);
+    printf("  %zu results differ between the orders, %zu between thin polygons and rays\n", order_mismatches, disagreements);
+
+    /* shape casts of small shapes through the scene */
+    gjk_shape* casts = malloc(sizeof(gjk_shape) * BENCH_RAY_CASTS);
+    gjk_vec2* translations = malloc(sizeof(gjk_vec2) * BENCH_RAY_CASTS);
+    gjk_vec2 box[4] = { { -0.4f, -0.2f }, { 0.4f, -0.2f }, { 0.4f, 0.2f }, { -0.4f, 0.2f } };
+    for (size_t i = 0; i < BENCH_RAY_CASTS; ++i)
+    {
+        gjk_vec2 origin = rays[i * (count / BENCH_RAY_CASTS)].origin;
+        if (i & 1)
+        {
+            gjk_circle(&casts[i], origin, 0.3f);
+        }
+        else
+        {
+            gjk_poly(&casts[i], box, 4);
+            gjk_set_center(&casts[i], origin);
+            gjk_set_rotation(&casts[i], bench_randf(0.0f, 3.14159265f));
+        }
+        translations[i] = rays[i * (count / BENCH_RAY_CASTS)].translation;
+    }
+
+    start = bench_time();
+    raycast_shape_cast_batch(&tree, scene.shapes, casts, translations, BENCH_RAY_CASTS, hits);
+    double time_cast = bench_time() - start;
+    printf("  shape casts:           %8.1f ns/cast, %zu of %d hit\n", time_cast * 1e9 / BENCH_RAY_CASTS, bench_count_hits(hits, BENCH_RAY_CASTS), BENCH_RAY_CASTS);
+
+    free(casts);
+    free(translations);
+    free(order);
+    free(rays);
+    free(shuffled);
+    free(hits);
+    free(shuffled_hits);
+    aabb_tree_destroy(&tree);
+    bench_scene_destroy(&scene);
+}
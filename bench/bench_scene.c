@@ -0,0 +1,64 @@
+#include "bench.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+void bench_scene_create(bench_scene* scene, size_t count, float area, float min_radius, float max_radius)
+{
+    scene->shapes = malloc(sizeof(gjk_shape) * count);
+    scene->velocities = malloc(sizeof(gjk_vec2) * count);
+    scene->vertices = malloc(sizeof(gjk_vec2) * count * BENCH_MAX_VERTS);
+    scene->count = count;
+    scene->area = area;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        gjk_vec2 center = { bench_randf(0.0f, area), bench_randf(0.0f, area) };
+        float radius = bench_randf(min_radius, max_radius);
+
+        scene->velocities[i].x = bench_randf(-1.0f, 1.0f);
+        scene->velocities[i].y = bench_randf(-1.0f, 1.0f);
+
+        if (bench_rand() & 1)
+        {
+            gjk_circle(&scene->shapes[i], center, radius);
+            continue;
+        }
+
+        /* convex polygon in local space with vertices on a circle, ordered counter-clockwise */
+        gjk_vec2* vertices = scene->vertices + i * BENCH_MAX_VERTS;
+        size_t n = 3 + bench_rand() % (BENCH_MAX_VERTS - 2);
+        float angle = bench_randf(0.0f, 6.2831853f);
+        for (size_t v = 0; v < n; ++v)
+        {
+            float a = angle + 6.2831853f * (float)v / (float)n;
+            vertices[v].x = radius * cosf(a);
+            vertices[v].y = radius * sinf(a);
+        }
+        gjk_poly(&scene->shapes[i], vertices, n);
+        gjk_set_center(&scene->shapes[i], center);
+    }
+}
+
+void bench_scene_destroy(bench_scene* scene)
+{
+    free(scene->shapes);
+    free(scene->velocities);
+    free(scene->vertices);
+}
+
+void bench_scene_step(bench_scene* scene, float dt)
+{
+    for (size_t i = 0; i < scene->count; ++i)
+    {
+        gjk_shape* shape = &scene->shapes[i];
+        gjk_vec2* v = &scene->velocities[i];
+
+        /* bounce off the borders of the area */
+        gjk_vec2 c = { shape->center.x + v->x * dt, shape->center.y + v->y * dt };
+        if (c.x < 0.0f || c.x > scene->area) v->x = -v->x;
+        if (c.y < 0.0f || c.y > scene->area) v->y = -v->y;
+
+        gjk_set_center(shape, c);
+    }
+}
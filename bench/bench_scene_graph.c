@@ -0,0 +1,127 @@
+#include "bench.h"
+
+#include "scene_graph.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+/*
+ * A large scene where most nodes never move. The full rebuild recomputes
+ * every local and world matrix each frame like example_cube did, the
+ * scene graph only the dirty nodes and their subtrees. The error is the
+ * largest difference of the incremental worlds to the full rebuild.
+ */
+
+#define BENCH_SCENE_GRAPH_NODES  100000
+#define BENCH_SCENE_GRAPH_FRAMES 64
+
+static vec3 bench_scene_graph_vec(float min, float max)
+{
+    return (vec3) { bench_randf(min, max), bench_randf(min, max), bench_randf(min, max) };
+}
+
+static quat bench_scene_graph_rotation()
+{
+    vec3 axis = bench_scene_graph_vec(-1.0f, 1.0f);
+    return quat_from_axis_angle(vec3_normalize(axis), bench_randf(0.0f, 6.2831853f));
+}
+
+/* what the scene cost without the graph: every matrix from scratch in parent before child order */
+static void bench_scene_graph_rebuild(const scene_graph* graph, mat4* worlds)
+{
+    for (int32_t i = 0; i < graph->count; ++i)
+    {
+        mat4 local = mat4_multiply(mat4_translation(graph->translations[i]), mat4_multiply(mat4_cast(graph->rotations[i]), mat4_scale(graph->scales[i])));
+
+        int32_t parent = graph->parents[i];
+        worlds[i] = parent == SCENE_GRAPH_NULL ? local : mat4_multiply(worlds[parent], local);
+    }
+}
+
+static float bench_scene_graph_error(const mat4* a, const mat4* b, int32_t count)
+{
+    float error = 0.0f;
+    for (int32_t i = 0; i < count; ++i)
+        for (int c = 0; c < 4; ++c)
+            for (int r = 0; r < 4; ++r)
+                error = fmaxf(error, fabsf(a[i].v[c][r] - b[i].v[c][r]) / fmaxf(1.0f, fabsf(b[i].v[c][r])));
+    return error;
+}
+
+/* moves the given nodes every frame, returns the time per frame */
+static double bench_scene_graph_run(scene_graph* graph, const int32_t* nodes, size_t count, double* updated)
+{
+    double time = 0.0;
+    uint64_t total = 0;
+    for (int frame = 0; frame < BENCH_SCENE_GRAPH_FRAMES; ++frame)
+    {
+        double start = bench_time();
+        for (size_t i = 0; i < count; ++i)
+            scene_graph_set_rotation(graph, nodes[i], quat_from_axis_angle((vec3) { 0.0f, 1.0f, 0.0f }, 0.01f * frame));
+        total += scene_graph_update(graph);
+        time += bench_time() - start;
+    }
+    *updated = (double)total / BENCH_SCENE_GRAPH_FRAMES;
+    return time / BENCH_SCENE_GRAPH_FRAMES;
+}
+
+void bench_scene_graph()
+{
+    scene_graph graph;
+    scene_graph_init(&graph);
+
+    /* shallow random forest, every parent is one of the nodes before */
+    bench_seed(25);
+    for (int32_t i = 0; i < BENCH_SCENE_GRAPH_NODES; ++i)
+    {
+        int32_t parent = (i < 16) ? SCENE_GRAPH_NULL : (int32_t)(bench_rand() % (uint32_t)i);
+        scene_graph_add(&graph, parent, bench_scene_graph_vec(-1.0f, 1.0f), bench_scene_graph_rotation(), bench_scene_graph_vec(0.9f, 1.1f));
+    }
+    scene_graph_update(&graph);
+
+    mat4* reference = malloc(sizeof(mat4) * BENCH_SCENE_GRAPH_NODES);
+    int32_t* nodes = malloc(sizeof(int32_t) * BENCH_SCENE_GRAPH_NODES);
+
+    printf("scene graph: %d nodes, %d frames\n", BENCH_SCENE_GRAPH_NODES, BENCH_SCENE_GRAPH_FRAMES);
+    printf("  %16s %12s %12s %12s\n", "case", "us/frame", "updated", "max error");
+
+    double start = bench_time();
+    for (int frame = 0; frame < BENCH_SCENE_GRAPH_FRAMES; ++frame)
+        bench_scene_graph_rebuild(&graph, reference);
+    double rebuild = (bench_time() - start) / BENCH_SCENE_GRAPH_FRAMES;
+    printf("  %16s %12.1f %12d %12s\n", "full rebuild", rebuild * 1e6, BENCH_SCENE_GRAPH_NODES, "-");
+
+    struct
+    {
+        const char* name;
+        size_t count;
+        uint8_t tail; /* move the last nodes instead of random ones */
+    } cases[] = {
+        { "static", 0, 0 },
+        { "last 100", 100, 1 },
+        { "random 0.1%", BENCH_SCENE_GRAPH_NODES / 1000, 0 },
+        { "random 1%", BENCH_SCENE_GRAPH_NODES / 100, 0 },
+        { "all", BENCH_SCENE_GRAPH_NODES, 1 },
+    };
+
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); ++c)
+    {
+        for (size_t i = 0; i < cases[c].count; ++i)
+        {
+            if (cases[c].tail) nodes[i] = BENCH_SCENE_GRAPH_NODES - (int32_t)cases[c].count + (int32_t)i;
+            else               nodes[i] = (int32_t)(bench_rand() % BENCH_SCENE_GRAPH_NODES);
+        }
+
+        double updated;
+        double time = bench_scene_graph_run(&graph, nodes, cases[c].count, &updated);
+
+        bench_scene_graph_rebuild(&graph, reference);
+        float error = bench_scene_graph_error(graph.worlds, reference, graph.count);
+        printf("  %16s %12.1f %12.0f %12.2e\n", cases[c].name, time * 1e6, updated, error);
+    }
+
+    free(reference);
+    free(nodes);
+    scene_graph_destroy(&graph);
+}
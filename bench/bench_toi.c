@@ -0,0 +1,110 @@
+#include "bench.h"
+
+#include "toi.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_TOI_QUERIES   4096
+#define BENCH_TOI_SUBSTEPS  512
+#define BENCH_TOI_DT        (1.0f / 60.0f)
+#define BENCH_TOI_TOLERANCE 0.005f
+
+typedef struct
+{
+    gjk_shape s1, s2;
+    toi_motion m1, m2;
+} bench_toi_case;
+
+/* reference: the first of many substeps with an overlap, -1 without one */
+static int bench_toi_substeps(const bench_toi_case* c)
+{
+    for (int i = 0; i <= BENCH_TOI_SUBSTEPS; ++i)
+    {
+        float t = BENCH_TOI_DT * (float)i / (float)BENCH_TOI_SUBSTEPS;
+        gjk_shape a = toi_advance(&c->s1, c->m1, t);
+        gjk_shape b = toi_advance(&c->s2, c->m2, t);
+        if (gjk_collision(&a, &b, NULL)) return i;
+    }
+    return -1;
+}
+
+static void bench_toi_run(const char* name, const bench_toi_case* cases)
+{
+    size_t discrete = 0, expected = 0, hits = 0, misses = 0, early = 0, failed = 0;
+    uint32_t iterations = 0;
+
+    double time = 0.0;
+    for (size_t i = 0; i < BENCH_TOI_QUERIES; ++i)
+    {
+        const bench_toi_case* c = &cases[i];
+
+        /* what a test at the end of the step sees */
+        gjk_shape a = toi_advance(&c->s1, c->m1, BENCH_TOI_DT);
+        gjk_shape b = toi_advance(&c->s2, c->m2, BENCH_TOI_DT);
+        discrete += gjk_collision(&a, &b, NULL);
+
+        toi_result result;
+        double start = bench_time();
+        toi_query(&c->s1, c->m1, &c->s2, c->m2, BENCH_TOI_DT, BENCH_TOI_TOLERANCE, &result);
+        time += bench_time() - start;
+
+        iterations += result.iterations;
+        failed += result.state == TOI_FAILED;
+
+        int substep = bench_toi_substeps(c);
+        expected += substep >= 0;
+        /* a failed query still stops the shapes at a safe time, like a hit */
+        if (result.state != TOI_SEPARATED)
+        {
+            hits++;
+            /* a hit has to come before the first overlapping substep */
+            if (substep >= 0 && result.time > BENCH_TOI_DT * (float)substep / (float)BENCH_TOI_SUBSTEPS) early++;
+        }
+        else if (substep >= 0)
+        {
+            misses++;
+        }
+    }
+
+    printf("  %16s %10zu %10zu %10zu %8zu %8zu %10.1f %8.2f %6zu\n", name, expected, discrete, hits, misses, early,
+        time * 1e9 / BENCH_TOI_QUERIES, (double)iterations / BENCH_TOI_QUERIES, failed);
+}
+
+void bench_toi()
+{
+    bench_toi_case* cases = malloc(sizeof(bench_toi_case) * BENCH_TOI_QUERIES);
+    gjk_vec2 wall[4] = { { -0.05f, -2.0f }, { 0.05f, -2.0f }, { 0.05f, 2.0f }, { -0.05f, 2.0f } };
+
+    printf("time of impact: %d queries per scene, dt %.4f\n", BENCH_TOI_QUERIES, BENCH_TOI_DT);
+    printf("  %16s %10s %10s %10s %8s %8s %10s %8s %6s\n", "scene", "contacts", "discrete", "toi hits", "misses", "late", "ns/query", "iters", "failed");
+
+    /* fast bullets against thin walls, the walls are thinner than the distance a bullet moves per step */
+    bench_seed(14);
+    for (size_t i = 0; i < BENCH_TOI_QUERIES; ++i)
+    {
+        bench_toi_case* c = &cases[i];
+        gjk_circle(&c->s1, (gjk_vec2){ bench_randf(-6.0f, -1.0f), bench_randf(-3.0f, 3.0f) }, 0.05f);
+        c->m1 = (toi_motion){ { bench_randf(200.0f, 400.0f), bench_randf(-30.0f, 30.0f) }, 0.0f };
+        gjk_poly(&c->s2, wall, 4);
+        gjk_set_center(&c->s2, (gjk_vec2){ 0.0f, 0.0f });
+        c->m2 = (toi_motion){ { 0.0f, 0.0f }, 0.0f };
+    }
+    bench_toi_run("bullets", cases);
+
+    /* spinning bars against small boxes */
+    for (size_t i = 0; i < BENCH_TOI_QUERIES; ++i)
+    {
+        bench_toi_case* c = &cases[i];
+        gjk_capsule(&c->s1, (gjk_vec2){ -2.0f, 0.0f }, (gjk_vec2){ 2.0f, 0.0f }, 0.02f);
+        gjk_set_rotation(&c->s1, bench_randf(0.0f, 6.2831853f));
+        c->m1 = (toi_motion){ { 0.0f, 0.0f }, bench_randf(-60.0f, 60.0f) };
+        gjk_box(&c->s2, (gjk_vec2){ bench_randf(-2.0f, 2.0f), bench_randf(-2.0f, 2.0f) }, (gjk_vec2){ 0.1f, 0.1f });
+        c->m2 = (toi_motion){ { bench_randf(-10.0f, 10.0f), bench_randf(-10.0f, 10.0f) }, bench_randf(-5.0f, 5.0f) };
+    }
+    bench_toi_run("spinning bars", cases);
+
+    printf("  contacts from %d substeps, late counts hits after the first overlapping substep,\n", BENCH_TOI_SUBSTEPS);
+    printf("  toi hits include queries that failed and stop at a safe time\n");
+    free(cases);
+}
@@ -0,0 +1,209 @@
+#include "bench.h"
+
+#include "math/vec3_batch.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define BENCH_BATCH_COUNT   262144
+#define BENCH_BATCH_REPEAT  16
+
+typedef enum
+{
+    BENCH_BATCH_TRANSFORM,
+    BENCH_BATCH_NORMALIZE,
+    BENCH_BATCH_LERP,
+    BENCH_BATCH_DOT,
+    BENCH_BATCH_CROSS,
+    BENCH_BATCH_OP_COUNT
+} bench_batch_op;
+
+static const char* bench_batch_names[BENCH_BATCH_OP_COUNT] = { "transform", "normalize", "lerp", "dot", "cross" };
+
+typedef struct
+{
+    mat4 m;
+    vec3* a;
+    vec3* b;
+    vec3* out;
+    float* dots;
+    vec3_soa sa, sb, sout;
+} bench_batch_data;
+
+/* one call per vector through the out of line vec3 functions, the way the code is written today */
+static void bench_batch_calls(bench_batch_data* d, bench_batch_op op)
+{
+    vec3 c0 = { d->m.v[0][0], d->m.v[0][1], d->m.v[0][2] };
+    vec3 c1 = { d->m.v[1][0], d->m.v[1][1], d->m.v[1][2] };
+    vec3 c2 = { d->m.v[2][0], d->m.v[2][1], d->m.v[2][2] };
+    vec3 c3 = { d->m.v[3][0], d->m.v[3][1], d->m.v[3][2] };
+
+    for (size_t i = 0; i < BENCH_BATCH_COUNT; ++i)
+    {
+        vec3 a = d->a[i];
+        switch (op)
+        {
+        case BENCH_BATCH_TRANSFORM:
+            d->out[i] = vec3_add(vec3_add(vec3_mult(c0, a.x), vec3_mult(c1, a.y)), vec3_add(vec3_mult(c2, a.z), c3));
+            break;
+        case BENCH_BATCH_NORMALIZE: d->out[i] = vec3_normalize(a); break;
+        case BENCH_BATCH_LERP:      d->out[i] = vec3_lerp(a, d->b[i], 0.25f); break;
+        case BENCH_BATCH_DOT:       d->dots[i] = vec3_dot(a, d->b[i]); break;
+        default:                    d->out[i] = vec3_cross(a, d->b[i]); break;
+        }
+    }
+}
+
+static void bench_batch_aos(bench_batch_data* d, bench_batch_op op)
+{
+    switch (op)
+    {
+    case BENCH_BATCH_TRANSFORM: vec3_batch_transform_points(d->m, d->a, d->out, BENCH_BATCH_COUNT); break;
+    case BENCH_BATCH_NORMALIZE: vec3_batch_normalize(d->a, d->out, BENCH_BATCH_COUNT); break;
+    case BENCH_BATCH_LERP:      vec3_batch_lerp(d->a, d->b, 0.25f, d->out, BENCH_BATCH_COUNT); break;
+    case BENCH_BATCH_DOT:       vec3_batch_dot(d->a, d->b, d->dots, BENCH_BATCH_COUNT); break;
+    default:                    vec3_batch_cross(d->a, d->b, d->out, BENCH_BATCH_COUNT); break;
+    }
+}
+
+static void bench_batch_soa(bench_batch_data* d, bench_batch_op op)
+{
+    switch (op)
+    {
+    case BENCH_BATCH_TRANSFORM: vec3_soa_transform_points(d->m, d->sa, d->sout, BENCH_BATCH_COUNT); break;
+    case BENCH_BATCH_NORMALIZE: vec3_soa_normalize(d->sa, d->sout, BENCH_BATCH_COUNT); break;
+    case BENCH_BATCH_LERP:      vec3_soa_lerp(d->sa, d->sb, 0.25f, d->sout, BENCH_BATCH_COUNT); break;
+    case BENCH_BATCH_DOT:       vec3_soa_dot(d->sa, d->sb, d->dots, BENCH_BATCH_COUNT); break;
+    default:                    vec3_soa_cross(d->sa, d->sb, d->sout, BENCH_BATCH_COUNT); break;
+    }
+}
+
+/* largest difference of the last result to the reference, soa results are compared after conversion */
+static float bench_batch_error(bench_batch_data* d, bench_batch_op op, uint8_t soa, const vec3* ref, const float* ref_dots)
+{
+    float error = 0.0f;
+    for (size_t i = 0; i < BENCH_BATCH_COUNT; ++i)
+    {
+        if (op == BENCH_BATCH_DOT)
+        {
+            error = fmaxf(error, fabsf(d->dots[i] - ref_dots[i]));
+            continue;
+        }
+
+        vec3 v = soa ? (vec3) { d->sout.x[i], d->sout.y[i], d->sout.z[i] } : d->out[i];
+        error = fmaxf(error, fmaxf(fabsf(v.x - ref[i].x), fmaxf(fabsf(v.y - ref[i].y), fabsf(v.z - ref[i].z))));
+    }
+    return error;
+}
+
+static double bench_batch_time(bench_batch_data* d, bench_batch_op op, int layout)
+{
+    double start = bench_time();
+    for (int r = 0; r < BENCH_BATCH_REPEAT; ++r)
+    {
+        if (layout == 0)      bench_batch_calls(d, op);
+        else if (layout == 1) bench_batch_aos(d, op);
+        else                  bench_batch_soa(d, op);
+    }
+    return (bench_time() - start) * 1e9 / ((double)BENCH_BATCH_COUNT * BENCH_BATCH_REPEAT);
+}
+
+void bench_vec3_batch()
+{
+    bench_batch_data d;
+    d.a = malloc(sizeof(vec3) * BENCH_BATCH_COUNT);
+    d.b = malloc(sizeof(vec3) * BENCH_BATCH_COUNT);
+    d.out = malloc(sizeof(vec3) * BENCH_BATCH_COUNT);
+    d.dots = malloc(sizeof(float) * BENCH_BATCH_COUNT);
+
+    float* soa = malloc(sizeof(float) * 9 * BENCH_BATCH_COUNT);
+    d.sa = (vec3_soa) { soa, soa + BENCH_BATCH_COUNT, soa + 2 * BENCH_BATCH_COUNT };
+    d.sb = (vec3_soa) { soa + 3 * BENCH_BATCH_COUNT, soa + 4 * BENCH_BATCH_COUNT, soa + 5 * BENCH_BATCH_COUNT };
+    d.sout = (vec3_soa) { soa + 6 * BENCH_BATCH_COUNT, soa + 7 * BENCH_BATCH_COUNT, soa + 8 * BENCH_BATCH_COUNT };
+
+    vec3* ref = malloc(sizeof(vec3) * BENCH_BATCH_COUNT);
+    float* ref_dots = malloc(sizeof(float) * BENCH_BATCH_COUNT);
+
+    bench_seed(22);
+    for (size_t i = 0; i < BENCH_BATCH_COUNT; ++i)
+    {
+        d.a[i] = (vec3) { bench_randf(-10.0f, 10.0f), bench_randf(-10.0f, 10.0f), bench_randf(-10.0f, 10.0f) };
+        d.b[i] = (vec3) { bench_randf(-10.0f, 10.0f), bench_randf(-10.0f, 10.0f), bench_randf(-10.0f, 10.0f) };
+    }
+    vec3_soa_from_aos(d.sa, d.a, BENCH_BATCH_COUNT);
+    vec3_soa_from_aos(d.sb, d.b, BENCH_BATCH_COUNT);
+    d.m = mat4_multiply(mat4_translation((vec3) { 1.0f, -2.0f, 3.0f }), mat4_rotation(vec3_normalize((vec3) { 1.0f, 2.0f, 3.0f }), 0.7f));
+
+    vec3_batch_kernel best = vec3_batch_detect();
+
+    printf("vec3 batch: %d vectors, %d repeats, ns per vector, best kernel %s\n", BENCH_BATCH_COUNT, BENCH_BATCH_REPEAT,
+        vec3_batch_name(best));
+    printf("  %10s %8s %10s %10s %10s %10s %12s\n", "operation", "calls", "aos scalar", "aos avx2", "soa scalar", "soa avx2",
+        "max error");
+
+    for (int op = 0; op < BENCH_BATCH_OP_COUNT; ++op)
+    {
+        double calls = bench_batch_time(&d, op, 0);
+        for (size_t i = 0; i < BENCH_BATCH_COUNT; ++i)
+            ref[i] = d.out[i];
+        for (size_t i = 0; i < BENCH_BATCH_COUNT; ++i)
+            ref_dots[i] = d.dots[i];
+
+        double times[2][2] = { 0 };
+        float error = 0.0f;
+        for (int k = VEC3_BATCH_SCALAR; k <= (int)best; ++k)
+        {
+            vec3_batch_select(k);
+            for (int layout = 1; layout <= 2; ++layout)
+            {
+                times[k][layout - 1] = bench_batch_time(&d, op, layout);
+                error = fmaxf(error, bench_batch_error(&d, op, layout == 2, ref, ref_dots));
+            }
+        }
+
+        if (best == VEC3_BATCH_AVX2)
+            printf("  %10s %8.2f %10.2f %10.2f %10.2f %10.2f %12g\n", bench_batch_names[op], calls, times[0][0], times[1][0],
+                times[0][1], times[1][1], error);
+        else
+            printf("  %10s %8.2f %10.2f %10s %10.2f %10s %12g\n", bench_batch_names[op], calls, times[0][0], "-",
+                times[0][1], "-", error);
+    }
+
+    /* vec4 has no soa variant, a whole vector fits one sse register */
+    vec4* v4 = malloc(sizeof(vec4) * 3 * BENCH_BATCH_COUNT);
+    vec4* v4_out = v4 + BENCH_BATCH_COUNT;
+    vec4* v4_ref = v4 + 2 * BENCH_BATCH_COUNT;
+    for (size_t i = 0; i < BENCH_BATCH_COUNT; ++i)
+        v4[i] = (vec4) { d.a[i].x, d.a[i].y, d.a[i].z, 1.0f };
+
+    double v4_times[2] = { 0 };
+    float v4_error = 0.0f;
+    for (int k = VEC3_BATCH_SCALAR; k <= (int)best; ++k)
+    {
+        vec3_batch_select(k);
+        double start = bench_time();
+        for (int r = 0; r < BENCH_BATCH_REPEAT; ++r)
+            vec4_batch_transform(d.m, v4, k == VEC3_BATCH_SCALAR ? v4_ref : v4_out, BENCH_BATCH_COUNT);
+        v4_times[k] = (bench_time() - start) * 1e9 / ((double)BENCH_BATCH_COUNT * BENCH_BATCH_REPEAT);
+    }
+    if (best == VEC3_BATCH_AVX2)
+    {
+        for (size_t i = 0; i < BENCH_BATCH_COUNT; ++i)
+        {
+            v4_error = fmaxf(v4_error, fmaxf(fabsf(v4_out[i].x - v4_ref[i].x), fabsf(v4_out[i].y - v4_ref[i].y)));
+            v4_error = fmaxf(v4_error, fmaxf(fabsf(v4_out[i].z - v4_ref[i].z), fabsf(v4_out[i].w - v4_ref[i].w)));
+        }
+    }
+    printf("  %10s %8s %10.2f %10.2f %10s %10s %12g\n", "vec4", "-", v4_times[0], v4_times[1], "-", "-", v4_error);
+    vec3_batch_select(best);
+
+    free(v4);
+    free(d.a);
+    free(d.b);
+    free(d.out);
+    free(d.dots);
+    free(soa);
+    free(ref);
+    free(ref_dots);
+}
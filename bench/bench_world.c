@@ -0,0 +1,120 @@
+#include "bench.h"
+
+#include "world.h"
+
+#include <stdio.h>
+
+#define BENCH_WORLD_PILES   200
+#define BENCH_WORLD_ROWS    8     /* boxes in the bottom row of a pile */
+#define BENCH_WORLD_SPACING 12.0f
+#define BENCH_WORLD_DT      (1.0f / 60.0f)
+#define BENCH_WORLD_TICKS   120
+#define BENCH_WORLD_WAKE    10    /* piles hit by a ball after settling */
+#define BENCH_WORLD_STACK   6     /* boxes in the single stack of the sleep check */
+
+static void bench_world_build(world* w, uint8_t allow_sleep)
+{
+    world_init(w, (gjk_vec2) { 0.0f, -10.0f });
+    w->allow_sleep = allow_sleep;
+
+    float width = BENCH_WORLD_PILES * BENCH_WORLD_SPACING;
+    gjk_shape ground;
+    gjk_box(&ground, (gjk_vec2) { 0.5f * width, -1.0f }, (gjk_vec2) { 0.5f * width + 10.0f, 1.0f });
+    world_add_body(w, &ground, WORLD_STATIC, 0.0f, 0.6f);
+
+    for (int p = 0; p < BENCH_WORLD_PILES; ++p)
+    {
+        for (int row = 0; row < BENCH_WORLD_ROWS; ++row)
+        {
+            for (int i = 0; i < BENCH_WORLD_ROWS - row; ++i)
+            {
+                gjk_vec2 center = { p * BENCH_WORLD_SPACING + (i + 0.5f * row) * 1.05f, 0.5f + row };
+                gjk_shape box;
+                gjk_box(&box, center, (gjk_vec2) { 0.5f, 0.5f });
+                world_add_body(w, &box, WORLD_DYNAMIC, 1.0f, 0.6f);
+            }
+        }
+    }
+}
+
+/* average ms per tick and the awake bodies after the last tick */
+static double bench_world_run(world* w, int ticks)
+{
+    double start = bench_time();
+    for (int t = 0; t < ticks; ++t)
+        world_step(w, BENCH_WORLD_DT);
+    return (bench_time() - start) * 1000.0 / ticks;
+}
+
+/*
+ * a single stack is one island, so its bodies have to fall asleep together.
+ * Returns the ticks where some of them slept while others were awake.
+ */
+static int bench_world_stack_check(int ticks)
+{
+    world w;
+    world_init(&w, (gjk_vec2) { 0.0f, -10.0f });
+    w.allow_sleep = 1;
+
+    gjk_shape shape;
+    gjk_box(&shape, (gjk_vec2) { 0.0f, -1.0f }, (gjk_vec2) { 10.0f, 1.0f });
+    world_add_body(&w, &shape, WORLD_STATIC, 0.0f, 0.6f);
+
+    for (int i = 0; i < BENCH_WORLD_STACK; ++i)
+    {
+        gjk_box(&shape, (gjk_vec2) { 0.0f, 0.5f + i }, (gjk_vec2) { 0.5f, 0.5f });
+        world_add_body(&w, &shape, WORLD_DYNAMIC, 1.0f, 0.6f);
+    }
+
+    int partial = 0;
+    for (int t = 0; t < ticks; ++t)
+    {
+        world_step(&w, BENCH_WORLD_DT);
+
+        uint32_t asleep = 0;
+        for (uint32_t i = 0; i < w.body_count; ++i)
+            if (w.bodies[i].type == WORLD_DYNAMIC && !w.bodies[i].awake) asleep++;
+
+        if (asleep > 0 && asleep < BENCH_WORLD_STACK) partial++;
+    }
+
+    world_destroy(&w);
+    return partial;
+}
+
+void bench_world()
+{
+    world w;
+    bench_world_build(&w, 0);
+    printf("world: %d piles, %u bodies\n", BENCH_WORLD_PILES, w.body_count);
+
+    double never = bench_world_run(&w, BENCH_WORLD_TICKS);
+    double never_rest = bench_world_run(&w, BENCH_WORLD_TICKS);
+    printf("  without sleeping: %8.3f ms/tick settling, %8.3f ms/tick at rest (%d contacts)\n", never, never_rest, w.contact_count);
+    world_destroy(&w);
+
+    bench_world_build(&w, 1);
+    double settle = bench_world_run(&w, BENCH_WORLD_TICKS);
+    uint32_t settled = w.awake_count;
+    double rest = bench_world_run(&w, BENCH_WORLD_TICKS);
+    printf("  with sleeping:    %8.3f ms/tick settling, %8.4f ms/tick at rest (%u awake after %d ticks)\n", settle, rest, settled, BENCH_WORLD_TICKS);
+
+    /* throw balls at a few piles, only their islands wake up */
+    float top = 0.5f + BENCH_WORLD_ROWS;
+    for (int i = 0; i < BENCH_WORLD_WAKE; ++i)
+    {
+        int p = (int)(bench_rand() % BENCH_WORLD_PILES);
+        gjk_shape ball;
+        gjk_circle(&ball, (gjk_vec2) { p * BENCH_WORLD_SPACING - 2.0f, top }, 0.5f);
+        int32_t body = world_add_body(&w, &ball, WORLD_DYNAMIC, 4.0f, 0.5f);
+        w.bodies[body].velocity = (gjk_vec2) { 10.0f, 0.0f };
+    }
+
+    double hit = bench_world_run(&w, 30);
+    printf("  %d piles hit:     %8.3f ms/tick (%u awake)\n", BENCH_WORLD_WAKE, hit, w.awake_count);
+
+    world_destroy(&w);
+
+    int partial = bench_world_stack_check(2 * BENCH_WORLD_TICKS);
+    printf("  %d box stack:      partially asleep on %d of %d ticks\n", BENCH_WORLD_STACK, partial, 2 * BENCH_WORLD_TICKS);
+}
@@ -0,0 +1,30 @@
+#include "bench.h"
+
+int main()
+{
+    bench_gjk_batch();
+    bench_gjk_hill_climb();
+    bench_gjk_simd();
+    bench_gjk_shapes();
+    bench_gjk_intersect();
+    bench_gjk_distance();
+    bench_gjk_warm_start();
+    bench_gjk_bounds();
+    bench_epa();
+    bench_gjk3d();
+    bench_mat4();
+    bench_vec3_batch();
+    bench_math_inline();
+    bench_quat();
+    bench_scene_graph();
+    bench_aabb_tree();
+    bench_spatial_hash();
+    bench_sweep_prune();
+    bench_raycast();
+    bench_narrowphase();
+    bench_manifold();
+    bench_toi();
+    bench_world();
+
+    return 0;
+}
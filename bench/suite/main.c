@@ -0,0 +1,327 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/*
+ * Headless gjk and epa suite for tracking regressions. Every case generates
+ * seeded pairs of circles and convex polygons with a fixed vertex count and
+ * places them by an overlap ratio: the centers are (1 - overlap) times the
+ * sum of the circumradii apart, so 0 makes the circumcircles touch and
+ * negative ratios separate the shapes.
+ *
+ * Queries where epa stops at its iteration cap only return an estimate, they
+ * are counted in the capped column and left out of the epa timings.
+ *
+ * usage: GjkBenchmark [--csv file] [--seed n] [--queries n] [--repeat n]
+ */
+
+#define SUITE_MAX_VERTS 256
+#define SUITE_BUCKETS   17 /* iterations 0 to 15 and 16 or more */
+
+typedef enum
+{
+    SUITE_CIRCLE_CIRCLE,
+    SUITE_CIRCLE_POLY,
+    SUITE_POLY_POLY
+} suite_kind;
+
+static const char* suite_kind_names[] = { "circle-circle", "circle-poly", "poly-poly" };
+
+static const size_t suite_vertex_counts[] = { 3, 4, 8, 16, 32, 64, 128, 256 };
+static const float suite_overlaps[] = { -0.5f, -0.1f, 0.1f, 0.5f, 0.9f };
+
+#define SUITE_COUNT(a) (sizeof(a) / sizeof((a)[0]))
+
+typedef struct
+{
+    suite_kind kind;
+    size_t vertices;
+    float overlap;
+
+    size_t collisions;
+    double gjk_ns;
+    double epa_ns;
+    double iterations;
+    uint32_t max_iterations;
+    double expansions;
+    uint32_t max_expansions;
+    size_t capped;
+    size_t histogram[SUITE_BUCKETS];
+} suite_result;
+
+typedef struct
+{
+    gjk_shape* shapes;    /* two per pair */
+    gjk_vec2* vertices;   /* SUITE_MAX_VERTS per shape */
+    gjk_vec2* simplices;  /* three per pair, valid for colliding pairs */
+    uint8_t* collisions;
+    uint8_t* capped;      /* epa hit its iteration cap, excluded from the timing */
+    size_t count;
+} suite_pairs;
+
+/* convex polygon with the vertices on a circle at sorted random angles */
+static void suite_poly(gjk_shape* shape, gjk_vec2* vertices, size_t count, float radius)
+{
+    float angles[SUITE_MAX_VERTS];
+    for (size_t i = 0; i < count; ++i)
+        angles[i] = bench_randf(0.0f, 6.2831853f);
+
+    /* insertion sort, the counts are small */
+    for (size_t i = 1; i < count; ++i)
+    {
+        float a = angles[i];
+        size_t j = i;
+        for (; j > 0 && angles[j - 1] > a; --j)
+            angles[j] = angles[j - 1];
+        angles[j] = a;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+        vertices[i] = (gjk_vec2) { radius * cosf(angles[i]), radius * sinf(angles[i]) };
+
+    gjk_poly(shape, vertices, count);
+}
+
+static void suite_shape(gjk_shape* shape, gjk_vec2* vertices, uint8_t circle, size_t count, float radius, gjk_vec2 center)
+{
+    if (circle)
+    {
+        gjk_circle(shape, center, radius);
+        return;
+    }
+
+    suite_poly(shape, vertices, count, radius);
+    gjk_set_transform(shape, center, gjk_rotation(bench_randf(0.0f, 6.2831853f)));
+}
+
+static void suite_generate(suite_pairs* pairs, suite_kind kind, size_t count, float overlap)
+{
+    for (size_t i = 0; i < pairs->count; ++i)
+    {
+        gjk_shape* s = &pairs->shapes[2 * i];
+        gjk_vec2* v = &pairs->vertices[2 * i * SUITE_MAX_VERTS];
+
+        float r1 = bench_randf(0.5f, 1.5f);
+        float r2 = bench_randf(0.5f, 1.5f);
+        float angle = bench_randf(0.0f, 6.2831853f);
+        float distance = (1.0f - overlap) * (r1 + r2);
+
+        gjk_vec2 c1 = { bench_randf(-10.0f, 10.0f), bench_randf(-10.0f, 10.0f) };
+        gjk_vec2 c2 = { c1.x + distance * cosf(angle), c1.y + distance * sinf(angle) };
+
+        suite_shape(&s[0], v, kind != SUITE_POLY_POLY, count, r1, c1);
+        suite_shape(&s[1], v + SUITE_MAX_VERTS, kind == SUITE_CIRCLE_CIRCLE, count, r2, c2);
+    }
+}
+
+static void suite_run(suite_pairs* pairs, epa_arena* arena, int repeat, suite_result* result)
+{
+    memset(result->histogram, 0, sizeof(result->histogram));
+    result->collisions = 0;
+    result->capped = 0;
+    result->max_iterations = 0;
+    result->max_expansions = 0;
+
+    /* counting pass, also stores the simplices for epa */
+    uint64_t iterations = 0, expansions = 0;
+    for (size_t i = 0; i < pairs->count; ++i)
+    {
+        const gjk_shape* s = &pairs->shapes[2 * i];
+        gjk_vec2* simplex = &pairs->simplices[3 * i];
+
+        gjk_stats stats;
+        pairs->collisions[i] = gjk_collision_stats(&s[0], &s[1], simplex, &stats);
+
+        iterations += stats.iterations;
+        if (stats.iterations > result->max_iterations) result->max_iterations = stats.iterations;
+        result->histogram[stats.iterations < SUITE_BUCKETS - 1 ? stats.iterations : SUITE_BUCKETS - 1]++;
+
+        pairs->capped[i] = 0;
+        if (!pairs->collisions[i]) continue;
+
+        gjk_vec2 n;
+        epa_stats(&s[0], &s[1], simplex, &n, arena, &stats);
+        result->collisions++;
+
+        if (stats.capped)
+        {
+            pairs->capped[i] = 1;
+            result->capped++;
+            continue;
+        }
+
+        expansions += stats.expansions;
+        if (stats.expansions > result->max_expansions) result->max_expansions = stats.expansions;
+    }
+
+    size_t converged = result->collisions - result->capped;
+    result->iterations = (double)iterations / (double)pairs->count;
+    result->expansions = converged ? (double)expansions / (double)converged : 0.0;
+
+    /* timed passes, the sink keeps the calls alive */
+    volatile uint32_t sink = 0;
+    double start = bench_time();
+    for (int r = 0; r < repeat; ++r)
+        for (size_t i = 0; i < pairs->count; ++i)
+            sink += gjk_collision(&pairs->shapes[2 * i], &pairs->shapes[2 * i + 1], NULL);
+    result->gjk_ns = (bench_time() - start) * 1e9 / ((double)pairs->count * repeat);
+
+    volatile float depth = 0.0f;
+    start = bench_time();
+    for (int r = 0; r < repeat; ++r)
+    {
+        for (size_t i = 0; i < pairs->count; ++i)
+        {
+            if (!pairs->collisions[i] || pairs->capped[i]) continue;
+
+            gjk_vec2 n;
+            depth += epa(&pairs->shapes[2 * i], &pairs->shapes[2 * i + 1], &pairs->simplices[3 * i], &n, arena, NULL);
+        }
+    }
+    double time = bench_time() - start;
+    result->epa_ns = converged ? time * 1e9 / ((double)converged * repeat) : 0.0;
+
+    (void)sink;
+    (void)depth;
+}
+
+static void suite_print_header()
+{
+    printf("%14s %6s %8s %8s %9s %7s %6s %9s %7s %6s %7s  %s\n", "kind", "verts", "overlap", "hits", "gjk ns", "iters",
+        "max", "epa ns", "expand", "max", "capped", "iteration histogram in % (0 .. 15, 16+)");
+}
+
+static void suite_print(const suite_result* r, size_t queries)
+{
+    printf("%14s %6zu %8.2f %8zu %9.1f %7.2f %6u %9.1f %7.2f %6u ", suite_kind_names[r->kind], r->vertices, r->overlap,
+        r->collisions, r->gjk_ns, r->iterations, r->max_iterations, r->epa_ns, r->expansions, r->max_expansions);
+
+    if (r->capped == 0) printf("%7s ", ".");
+    else                printf("%7zu ", r->capped);
+
+    for (size_t b = 0; b < SUITE_BUCKETS; ++b)
+    {
+        double percent = 100.0 * (double)r->histogram[b] / (double)queries;
+        if (r->histogram[b] == 0) printf("   .");
+        else                      printf(" %3.0f", percent);
+    }
+    printf("\n");
+}
+
+static void suite_csv_header(FILE* csv)
+{
+    fprintf(csv, "kind,vertices,overlap,queries,collisions,gjk_ns,gjk_iterations,gjk_max_iterations,epa_ns,epa_expansions,epa_max_expansions,epa_capped");
+    for (size_t b = 0; b < SUITE_BUCKETS - 1; ++b)
+        fprintf(csv, ",iterations_%zu", b);
+    fprintf(csv, ",iterations_%d_plus\n", SUITE_BUCKETS - 1);
+}
+
+static void suite_csv(FILE* csv, const suite_result* r, size_t queries)
+{
+    fprintf(csv, "%s,%zu,%.2f,%zu,%zu,%.2f,%.4f,%u,%.2f,%.4f,%u,%zu", suite_kind_names[r->kind], r->vertices, r->overlap,
+        queries, r->collisions, r->gjk_ns, r->iterations, r->max_iterations, r->epa_ns, r->expansions, r->max_expansions,
+        r->capped);
+    for (size_t b = 0; b < SUITE_BUCKETS; ++b)
+        fprintf(csv, ",%zu", r->histogram[b]);
+    fprintf(csv, "\n");
+}
+
+int main(int argc, char** argv)
+{
+    const char* csv_path = NULL;
+    uint32_t seed = 1;
+    size_t queries = 4096;
+    int repeat = 8;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (i + 1 < argc && strcmp(argv[i], "--csv") == 0)          csv_path = argv[++i];
+        else if (i + 1 < argc && strcmp(argv[i], "--seed") == 0)    seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+        else if (i + 1 < argc && strcmp(argv[i], "--queries") == 0) queries = (size_t)strtoul(argv[++i], NULL, 10);
+        else if (i + 1 < argc && strcmp(argv[i], "--repeat") == 0)  repeat = atoi(argv[++i]);
+        else
+        {
+            fprintf(stderr, "usage: %s [--csv file] [--seed n] [--queries n] [--repeat n]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (queries == 0 || repeat <= 0)
+    {
+        fprintf(stderr, "queries and repeat have to be positive\n");
+        return 1;
+    }
+
+    FILE* csv = NULL;
+    if (csv_path)
+    {
+        csv = fopen(csv_path, "w");
+        if (!csv)
+        {
+            fprintf(stderr, "could not open %s\n", csv_path);
+            return 1;
+        }
+        suite_csv_header(csv);
+    }
+
+    suite_pairs pairs;
+    pairs.count = queries;
+    pairs.shapes = malloc(sizeof(gjk_shape) * 2 * queries);
+    pairs.vertices = malloc(sizeof(gjk_vec2) * 2 * SUITE_MAX_VERTS * queries);
+    pairs.simplices = malloc(sizeof(gjk_vec2) * 3 * queries);
+    pairs.collisions = malloc(queries);
+    pairs.capped = malloc(queries);
+
+    if (!pairs.shapes || !pairs.vertices || !pairs.simplices || !pairs.collisions || !pairs.capped)
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    epa_arena arena = { 0 };
+
+    printf("gjk suite: seed %u, %zu queries per case, %d timed repeats\n", seed, queries, repeat);
+    suite_print_header();
+
+    for (int kind = SUITE_CIRCLE_CIRCLE; kind <= SUITE_POLY_POLY; ++kind)
+    {
+        /* circles have no vertices, one row per overlap is enough */
+        size_t vertex_cases = kind == SUITE_CIRCLE_CIRCLE ? 1 : SUITE_COUNT(suite_vertex_counts);
+        for (size_t v = 0; v < vertex_cases; ++v)
+        {
+            for (size_t o = 0; o < SUITE_COUNT(suite_overlaps); ++o)
+            {
+                suite_result result;
+                result.kind = (suite_kind)kind;
+                result.vertices = kind == SUITE_CIRCLE_CIRCLE ? 0 : suite_vertex_counts[v];
+                result.overlap = suite_overlaps[o];
+
+                /* every case gets its own stream, adding cases does not change the others */
+                bench_seed(seed * 7919u + (uint32_t)(kind * 1000 + v * 10 + o) + 1u);
+                suite_generate(&pairs, result.kind, result.vertices, result.overlap);
+                suite_run(&pairs, &arena, repeat, &result);
+
+                suite_print(&result, queries);
+                if (csv) suite_csv(csv, &result, queries);
+            }
+        }
+    }
+
+    if (csv)
+    {
+        fclose(csv);
+        printf("results written to %s\n", csv_path);
+    }
+
+    epa_arena_free(&arena);
+    free(pairs.shapes);
+    free(pairs.vertices);
+    free(pairs.simplices);
+    free(pairs.collisions);
+    free(pairs.capped);
+
+    return 0;
+}
@@ -76,3 +76,106 @@ project "IgnisApp"
     filter "system:windows"
         systemversion "latest"
         defines { "WINDOWS", "_CRT_SECURE_NO_WARNINGS" }
+
+project "Benchmark"
+    kind "ConsoleApp"
+    language "C"
+    cdialect "C99"
+    staticruntime "On"
+
+    targetdir ("build/bin/" .. output_dir .. "/%{prj.name}")
+    objdir ("build/bin-int/" .. output_dir .. "/%{prj.name}")
+
+    files
+    {
+        "bench/**.h",
+        "bench/**.c",
+        "src/gjk.h",
+        "src/gjk.c",
+        "src/gjk_simd.h",
+        "src/gjk_simd.c",
+        "src/cpu_features.h",
+        "src/cpu_features.c",
+        "src/aabb_tree.h",
+        "src/aabb_tree.c",
+        "src/spatial_hash.h",
+        "src/spatial_hash.c",
+        "src/sweep_prune.h",
+        "src/sweep_prune.c",
+        "src/job_system.h",
+        "src/job_system.c",
+        "src/narrowphase.h",
+        "src/narrowphase.c",
+        "src/manifold.h",
+        "src/manifold.c",
+        "src/toi.h",
+        "src/toi.c",
+        "src/raycast.h",
+        "src/raycast.c",
+        "src/world.h",
+        "src/world.c",
+        "src/gjk3d.h",
+        "src/gjk3d.c",
+        "src/scene_graph.h",
+        "src/scene_graph.c",
+        "src/math/inline.h",
+        "src/math/vec3.h",
+        "src/math/mat4.h",
+        "src/math/mat4.c",
+        "src/math/quat.h",
+        "src/math/quat.c",
+        "src/math/vec3_batch.h",
+        "src/math/vec3_batch.c",
+        "src/linmath.h"
+    }
+
+    -- the gjk suite is its own target
+    removefiles { "bench/suite/**" }
+
+    includedirs
+    {
+        "src",
+        "bench"
+    }
+
+    filter "system:linux"
+        links { "m", "pthread" }
+
+    filter "system:windows"
+        systemversion "latest"
+        defines { "WINDOWS", "_CRT_SECURE_NO_WARNINGS" }
+
+project "GjkBenchmark"
+    kind "ConsoleApp"
+    language "C"
+    cdialect "C99"
+    staticruntime "On"
+
+    targetdir ("build/bin/" .. output_dir .. "/%{prj.name}")
+    objdir ("build/bin-int/" .. output_dir .. "/%{prj.name}")
+
+    files
+    {
+        "bench/suite/**.c",
+        "bench/bench.h",
+        "bench/bench.c",
+        "src/gjk.h",
+        "src/gjk.c",
+        "src/gjk_simd.h",
+        "src/gjk_simd.c",
+        "src/cpu_features.h",
+        "src/cpu_features.c"
+    }
+
+    includedirs
+    {
+        "src",
+        "bench"
+    }
+
+    filter "system:linux"
+        links { "m" }
+
+    filter "system:windows"
+        systemversion "latest"
+        defines { "WINDOWS", "_CRT_SECURE_NO_WARNINGS" }
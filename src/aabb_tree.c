@@ -0,0 +1,594 @@
+#include "aabb_tree.h"
+
+#include <stdlib.h>
+
+/* how far the fattened aabb is extended in the direction of movement */
+#define AABB_TREE_DISPLACEMENT_MULTIPLIER 4.0f
+
+#define AABB_TREE_INITIAL_CAPACITY 16
+
+static int32_t aabb_tree_max(int32_t a, int32_t b) { return a > b ? a : b; }
+
+static uint8_t gjk_aabb_equal(gjk_aabb a, gjk_aabb b)
+{
+    return a.min.x == b.min.x && a.min.y == b.min.y && a.max.x == b.max.x && a.max.y == b.max.y;
+}
+
+static int32_t aabb_tree_alloc_node(aabb_tree* tree)
+{
+    if (tree->free_list == AABB_TREE_NULL)
+    {
+        int32_t capacity = tree->capacity ? tree->capacity * 2 : AABB_TREE_INITIAL_CAPACITY;
+        aabb_tree_node* nodes = realloc(tree->nodes, sizeof(aabb_tree_node) * capacity);
+        if (!nodes) return AABB_TREE_NULL;
+
+        /* link the new nodes into the free list */
+        for (int32_t i = tree->capacity; i < capacity; ++i)
+        {
+            nodes[i].parent = i + 1 < capacity ? i + 1 : AABB_TREE_NULL;
+            nodes[i].height = -1;
+            nodes[i].moved = 0;
+        }
+
+        tree->free_list = tree->capacity;
+        tree->nodes = nodes;
+        tree->capacity = capacity;
+    }
+
+    int32_t index = tree->free_list;
+    aabb_tree_node* node = &tree->nodes[index];
+    tree->free_list = node->parent;
+
+    node->parent = AABB_TREE_NULL;
+    node->left = AABB_TREE_NULL;
+    node->right = AABB_TREE_NULL;
+    node->height = 0;
+    node->shape = 0;
+    /* moved is kept, the node can still be in the move buffer */
+
+    tree->count++;
+    return index;
+}
+
+static void aabb_tree_free_node(aabb_tree* tree, int32_t index)
+{
+    tree->nodes[index].parent = tree->free_list;
+    tree->nodes[index].height = -1;
+    tree->free_list = index;
+    tree->count--;
+}
+
+static int32_t* aabb_tree_reserve_stack(aabb_tree* tree, size_t size)
+{
+    if (size <= tree->stack_capacity) return tree->stack;
+
+    size_t capacity = tree->stack_capacity ? tree->stack_capacity : 64;
+    while (capacity < size) capacity *= 2;
+
+    int32_t* stack = realloc(tree->stack, sizeof(int32_t) * capacity);
+    if (!stack) return NULL;
+
+    tree->stack = stack;
+    tree->stack_capacity = capacity;
+    return stack;
+}
+
+/*
+ * performs a left or right rotation if node a is imbalanced.
+ * returns the new root of the subtree.
+ */
+static int32_t aabb_tree_balance(aabb_tree* tree, int32_t ia)
+{
+    aabb_tree_node* nodes = tree->nodes;
+    aabb_tree_node* a = &nodes[ia];
+    if (a->height < 2) return ia;
+
+    int32_t ib = a->left;
+    int32_t ic = a->right;
+    aabb_tree_node* b = &nodes[ib];
+    aabb_tree_node* c = &nodes[ic];
+
+    int32_t balance = c->height - b->height;
+
+    /* rotate c up */
+    if (balance > 1)
+    {
+        int32_t f_index = c->left;
+        int32_t g_index = c->right;
+        aabb_tree_node* f = &nodes[f_index];
+        aabb_tree_node* g = &nodes[g_index];
+
+        /* swap a and c */
+        c->left = ia;
+        c->parent = a->parent;
+        a->parent = ic;
+
+        /* a's old parent should point to c */
+        if (c->parent != AABB_TREE_NULL)
+        {
+            if (nodes[c->parent].left == ia) nodes[c->parent].left = ic;
+            else                             nodes[c->parent].right = ic;
+        }
+        else
+        {
+            tree->root = ic;
+        }
+
+        if (f->height > g->height)
+        {
+            c->right = f_index;
+            a->right = g_index;
+            g->parent = ia;
+            a->aabb = gjk_aabb_union(b->aabb, g->aabb);
+            c->aabb = gjk_aabb_union(a->aabb, f->aabb);
+            a->height = 1 + aabb_tree_max(b->height, g->height);
+            c->height = 1 + aabb_tree_max(a->height, f->height);
+        }
+        else
+        {
+            c->right = g_index;
+            a->right = f_index;
+            f->parent = ia;
+            a->aabb = gjk_aabb_union(b->aabb, f->aabb);
+            c->aabb = gjk_aabb_union(a->aabb, g->aabb);
+            a->height = 1 + aabb_tree_max(b->height, f->height);
+            c->height = 1 + aabb_tree_max(a->height, g->height);
+        }
+
+        return ic;
+    }
+
+    /* rotate b up */
+    if (balance < -1)
+    {
+        int32_t d_index = b->left;
+        int32_t e_index = b->right;
+        aabb_tree_node* d = &nodes[d_index];
+        aabb_tree_node* e = &nodes[e_index];
+
+        /* swap a and b */
+        b->left = ia;
+        b->parent = a->parent;
+        a->parent = ib;
+
+        /* a's old parent should point to b */
+        if (b->parent != AABB_TREE_NULL)
+        {
+            if (nodes[b->parent].left == ia) nodes[b->parent].left = ib;
+            else                             nodes[b->parent].right = ib;
+        }
+        else
+        {
+            tree->root = ib;
+        }
+
+        if (d->height > e->height)
+        {
+            b->right = d_index;
+            a->left = e_index;
+            e->parent = ia;
+            a->aabb = gjk_aabb_union(c->aabb, e->aabb);
+            b->aabb = gjk_aabb_union(a->aabb, d->aabb);
+            a->height = 1 + aabb_tree_max(c->height, e->height);
+            b->height = 1 + aabb_tree_max(a->height, d->height);
+        }
+        else
+        {
+            b->right = e_index;
+            a->left = d_index;
+            d->parent = ia;
+            a->aabb = gjk_aabb_union(c->aabb, d->aabb);
+            b->aabb = gjk_aabb_union(a->aabb, e->aabb);
+            a->height = 1 + aabb_tree_max(c->height, d->height);
+            b->height = 1 + aabb_tree_max(a->height, e->height);
+        }
+
+        return ib;
+    }
+
+    return ia;
+}
+
+/*
+ * swaps a child of node a with a grandchild if that reduces the perimeter of
+ * the subtree. Keeps the tree tight when leaves are inserted in bad order.
+ * returns 1 if the children changed.
+ */
+static uint8_t aabb_tree_rotate(aabb_tree* tree, int32_t ia)
+{
+    aabb_tree_node* nodes = tree->nodes;
+    aabb_tree_node* a = &nodes[ia];
+    if (a->height < 2) return 0;
+
+    int32_t ib = a->left;
+    int32_t ic = a->right;
+    aabb_tree_node* b = &nodes[ib];
+    aabb_tree_node* c = &nodes[ic];
+
+    /* candidate rotations: swap child (b or c) with grandchild of the other */
+    float best = 0.0f;
+    int32_t child = AABB_TREE_NULL, grandchild = AABB_TREE_NULL;
+
+    if (c->height > 0)
+    {
+        float base = gjk_aabb_perimeter(c->aabb);
+        float cost_f = gjk_aabb_perimeter(gjk_aabb_union(b->aabb, nodes[c->right].aabb)) - base;
+        float cost_g = gjk_aabb_perimeter(gjk_aabb_union(b->aabb, nodes[c->left].aabb)) - base;
+        if (cost_f < best) { best = cost_f; child = ib; grandchild = c->left; }
+        if (cost_g < best) { best = cost_g; child = ib; grandchild = c->right; }
+    }
+
+    if (b->height > 0)
+    {
+        float base = gjk_aabb_perimeter(b->aabb);
+        float cost_d = gjk_aabb_perimeter(gjk_aabb_union(c->aabb, nodes[b->right].aabb)) - base;
+        float cost_e = gjk_aabb_perimeter(gjk_aabb_union(c->aabb, nodes[b->left].aabb)) - base;
+        if (cost_d < best) { best = cost_d; child = ic; grandchild = b->left; }
+        if (cost_e < best) { best = cost_e; child = ic; grandchild = b->right; }
+    }
+
+    if (child == AABB_TREE_NULL) return 0;
+
+    /* swap child and grandchild */
+    int32_t iparent = nodes[grandchild].parent;
+    aabb_tree_node* parent = &nodes[iparent];
+
+    if (a->left == child) a->left = grandchild;
+    else                  a->right = grandchild;
+    nodes[grandchild].parent = ia;
+
+    if (parent->left == grandchild) parent->left = child;
+    else                            parent->right = child;
+    nodes[child].parent = iparent;
+
+    parent->aabb = gjk_aabb_union(nodes[parent->left].aabb, nodes[parent->right].aabb);
+    parent->height = 1 + aabb_tree_max(nodes[parent->left].height, nodes[parent->right].height);
+    return 1;
+}
+
+/*
+ * refits aabbs and heights from start up to the root, balancing on the way.
+ * Stops at the first node above start that keeps its children, aabb and
+ * height, the nodes above it cannot change either.
+ */
+static void aabb_tree_refit(aabb_tree* tree, int32_t start)
+{
+    int32_t index = start;
+    while (index != AABB_TREE_NULL)
+    {
+        int32_t balanced = aabb_tree_balance(tree, index);
+        uint8_t rotated = aabb_tree_rotate(tree, balanced);
+
+        aabb_tree_node* node = &tree->nodes[balanced];
+        aabb_tree_node* left = &tree->nodes[node->left];
+        aabb_tree_node* right = &tree->nodes[node->right];
+
+        int32_t height = 1 + aabb_tree_max(left->height, right->height);
+        gjk_aabb aabb = gjk_aabb_union(left->aabb, right->aabb);
+
+        if (index != start && balanced == index && !rotated && height == node->height && gjk_aabb_equal(aabb, node->aabb)) return;
+
+        node->height = height;
+        node->aabb = aabb;
+
+        index = node->parent;
+    }
+}
+
+static void aabb_tree_insert_leaf(aabb_tree* tree, int32_t leaf)
+{
+    if (tree->root == AABB_TREE_NULL)
+    {
+        tree->root = leaf;
+        tree->nodes[leaf].parent = AABB_TREE_NULL;
+        return;
+    }
+
+    /* find the best sibling using the perimeter as cost */
+    gjk_aabb leaf_aabb = tree->nodes[leaf].aabb;
+    int32_t index = tree->root;
+    while (tree->nodes[index].height > 0)
+    {
+        const aabb_tree_node* node = &tree->nodes[index];
+
+        float perimeter = gjk_aabb_perimeter(node->aabb);
+        float combined = gjk_aabb_perimeter(gjk_aabb_union(node->aabb, leaf_aabb));
+
+        /* cost of creating a new parent for this node and the new leaf */
+        float cost = 2.0f * combined;
+
+        /* minimum cost of pushing the leaf further down the tree */
+        float inheritance = 2.0f * (combined - perimeter);
+
+        const aabb_tree_node* left = &tree->nodes[node->left];
+        const aabb_tree_node* right = &tree->nodes[node->right];
+
+        float cost_left = gjk_aabb_perimeter(gjk_aabb_union(leaf_aabb, left->aabb)) + inheritance;
+        if (left->height > 0) cost_left -= gjk_aabb_perimeter(left->aabb);
+
+        float cost_right = gjk_aabb_perimeter(gjk_aabb_union(leaf_aabb, right->aabb)) + inheritance;
+        if (right->height > 0) cost_right -= gjk_aabb_perimeter(right->aabb);
+
+        if (cost < cost_left && cost < cost_right) break;
+
+        index = cost_left < cost_right ? node->left : node->right;
+    }
+
+    /* create a new parent for the sibling and the leaf */
+    int32_t sibling = index;
+    int32_t parent = aabb_tree_alloc_node(tree);
+    if (parent == AABB_TREE_NULL) return;
+
+    aabb_tree_node* nodes = tree->nodes;
+    int32_t old_parent = nodes[sibling].parent;
+
+    nodes[parent].parent = old_parent;
+    nodes[parent].aabb = gjk_aabb_union(leaf_aabb, nodes[sibling].aabb);
+    nodes[parent].height = nodes[sibling].height + 1;
+    nodes[parent].left = sibling;
+    nodes[parent].right = leaf;
+    nodes[sibling].parent = parent;
+    nodes[leaf].parent = parent;
+
+    if (old_parent != AABB_TREE_NULL)
+    {
+        if (nodes[old_parent].left == sibling) nodes[old_parent].left = parent;
+        else                                   nodes[old_parent].right = parent;
+    }
+    else
+    {
+        tree->root = parent;
+    }
+
+    aabb_tree_refit(tree, nodes[leaf].parent);
+}
+
+static void aabb_tree_remove_leaf(aabb_tree* tree, int32_t leaf)
+{
+    if (leaf == tree->root)
+    {
+        tree->root = AABB_TREE_NULL;
+        return;
+    }
+
+    aabb_tree_node* nodes = tree->nodes;
+    int32_t parent = nodes[leaf].parent;
+    int32_t grand_parent = nodes[parent].parent;
+    int32_t sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+
+    aabb_tree_free_node(tree, parent);
+
+    if (grand_parent == AABB_TREE_NULL)
+    {
+        tree->root = sibling;
+        nodes[sibling].parent = AABB_TREE_NULL;
+        return;
+    }
+
+    /* connect the sibling to the grand parent */
+    if (nodes[grand_parent].left == parent) nodes[grand_parent].left = sibling;
+    else                                    nodes[grand_parent].right = sibling;
+    nodes[sibling].parent = grand_parent;
+
+    aabb_tree_refit(tree, grand_parent);
+}
+
+void aabb_tree_init(aabb_tree* tree, float margin)
+{
+    tree->nodes = NULL;
+    tree->capacity = 0;
+    tree->count = 0;
+    tree->root = AABB_TREE_NULL;
+    tree->free_list = AABB_TREE_NULL;
+
+    tree->margin = margin;
+
+    tree->pairs = NULL;
+    tree->pair_proxies = NULL;
+    tree->pair_count = 0;
+    tree->pair_capacity = 0;
+
+    tree->move_buffer = NULL;
+    tree->move_count = 0;
+    tree->move_capacity = 0;
+
+    tree->stack = NULL;
+    tree->stack_capacity = 0;
+}
+
+void aabb_tree_destroy(aabb_tree* tree)
+{
+    free(tree->nodes);
+    free(tree->pairs);
+    free(tree->pair_proxies);
+    free(tree->move_buffer);
+    free(tree->stack);
+    aabb_tree_init(tree, tree->margin);
+}
+
+static gjk_aabb aabb_tree_fatten(gjk_aabb aabb, float margin)
+{
+    aabb.min.x -= margin;
+    aabb.min.y -= margin;
+    aabb.max.x += margin;
+    aabb.max.y += margin;
+    return aabb;
+}
+
+static void aabb_tree_buffer_move(aabb_tree* tree, int32_t proxy)
+{
+    if (tree->nodes[proxy].moved) return;
+
+    if (tree->move_count >= tree->move_capacity)
+    {
+        size_t capacity = tree->move_capacity ? tree->move_capacity * 2 : 64;
+        int32_t* buffer = realloc(tree->move_buffer, sizeof(int32_t) * capacity);
+        if (!buffer) return;
+
+        tree->move_buffer = buffer;
+        tree->move_capacity = capacity;
+    }
+
+    tree->move_buffer[tree->move_count++] = proxy;
+    tree->nodes[proxy].moved = 1;
+}
+
+int32_t aabb_tree_insert(aabb_tree* tree, gjk_aabb aabb, uint32_t shape)
+{
+    int32_t proxy = aabb_tree_alloc_node(tree);
+    if (proxy == AABB_TREE_NULL) return AABB_TREE_NULL;
+
+    tree->nodes[proxy].aabb = aabb_tree_fatten(aabb, tree->margin);
+    tree->nodes[proxy].shape = shape;
+
+    aabb_tree_insert_leaf(tree, proxy);
+    aabb_tree_buffer_move(tree, proxy);
+    return proxy;
+}
+
+void aabb_tree_remove(aabb_tree* tree, int32_t proxy)
+{
+    aabb_tree_remove_leaf(tree, proxy);
+    aabb_tree_free_node(tree, proxy);
+}
+
+uint8_t aabb_tree_move(aabb_tree* tree, int32_t proxy, gjk_aabb aabb, gjk_vec2 displacement)
+{
+    if (gjk_aabb_contains(tree->nodes[proxy].aabb, aabb)) return 0;
+
+    aabb_tree_remove_leaf(tree, proxy);
+
+    /* predict the movement to avoid reinserting next frame */
+    gjk_aabb fat = aabb_tree_fatten(aabb, tree->margin);
+    float dx = AABB_TREE_DISPLACEMENT_MULTIPLIER * displacement.x;
+    float dy = AABB_TREE_DISPLACEMENT_MULTIPLIER * displacement.y;
+
+    if (dx < 0.0f) fat.min.x += dx;
+    else           fat.max.x += dx;
+
+    if (dy < 0.0f) fat.min.y += dy;
+    else           fat.max.y += dy;
+
+    tree->nodes[proxy].aabb = fat;
+    aabb_tree_insert_leaf(tree, proxy);
+    aabb_tree_buffer_move(tree, proxy);
+    return 1;
+}
+
+static uint8_t aabb_tree_push_pair(aabb_tree* tree, int32_t a, int32_t b)
+{
+    if (tree->pair_count >= tree->pair_capacity)
+    {
+        size_t capacity = tree->pair_capacity ? tree->pair_capacity * 2 : 64;
+        gjk_pair* pairs = realloc(tree->pairs, sizeof(gjk_pair) * capacity);
+        if (!pairs) return 0;
+        tree->pairs = pairs;
+
+        int32_t* proxies = realloc(tree->pair_proxies, sizeof(int32_t) * 2 * capacity);
+        if (!proxies) return 0;
+        tree->pair_proxies = proxies;
+
+        tree->pair_capacity = capacity;
+    }
+
+    tree->pairs[tree->pair_count].a = tree->nodes[a].shape;
+    tree->pairs[tree->pair_count].b = tree->nodes[b].shape;
+    tree->pair_proxies[2 * tree->pair_count] = a;
+    tree->pair_proxies[2 * tree->pair_count + 1] = b;
+    tree->pair_count++;
+    return 1;
+}
+
+size_t aabb_tree_update_pairs(aabb_tree* tree)
+{
+    aabb_tree_node* nodes = tree->nodes;
+
+    /*
+     * pairs of leaves that kept their fattened aabbs still overlap. Pairs
+     * with a moved or removed leaf are dropped, the queries below find them
+     * again if they still overlap.
+     */
+    size_t count = 0;
+    for (size_t i = 0; i < tree->pair_count; ++i)
+    {
+        int32_t a = tree->pair_proxies[2 * i];
+        int32_t b = tree->pair_proxies[2 * i + 1];
+        if (nodes[a].moved || nodes[b].moved || nodes[a].height != 0 || nodes[b].height != 0) continue;
+
+        tree->pairs[count] = tree->pairs[i];
+        tree->pair_proxies[2 * count] = a;
+        tree->pair_proxies[2 * count + 1] = b;
+        count++;
+    }
+    tree->pair_count = count;
+
+    int32_t* stack = NULL;
+    if (tree->root != AABB_TREE_NULL)
+        stack = aabb_tree_reserve_stack(tree, 2 * (size_t)nodes[tree->root].height + 2);
+
+    for (size_t i = 0; stack && i < tree->move_count; ++i)
+    {
+        int32_t proxy = tree->move_buffer[i];
+        if (nodes[proxy].height != 0) continue; /* removed after it moved */
+
+        gjk_aabb aabb = nodes[proxy].aabb;
+
+        size_t top = 0;
+        stack[top++] = tree->root;
+        while (top > 0)
+        {
+            int32_t index = stack[--top];
+            const aabb_tree_node* node = &nodes[index];
+
+            if (index == proxy || !gjk_aabb_overlap(node->aabb, aabb)) continue;
+
+            if (node->height > 0)
+            {
+                stack[top++] = node->left;
+                stack[top++] = node->right;
+            }
+            else if (!node->moved || index < proxy) /* pairs of two moved leaves are added once */
+            {
+                if (!aabb_tree_push_pair(tree, proxy, index)) break;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < tree->move_count; ++i)
+        nodes[tree->move_buffer[i]].moved = 0;
+    tree->move_count = 0;
+
+    return tree->pair_count;
+}
+
+void aabb_tree_query(aabb_tree* tree, gjk_aabb aabb, aabb_tree_query_func func, void* user)
+{
+    if (tree->root == AABB_TREE_NULL) return;
+
+    int32_t* stack = aabb_tree_reserve_stack(tree, 2 * (size_t)tree->nodes[tree->root].height + 2);
+    if (!stack) return;
+
+    size_t top = 0;
+    stack[top++] = tree->root;
+    while (top > 0)
+    {
+        const aabb_tree_node* node = &tree->nodes[stack[--top]];
+
+        if (!gjk_aabb_overlap(node->aabb, aabb)) continue;
+
+        if (node->height > 0)
+        {
+            stack[top++] = node->left;
+            stack[top++] = node->right;
+        }
+        else
+        {
+            func(user, node->shape);
+        }
+    }
+}
+
+int32_t aabb_tree_get_height(const aabb_tree* tree)
+{
+    return tree->root == AABB_TREE_NULL ? 0 : tree->nodes[tree->root].height;
+}
@@ -0,0 +1,81 @@
+#ifndef AABB_TREE_H
+#define AABB_TREE_H
+
+#include "gjk.h"
+
+/*
+ * Dynamic bounding volume tree used as broadphase for gjk_shapes.
+ * Leaves store fattened aabbs, so small movements do not touch the tree.
+ * The tree is kept balanced by rotations while inserting and removing,
+ * which also swap nodes whenever that reduces the perimeter of a subtree.
+ * Leaves that were inserted or reinserted are kept in a move buffer, only
+ * those are queried for new pairs by aabb_tree_update_pairs.
+ */
+
+#define AABB_TREE_NULL (-1)
+
+typedef struct
+{
+    gjk_aabb aabb;
+    int32_t parent;     /* next free node, if the node is unused */
+    int32_t left;
+    int32_t right;
+    int32_t height;     /* 0 for leaves, -1 for unused nodes */
+    uint32_t shape;     /* index of the shape, only for leaves */
+    uint8_t moved;      /* in the move buffer */
+} aabb_tree_node;
+
+typedef struct
+{
+    aabb_tree_node* nodes;
+    int32_t capacity;
+    int32_t count;
+    int32_t root;
+    int32_t free_list;
+
+    float margin; /* distance the leaf aabbs are fattened by */
+
+    /* candidate pairs found by the last call to aabb_tree_update_pairs */
+    gjk_pair* pairs;
+    int32_t* pair_proxies; /* two per pair */
+    size_t pair_count;
+    size_t pair_capacity;
+
+    /* proxies whose fattened aabb changed since the last update */
+    int32_t* move_buffer;
+    size_t move_count;
+    size_t move_capacity;
+
+    /* traversal stack, makes queries non reentrant */
+    int32_t* stack;
+    size_t stack_capacity;
+} aabb_tree;
+
+void aabb_tree_init(aabb_tree* tree, float margin);
+void aabb_tree_destroy(aabb_tree* tree);
+
+/* returns the proxy of the new leaf */
+int32_t aabb_tree_insert(aabb_tree* tree, gjk_aabb aabb, uint32_t shape);
+void aabb_tree_remove(aabb_tree* tree, int32_t proxy);
+
+/* 
+ * reinserts the leaf if aabb left its fattened aabb. The displacement is used
+ * to extend the new fattened aabb in the direction of the movement.
+ * returns 1 if the leaf was reinserted.
+ */
+uint8_t aabb_tree_move(aabb_tree* tree, int32_t proxy, gjk_aabb aabb, gjk_vec2 displacement);
+
+/* 
+ * collects all pairs of leaves with overlapping fattened aabbs in tree->pairs.
+ * Pairs of leaves that did not move are kept from the last call, only the
+ * leaves in the move buffer are queried against the tree. The pairs can be
+ * passed directly to gjk_collide_batch, but must not be reordered.
+ */
+size_t aabb_tree_update_pairs(aabb_tree* tree);
+
+typedef void (*aabb_tree_query_func)(void* user, uint32_t shape);
+void aabb_tree_query(aabb_tree* tree, gjk_aabb aabb, aabb_tree_query_func func, void* user);
+
+int32_t aabb_tree_get_height(const aabb_tree* tree);
+
+#endif // !AABB_TREE_H
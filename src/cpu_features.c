@@ -0,0 +1,61 @@
+#include "cpu_features.h"
+
+#if defined(CPU_X86) && defined(_MSC_VER)
+#include <intrin.h>
+
+/* the os has to enable and save the ymm registers */
+static uint8_t cpu_has_avx_state()
+{
+    int info[4];
+    __cpuid(info, 1);
+    if (!(info[2] & (1 << 27)) || !(info[2] & (1 << 28))) return 0;
+    return (_xgetbv(0) & 6) == 6;
+}
+#endif
+
+uint8_t cpu_has_sse2()
+{
+#if !defined(CPU_X86)
+    return 0;
+#elif defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+    return 1;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2") != 0;
+#endif
+}
+
+uint8_t cpu_has_avx2()
+{
+#if !defined(CPU_X86)
+    return 0;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7 || !cpu_has_avx_state()) return 0;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+uint8_t cpu_has_fma()
+{
+#if !defined(CPU_X86)
+    return 0;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 12)) && cpu_has_avx_state();
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("fma") != 0;
+#endif
+}
@@ -0,0 +1,21 @@
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+#include <stdint.h>
+
+/*
+ * Runtime detection of the instruction sets the simd kernels use. The
+ * kernels are compiled with target attributes, so a binary built for the
+ * baseline can still pick them when the cpu and the os support them.
+ */
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define CPU_X86
+#endif
+
+/* all of them return 0 on other architectures */
+uint8_t cpu_has_sse2();
+uint8_t cpu_has_avx2(); /* includes the os saving the ymm registers */
+uint8_t cpu_has_fma();
+
+#endif /* !CPU_FEATURES_H */
@@ -1,5 +1,15 @@
 #include "examples.h"
 
+#include "scene_graph.h"
+
+/*
+ * A small solar system on a scene graph: the planet and the moon hang off
+ * rotating pivots, a ring of cubes around the sun never moves. Every tick
+ * only sets the rotations of the animated nodes, the update skips the ring.
+ */
+
+#define CUBE_RING_COUNT 64
+
 IgnisFont font;
 
 float width, height;
@@ -29,11 +39,42 @@ size_t element_count = 36;
 IgnisShader shader;
 IgnisVertexArray vao;
 
+static scene_graph cube_graph;
+static int32_t cube_sun, cube_planet_pivot, cube_moon_pivot;
+static int32_t cube_updated;
+
+static vec3 camera_pos = { 0.0f, 6.0f, 14.0f };
+static mat4 view, proj;
+
+static void createScene()
+{
+    vec3 zero = { 0.0f, 0.0f, 0.0f };
+    vec3 one = { 1.0f, 1.0f, 1.0f };
+    quat none = quat_identity();
+
+    scene_graph_init(&cube_graph);
+
+    cube_sun = scene_graph_add(&cube_graph, SCENE_GRAPH_NULL, zero, none, (vec3) { 1.5f, 1.5f, 1.5f });
+    cube_planet_pivot = scene_graph_add(&cube_graph, SCENE_GRAPH_NULL, zero, none, one);
+    int32_t planet = scene_graph_add(&cube_graph, cube_planet_pivot, (vec3) { 4.0f, 0.0f, 0.0f }, none, (vec3) { 0.6f, 0.6f, 0.6f });
+    cube_moon_pivot = scene_graph_add(&cube_graph, planet, zero, none, one);
+    scene_graph_add(&cube_graph, cube_moon_pivot, (vec3) { 1.5f, 0.0f, 0.0f }, none, (vec3) { 0.4f, 0.4f, 0.4f });
+
+    int32_t ring = scene_graph_add(&cube_graph, SCENE_GRAPH_NULL, zero, quat_from_axis_angle((vec3) { 1.0f, 0.0f, 0.0f }, 0.3f), one);
+    for (int i = 0; i < CUBE_RING_COUNT; ++i)
+    {
+        float angle = 2.0f * MPI * (float)i / CUBE_RING_COUNT;
+        vec3 pos = { 7.0f * cosf(angle), 0.0f, 7.0f * sinf(angle) };
+        scene_graph_add(&cube_graph, ring, pos, quat_from_axis_angle((vec3) { 0.0f, 1.0f, 0.0f }, -angle), (vec3) { 0.2f, 0.2f, 0.2f });
+    }
+}
+
 static void setViewport(float w, float h)
 {
     width = w;
     height = h;
     screen_projection = mat4_ortho(0.0f, w, h, 0.0f, -1.0f, 1.0f);
+    proj = mat4_perspective(degToRad(45.0f), w / h, 0.1f, 100.0f);
 }
 
 int onLoad(MinimalApp* app, uint32_t w, uint32_t h)
@@ -70,6 +111,10 @@ int onLoad(MinimalApp* app, uint32_t w, uint32_t h)
     /* shader */
     shader = ignisCreateShadervf("res/shaders/shader.vert", "res/shaders/shader.frag");
 
+    /* scene */
+    view = mat4_look_at(camera_pos, (vec3) { 0.0f, 0.0f, 0.0f }, (vec3) { 0.0f, 1.0f, 0.0f });
+    createScene();
+
     printVersionInfo();
 
     return MINIMAL_OK;
@@ -80,6 +125,8 @@ void onDestroy(MinimalApp* app)
     ignisDeleteVertexArray(&vao);
     ignisDeleteShader(shader);
 
+    scene_graph_destroy(&cube_graph);
+
     ignisDeleteFont(&font);
 
     ignisFontRendererDestroy();
@@ -102,23 +149,27 @@ void onTick(MinimalApp* app, float deltatime)
     // clear screen
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    vec3 camera_pos = (vec3){ 0.0f, 0.0f, 3.0f };
-
-    // create transformations
-    mat4 model = mat4_rotation((vec3) { 0.5f, 1.0f, 0.0f }, (float)minimalGetTime());
-    mat4 view = mat4_translation(vec3_negate(camera_pos));
-    mat4 proj = mat4_perspective(degToRad(45.0f), width / height, 0.1f, 100.0f);
+    // animate the pivots, everything else keeps its world matrix
+    float time = (float)minimalGetTime();
+    vec3 up = { 0.0f, 1.0f, 0.0f };
+    scene_graph_set_rotation(&cube_graph, cube_sun, quat_from_axis_angle(up, 0.2f * time));
+    scene_graph_set_rotation(&cube_graph, cube_planet_pivot, quat_from_axis_angle(up, 0.5f * time));
+    scene_graph_set_rotation(&cube_graph, cube_moon_pivot, quat_from_axis_angle(up, 2.0f * time));
+    cube_updated = scene_graph_update(&cube_graph);
 
     ignisSetUniform3f(shader, "lightPos", 1, &camera_pos.x);
 
     ignisSetUniformMat4(shader, "proj", 1, proj.v[0]);
     ignisSetUniformMat4(shader, "view", 1, view.v[0]);
-    ignisSetUniformMat4(shader, "model", 1, model.v[0]);
 
     ignisUseShader(shader);
-
     ignisBindVertexArray(&vao);
-    glDrawElements(GL_TRIANGLES, (GLsizei)element_count, GL_UNSIGNED_INT, NULL);
+
+    for (int32_t i = 0; i < cube_graph.count; ++i)
+    {
+        ignisSetUniformMat4(shader, "model", 1, cube_graph.worlds[i].v[0]);
+        glDrawElements(GL_TRIANGLES, (GLsizei)element_count, GL_UNSIGNED_INT, NULL);
+    }
 
     // render debug info
     ignisFontRendererSetProjection(screen_projection.v[0]);
@@ -128,6 +179,8 @@ void onTick(MinimalApp* app, float deltatime)
 
     if (app->debug)
     {
+        ignisFontRendererRenderTextFormat(8.0f, 32.0f, "Updated: %d / %d", cube_updated, cube_graph.count);
+
         /* Settings */
         ignisFontRendererTextFieldBegin(width - 220.0f, 8.0f, 8.0f);
 
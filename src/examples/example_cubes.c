@@ -0,0 +1,295 @@
+#include "examples.h"
+
+#include "gjk3d.h"
+
+#include <stdlib.h>
+
+/*
+ * Stress test for gjk3d: a pile of rotated cubes falls onto a floor. Every
+ * pair whose bounding boxes overlap goes through gjk3d_intersect, the
+ * response just pushes the cubes apart and removes the approaching velocity.
+ */
+
+#define CUBE_COUNT      256
+#define CUBE_ITERATIONS 4
+#define CUBE_FRICTION   0.5f /* fraction of the sliding velocity lost per contact */
+
+static IgnisFont cubes_font;
+
+static float cubes_width, cubes_height;
+static mat4 cubes_screen_projection;
+
+static const float cube_vertices[] = {
+    -0.5f, -0.5f, -0.5f,
+     0.5f, -0.5f, -0.5f,
+     0.5f,  0.5f, -0.5f,
+    -0.5f,  0.5f, -0.5f,
+    -0.5f, -0.5f,  0.5f,
+     0.5f, -0.5f,  0.5f,
+     0.5f,  0.5f,  0.5f,
+    -0.5f,  0.5f,  0.5f
+};
+
+static const GLuint cube_indices[] = {
+    0, 1, 2, 2, 3, 0,
+    4, 5, 6, 6, 7, 4,
+    7, 3, 0, 0, 4, 7,
+    6, 2, 1, 1, 5, 6,
+    0, 1, 5, 5, 4, 0,
+    3, 2, 6, 6, 7, 3
+};
+static const size_t cube_element_count = 36;
+
+static IgnisShader cubes_shader;
+static IgnisVertexArray cubes_vao;
+
+static gjk3d_shape floor_shape;
+static gjk3d_shape cubes[CUBE_COUNT];
+static vec3 cube_velocities[CUBE_COUNT];
+
+static uint32_t cubes_tests, cubes_contacts;
+static float cubes_collide_ms;
+
+static float cubesRandom(float min, float max)
+{
+    return min + (max - min) * ((float)rand() / (float)RAND_MAX);
+}
+
+static void resetCubes()
+{
+    srand(1);
+    for (size_t i = 0; i < CUBE_COUNT; ++i)
+    {
+        float size = cubesRandom(0.2f, 0.4f);
+        vec3 pos = { cubesRandom(-3.0f, 3.0f), cubesRandom(1.0f, 12.0f), cubesRandom(-3.0f, 3.0f) };
+        vec3 axis = { cubesRandom(-1.0f, 1.0f), cubesRandom(-1.0f, 1.0f), cubesRandom(-1.0f, 1.0f) };
+
+        gjk3d_box(&cubes[i], pos, (vec3) { size, size, size });
+        gjk3d_set_rotation(&cubes[i], axis, cubesRandom(0.0f, MPI));
+        cube_velocities[i] = (vec3) { 0.0f, 0.0f, 0.0f };
+    }
+}
+
+static uint8_t aabbOverlap(gjk3d_aabb a, gjk3d_aabb b)
+{
+    return a.min.x <= b.max.x && b.min.x <= a.max.x
+        && a.min.y <= b.max.y && b.min.y <= a.max.y
+        && a.min.z <= b.max.z && b.min.z <= a.max.z;
+}
+
+/* removes the velocity along n that moves into the contact and damps the sliding */
+static void stopVelocity(vec3* velocity, vec3 n)
+{
+    float v = vec3_dot(*velocity, n);
+    if (v <= 0.0f) return;
+
+    vec3 tangent = vec3_sub(*velocity, vec3_mult(n, v));
+    *velocity = vec3_mult(tangent, 1.0f - CUBE_FRICTION);
+}
+
+static void stepCubes(float dt)
+{
+    for (size_t i = 0; i < CUBE_COUNT; ++i)
+    {
+        cube_velocities[i].y -= 9.81f * dt;
+        gjk3d_set_center(&cubes[i], vec3_add(cubes[i].center, vec3_mult(cube_velocities[i], dt)));
+    }
+
+    cubes_tests = 0;
+    cubes_contacts = 0;
+
+    double start = minimalGetTime();
+    for (int iteration = 0; iteration < CUBE_ITERATIONS; ++iteration)
+    {
+        gjk3d_aabb floor_aabb = gjk3d_shape_aabb(&floor_shape);
+        for (size_t i = 0; i < CUBE_COUNT; ++i)
+        {
+            gjk3d_aabb a = gjk3d_shape_aabb(&cubes[i]);
+
+            gjk3d_penetration p;
+            if (aabbOverlap(a, floor_aabb) && gjk3d_intersect(&cubes[i], &floor_shape, &p))
+            {
+                gjk3d_set_center(&cubes[i], vec3_sub(cubes[i].center, vec3_mult(p.normal, p.depth)));
+                stopVelocity(&cube_velocities[i], p.normal);
+                cubes_contacts++;
+            }
+
+            for (size_t j = i + 1; j < CUBE_COUNT; ++j)
+            {
+                if (!aabbOverlap(a, gjk3d_shape_aabb(&cubes[j]))) continue;
+
+                cubes_tests++;
+                if (!gjk3d_intersect(&cubes[i], &cubes[j], &p)) continue;
+
+                /* split the correction, the normal points from i to j */
+                vec3 half = vec3_mult(p.normal, 0.5f * p.depth);
+                gjk3d_set_center(&cubes[i], vec3_sub(cubes[i].center, half));
+                gjk3d_set_center(&cubes[j], vec3_add(cubes[j].center, half));
+
+                stopVelocity(&cube_velocities[i], p.normal);
+                stopVelocity(&cube_velocities[j], vec3_negate(p.normal));
+                cubes_contacts++;
+            }
+        }
+    }
+    cubes_collide_ms = (float)((minimalGetTime() - start) * 1000.0);
+}
+
+/* model matrix of a box: scale by its size, then rotate and translate */
+static mat4 cubeModel(const gjk3d_shape* cube)
+{
+    vec3 axes[3] = { cube->rot.x, cube->rot.y, cube->rot.z };
+    float scale[3] = { 2.0f * cube->extents.x, 2.0f * cube->extents.y, 2.0f * cube->extents.z };
+
+    mat4 model = mat4_identity();
+    for (int c = 0; c < 3; ++c)
+    {
+        model.v[c][0] = axes[c].x * scale[c];
+        model.v[c][1] = axes[c].y * scale[c];
+        model.v[c][2] = axes[c].z * scale[c];
+    }
+    model.v[3][0] = cube->center.x;
+    model.v[3][1] = cube->center.y;
+    model.v[3][2] = cube->center.z;
+    return model;
+}
+
+static void setViewport(float w, float h)
+{
+    cubes_width = w;
+    cubes_height = h;
+    cubes_screen_projection = mat4_ortho(0.0f, w, h, 0.0f, -1.0f, 1.0f);
+}
+
+int onLoadCubes(MinimalApp* app, uint32_t w, uint32_t h)
+{
+    /* ingis initialization */
+    initIgnis();
+
+    minimalEnableDebug(app, 1);
+
+    ignisEnableBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    ignisSetClearColor(IGNIS_DARK_GREY);
+
+    glEnable(GL_DEPTH_TEST);
+
+    /* font renderer */
+    ignisCreateFont(&cubes_font, "res/fonts/ProggyTiny.ttf", 24.0);
+    ignisFontRendererInit();
+    ignisFontRendererBindFontColor(&cubes_font, IGNIS_WHITE);
+
+    setViewport((float)w, (float)h);
+
+    /* cube */
+    ignisGenerateVertexArray(&cubes_vao, 2);
+
+    ignisLoadArrayBuffer(&cubes_vao, 0, sizeof(cube_vertices), cube_vertices, IGNIS_STATIC_DRAW);
+    ignisLoadElementBuffer(&cubes_vao, 1, cube_indices, cube_element_count, IGNIS_STATIC_DRAW);
+
+    IgnisBufferElement layout[] = {
+        { GL_FLOAT, 3, GL_FALSE }
+    };
+    ignisSetVertexLayout(&cubes_vao, 0, layout, 1);
+
+    /* shader */
+    cubes_shader = ignisCreateShadervf("res/shaders/shader.vert", "res/shaders/shader.frag");
+
+    /* scene */
+    gjk3d_box(&floor_shape, (vec3) { 0.0f, -0.5f, 0.0f }, (vec3) { 8.0f, 0.5f, 8.0f });
+    resetCubes();
+
+    printVersionInfo();
+
+    return MINIMAL_OK;
+}
+
+void onDestroyCubes(MinimalApp* app)
+{
+    ignisDeleteVertexArray(&cubes_vao);
+    ignisDeleteShader(cubes_shader);
+
+    ignisDeleteFont(&cubes_font);
+
+    ignisFontRendererDestroy();
+}
+
+int onEventCubes(MinimalApp* app, const MinimalEvent* e)
+{
+    float w, h;
+    if (minimalEventWindowSize(e, &w, &h))
+    {
+        setViewport(w, h);
+        glViewport(0, 0, (GLsizei)w, (GLsizei)h);
+    }
+
+    if (minimalEventKeyPressed(e) == MINIMAL_KEY_SPACE)
+        resetCubes();
+
+    return onEventDefault(app, e);
+}
+
+void onTickCubes(MinimalApp* app, float deltatime)
+{
+    /* a fixed step keeps the pile stable when a frame takes long */
+    stepCubes(1.0f / 60.0f);
+
+    // clear screen
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    vec3 camera_pos = (vec3){ 0.0f, 3.0f, 14.0f };
+
+    mat4 view = mat4_translation(vec3_negate(camera_pos));
+    mat4 proj = mat4_perspective(degToRad(45.0f), cubes_width / cubes_height, 0.1f, 100.0f);
+
+    ignisSetUniform3f(cubes_shader, "lightPos", 1, &camera_pos.x);
+
+    ignisSetUniformMat4(cubes_shader, "proj", 1, proj.v[0]);
+    ignisSetUniformMat4(cubes_shader, "view", 1, view.v[0]);
+
+    ignisUseShader(cubes_shader);
+    ignisBindVertexArray(&cubes_vao);
+
+    mat4 model = cubeModel(&floor_shape);
+    ignisSetUniformMat4(cubes_shader, "model", 1, model.v[0]);
+    glDrawElements(GL_TRIANGLES, (GLsizei)cube_element_count, GL_UNSIGNED_INT, NULL);
+
+    for (size_t i = 0; i < CUBE_COUNT; ++i)
+    {
+        model = cubeModel(&cubes[i]);
+        ignisSetUniformMat4(cubes_shader, "model", 1, model.v[0]);
+        glDrawElements(GL_TRIANGLES, (GLsizei)cube_element_count, GL_UNSIGNED_INT, NULL);
+    }
+
+    // render debug info
+    ignisFontRendererSetProjection(cubes_screen_projection.v[0]);
+
+    /* fps */
+    ignisFontRendererRenderTextFormat(8.0f, 8.0f, "FPS: %d", app->fps);
+
+    if (app->debug)
+    {
+        ignisFontRendererRenderTextFormat(8.0f, 32.0f, "Cubes: %d", CUBE_COUNT);
+        ignisFontRendererRenderTextFormat(8.0f, 56.0f, "GJK tests: %d", cubes_tests);
+        ignisFontRendererRenderTextFormat(8.0f, 80.0f, "Contacts: %d", cubes_contacts);
+        ignisFontRendererRenderTextFormat(8.0f, 104.0f, "Collide: %.2f ms", cubes_collide_ms);
+
+        /* Settings */
+        ignisFontRendererTextFieldBegin(cubes_width - 220.0f, 8.0f, 8.0f);
+
+        ignisFontRendererTextFieldLine("F6: Toggle Vsync");
+        ignisFontRendererTextFieldLine("F7: Toggle debug mode");
+        ignisFontRendererTextFieldLine("SPACE: Reset cubes");
+    }
+
+    ignisFontRendererFlush();
+}
+
+MinimalApp example_cubes()
+{
+    return (MinimalApp) {
+        .on_load = onLoadCubes,
+        .on_destroy = onDestroyCubes,
+        .on_event = onEventCubes,
+        .on_tick = onTickCubes
+    };
+}
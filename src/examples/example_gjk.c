@@ -2,6 +2,8 @@
 
 #include "gjk.h"
 
+#include <stdlib.h>
+
 IgnisFont font;
 
 float screen_width, screen_height;
@@ -87,7 +89,15 @@ void RenderCircle(gjk_shape* circle, IgnisColorRGBA color)
 
 void RenderPoly(gjk_shape* shape, IgnisColorRGBA color)
 {
-    ignisPrimitives2DRenderPoly((float*)shape->vertices, shape->count * 2, 0, 0, color);
+    /* the vertices are in local space, the hill climb shapes have hundreds of them */
+    gjk_vec2* vertices = malloc(sizeof(gjk_vec2) * shape->count);
+    if (!vertices) return;
+
+    for (size_t i = 0; i < shape->count; ++i)
+        vertices[i] = gjk_get_vertex(shape, i);
+
+    ignisPrimitives2DRenderPoly((float*)vertices, shape->count * 2, 0, 0, color);
+    free(vertices);
     RenderPoint(shape->center, color);
 }
 
@@ -162,13 +172,8 @@ void onTickGJK(MinimalApp* app, float deltatime)
     {
         ignisPrimitives2DRenderPoly((float*)simplex, 6, 0, 0, IGNIS_GREEN);
 
-        epa_edge edge;
-        epa_closest_edge(simplex, 3, &edge);
-
-        ignisPrimitives2DRenderLine(edge.p.x, edge.p.y, edge.q.x, edge.q.y, IGNIS_BLUE);
-
         gjk_vec2 n;
-        float d = epa(&triangle, &poly, simplex, &n);
+        float d = epa(&triangle, &poly, simplex, &n, NULL, NULL);
         //Primitives2DRenderLineDir(triangle.center.x, triangle.center.y, n.x, n.y, d, IGNIS_RED);
     }
 
@@ -14,6 +14,9 @@ int onEventDefault(MinimalApp* app, const MinimalEvent* e);
 // ---------------| CUBE |-------------------------------
 MinimalApp example_cube();
 
+// ---------------| CUBES |------------------------------
+MinimalApp example_cubes();
+
 // ---------------| GJK |--------------------------------
 MinimalApp example_gjk();
 
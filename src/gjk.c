@@ -1,42 +1,227 @@
 #include "gjk.h"
+#include "gjk_simd.h"
 
+#include "math/inline.h"
+
+#include <stdlib.h>
 #include <math.h>
 #include <float.h>
 
 static const gjk_vec2 GJK_ORIGIN = { 0.0f, 0.0f };
 
-static gjk_vec2 gjk_furthest_point_circle(const gjk_shape* shape, gjk_vec2 d)
+/* guards against cycling on degenerate simplices */
+#define GJK_MAX_ITERATIONS 64
+
+/* steps a warm started hill climb may take before falling back to a binary search */
+#define GJK_HILL_CLIMB_STEPS 8
+
+static gjk_vec2 gjk_furthest_point_circle(const gjk_shape* shape, gjk_vec2 d, size_t* hint)
 {
+    (void)hint; /* keeps the signature of the support table, only polygons use it */
     gjk_vec2 n = gjk_normalize(d);
     return (gjk_vec2) { shape->center.x + shape->radius * n.x, shape->center.y + shape->radius * n.y };
 }
 
-static gjk_vec2 gjk_furthest_point_poly(const gjk_shape* shape, gjk_vec2 d)
+static size_t gjk_poly_scan(const gjk_vec2* vertices, size_t count, gjk_vec2 d)
 {
-    float max_dot = gjk_dot_product(d, shape->vertices[0]);
+    float max_dot = gjk_dot_product(d, vertices[0]);
     size_t index = 0;
-    for (size_t i = 1; i < shape->count; ++i)
+    for (size_t i = 1; i < count; ++i)
     {
-        float dot = gjk_dot_product(d, shape->vertices[i]);
+        float dot = gjk_dot_product(d, vertices[i]);
         if (dot > max_dot)
         {
             max_dot = dot;
             index = i;
         }
     }
-    return shape->vertices[index];
+    return index;
 }
 
-gjk_vec2 gjk_furthest_point(const gjk_shape* shape, gjk_vec2 d)
+/*
+ * binary search for the extreme vertex of a convex polygon in O(log n).
+ * The dot products along the vertex ring rise to the maximum and fall
+ * afterwards, so every step can discard one half of the remaining chain.
+ * returns GJK_NO_HINT if the polygon is too degenerate for the search.
+ */
+static size_t gjk_poly_search(const gjk_vec2* vertices, size_t count, gjk_vec2 d)
+{
+    #define GJK_VERTEX(i) vertices[(i) % count]
+    #define GJK_ABOVE(i, j) (gjk_dot_product(d, gjk_sub(GJK_VERTEX(i), GJK_VERTEX(j))) > 0.0f)
+    #define GJK_BELOW(i, j) (gjk_dot_product(d, gjk_sub(GJK_VERTEX(i), GJK_VERTEX(j))) < 0.0f)
+    #define GJK_UP(i)       (gjk_dot_product(d, gjk_sub(GJK_VERTEX((i) + 1), GJK_VERTEX(i))) >= 0.0f)
+
+    /* check if the first vertex is the maximum */
+    uint8_t up_a = GJK_UP(0);
+    if (!up_a && !GJK_ABOVE(count - 1, 0)) return 0;
+
+    size_t a = 0, b = count;
+    while (b > a + 1)
+    {
+        size_t c = (a + b) / 2;
+        uint8_t up_c = GJK_UP(c);
+        if (!up_c && !GJK_ABOVE(c - 1, c)) return c;
+
+        /* select the sub chain [a,c] or [c,b] that contains the maximum */
+        if (up_a ? (!up_c || GJK_ABOVE(a, c)) : (!up_c && GJK_BELOW(a, c)))
+        {
+            b = c;
+        }
+        else
+        {
+            a = c;
+            up_a = up_c;
+        }
+    }
+
+    #undef GJK_VERTEX
+    #undef GJK_ABOVE
+    #undef GJK_BELOW
+    #undef GJK_UP
+
+    return GJK_NO_HINT;
+}
+
+/* vertices less than this fraction of the bounding radius below the best one along d do not stop a climb */
+#define GJK_CLIMB_TOLERANCE 1e-5f
+
+/*
+ * walks along the vertex ring from index in both directions while the dot
+ * product does not clearly drop below the best one found. The tolerance lets
+ * the walk cross plateaus perpendicular to d and the dips rounding leaves at
+ * nearly collinear or nearly duplicated vertices, where a strict increase
+ * would stop early. returns GJK_NO_HINT if the walks take more than max_steps.
+ */
+static size_t gjk_poly_climb(const gjk_vec2* vertices, size_t count, float radius, gjk_vec2 d, size_t index, size_t max_steps)
+{
+    float tolerance = GJK_CLIMB_TOLERANCE * radius * sqrtf(gjk_dot_product(d, d));
+
+    float max_dot = gjk_dot_product(d, vertices[index]);
+    size_t best = index;
+    size_t steps = 0;
+
+    /* the second walk stops at once if the first one climbed away from the start */
+    for (int forward = 1; forward >= 0; --forward)
+    {
+        size_t i = index;
+        for (;;)
+        {
+            if (forward) i = i + 1 < count ? i + 1 : 0;
+            else         i = i ? i - 1 : count - 1;
+
+            float dot = gjk_dot_product(d, vertices[i]);
+            if (i == index || dot < max_dot - tolerance) break;
+            if (steps++ >= max_steps) return GJK_NO_HINT;
+
+            if (dot > max_dot)
+            {
+                max_dot = dot;
+                best = i;
+            }
+        }
+    }
+    return best;
+}
+
+static gjk_vec2 gjk_furthest_point_poly(const gjk_shape* shape, gjk_vec2 d, size_t* hint)
+{
+    const gjk_vec2* vertices = shape->vertices;
+    size_t count = shape->count;
+
+    /* search in local space */
+    d = gjk_inv_rotate(shape->rot, d);
+
+    size_t index = GJK_NO_HINT;
+    if (shape->hill_climb)
+    {
+        /* warm start from the previous support vertex */
+        if (*hint < count)
+            index = gjk_poly_climb(vertices, count, shape->bounding_radius, d, *hint, GJK_HILL_CLIMB_STEPS);
+
+        /* the direction changed too much, search from scratch */
+        if (index == GJK_NO_HINT)
+        {
+            index = gjk_poly_search(vertices, count, d);
+            if (index != GJK_NO_HINT) index = gjk_poly_climb(vertices, count, shape->bounding_radius, d, index, count);
+        }
+    }
+
+    if (index == GJK_NO_HINT)
+        index = shape->soa ? gjk_support_soa(shape->soa, shape->soa + count, count, d) : gjk_poly_scan(vertices, count, d);
+
+    *hint = index;
+    return gjk_get_vertex(shape, index);
+}
+
+/* the support point of the core shape pushed out by the radius */
+static gjk_vec2 gjk_inflate(gjk_vec2 p, gjk_vec2 d, float radius)
+{
+    gjk_vec2 n = gjk_normalize(d);
+    return (gjk_vec2) { p.x + radius * n.x, p.y + radius * n.y };
+}
+
+static gjk_vec2 gjk_furthest_point_segment(const gjk_shape* shape, gjk_vec2 d, size_t* hint)
+{
+    (void)hint;
+    float x = gjk_dot_product(d, (gjk_vec2) { shape->rot.c, shape->rot.s }) >= 0.0f ? shape->half_length : -shape->half_length;
+    return (gjk_vec2) { shape->center.x + shape->rot.c * x, shape->center.y + shape->rot.s * x };
+}
+
+static gjk_vec2 gjk_furthest_point_capsule(const gjk_shape* shape, gjk_vec2 d, size_t* hint)
+{
+    return gjk_inflate(gjk_furthest_point_segment(shape, d, hint), d, shape->radius);
+}
+
+static gjk_vec2 gjk_furthest_point_box(const gjk_shape* shape, gjk_vec2 d, size_t* hint)
+{
+    (void)hint;
+    gjk_vec2 local = gjk_inv_rotate(shape->rot, d);
+    gjk_vec2 p = {
+        local.x >= 0.0f ? shape->extents.x : -shape->extents.x,
+        local.y >= 0.0f ? shape->extents.y : -shape->extents.y
+    };
+    return gjk_add(shape->center, gjk_rotate(shape->rot, p));
+}
+
+static gjk_vec2 gjk_furthest_point_ellipse(const gjk_shape* shape, gjk_vec2 d, size_t* hint)
+{
+    (void)hint;
+    /* maximizing d.p on (x/a)^2 + (y/b)^2 = 1 gives p = (a^2 dx, b^2 dy) / |(a dx, b dy)| */
+    gjk_vec2 local = gjk_inv_rotate(shape->rot, d);
+    float ax = shape->extents.x * local.x;
+    float by = shape->extents.y * local.y;
+    float inv = 1.0f / sqrtf(ax * ax + by * by);
+
+    gjk_vec2 p = { shape->extents.x * ax * inv, shape->extents.y * by * inv };
+    return gjk_add(shape->center, gjk_rotate(shape->rot, p));
+}
+
+static gjk_vec2 gjk_furthest_point_rounded(const gjk_shape* shape, gjk_vec2 d, size_t* hint)
+{
+    return gjk_inflate(gjk_furthest_point_poly(shape, d, hint), d, shape->radius);
+}
+
+gjk_vec2 gjk_furthest_point_hint(const gjk_shape* shape, gjk_vec2 d, size_t* hint)
 {
     switch (shape->type)
     {
-    case GJK_CIRCLE: return gjk_furthest_point_circle(shape, d);
-    case GJK_POLY:   return gjk_furthest_point_poly(shape, d);
-    default:         return (gjk_vec2) { 0.0f, 0.0f };
+    case GJK_CIRCLE:  return gjk_furthest_point_circle(shape, d, hint);
+    case GJK_POLY:    return gjk_furthest_point_poly(shape, d, hint);
+    case GJK_SEGMENT: return gjk_furthest_point_segment(shape, d, hint);
+    case GJK_CAPSULE: return gjk_furthest_point_capsule(shape, d, hint);
+    case GJK_BOX:     return gjk_furthest_point_box(shape, d, hint);
+    case GJK_ELLIPSE: return gjk_furthest_point_ellipse(shape, d, hint);
+    case GJK_ROUNDED: return gjk_furthest_point_rounded(shape, d, hint);
+    default:          return (gjk_vec2) { 0.0f, 0.0f };
     }
 }
 
+gjk_vec2 gjk_furthest_point(const gjk_shape* shape, gjk_vec2 d)
+{
+    size_t hint = GJK_NO_HINT;
+    return gjk_furthest_point_hint(shape, d, &hint);
+}
+
 gjk_vec2 gjk_minkowski_difference(const gjk_shape* s1, const gjk_shape* s2, gjk_vec2 d)
 {
     gjk_vec2 a = gjk_furthest_point(s1, d);
@@ -49,48 +234,400 @@ void gjk_circle(gjk_shape* shape, gjk_vec2 center, float radius)
 {
     shape->type = GJK_CIRCLE;
     shape->center = center;
+    shape->rot = gjk_rotation(0.0f);
     shape->radius = radius;
+    gjk_update_bounds(shape);
+}
+
+void gjk_segment(gjk_shape* shape, gjk_vec2 a, gjk_vec2 b)
+{
+    gjk_vec2 ab = gjk_sub(b, a);
+    float length = sqrtf(gjk_length_Squared(ab));
+
+    shape->type = GJK_SEGMENT;
+    shape->center = (gjk_vec2) { 0.5f * (a.x + b.x), 0.5f * (a.y + b.y) };
+    shape->rot = gjk_rotation(atan2f(ab.y, ab.x));
+    shape->radius = 0.0f;
+    shape->half_length = 0.5f * length;
+    gjk_update_bounds(shape);
+}
+
+static void gjk_inflate_bounds(gjk_shape* shape, float radius)
+{
+    shape->aabb.min = (gjk_vec2) { shape->aabb.min.x - radius, shape->aabb.min.y - radius };
+    shape->aabb.max = (gjk_vec2) { shape->aabb.max.x + radius, shape->aabb.max.y + radius };
+    shape->bounding_radius += radius;
+}
+
+void gjk_capsule(gjk_shape* shape, gjk_vec2 a, gjk_vec2 b, float radius)
+{
+    gjk_segment(shape, a, b);
+    shape->type = GJK_CAPSULE;
+    shape->radius = radius;
+    gjk_inflate_bounds(shape, radius);
+}
+
+void gjk_box(gjk_shape* shape, gjk_vec2 center, gjk_vec2 extents)
+{
+    shape->type = GJK_BOX;
+    shape->center = center;
+    shape->rot = gjk_rotation(0.0f);
+    shape->radius = 0.0f;
+    shape->extents = extents;
+    gjk_update_bounds(shape);
+}
+
+void gjk_ellipse(gjk_shape* shape, gjk_vec2 center, gjk_vec2 radii)
+{
+    shape->type = GJK_ELLIPSE;
+    shape->center = center;
+    shape->rot = gjk_rotation(0.0f);
+    shape->radius = 0.0f;
+    shape->extents = radii;
+    gjk_update_bounds(shape);
+}
+
+static uint8_t gjk_is_convex(const gjk_vec2* vertices, size_t count)
+{
+    uint8_t positive = 0, negative = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        gjk_vec2 a = vertices[i];
+        gjk_vec2 b = vertices[(i + 1) % count];
+        gjk_vec2 c = vertices[(i + 2) % count];
+
+        float cross = (b.x - a.x) * (c.y - b.y) - (b.y - a.y) * (c.x - b.x);
+        if (cross > 0.0f) positive = 1;
+        if (cross < 0.0f) negative = 1;
+    }
+    return !(positive && negative);
 }
 
-void gjk_poly(gjk_shape* shape, gjk_vec2* vertices, size_t count)
+static float gjk_signed_area(const gjk_vec2* vertices, size_t count)
+{
+    float area = 0.0f;
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t j = (i + 1) % count;
+        area += vertices[i].x * vertices[j].y - vertices[j].x * vertices[i].y;
+    }
+    return 0.5f * area;
+}
+
+void gjk_poly(gjk_shape* shape, const gjk_vec2* vertices, size_t count)
 {
     shape->type = GJK_POLY;
     shape->vertices = vertices;
+    shape->soa = NULL;
     shape->count = count;
-    shape->center = gjk_get_centroid(vertices, count);
+    shape->hill_climb = count >= GJK_HILL_CLIMB_THRESHOLD && gjk_is_convex(vertices, count);
+    shape->winding = gjk_signed_area(vertices, count) < 0.0f ? -1 : 1;
+    shape->centroid = gjk_get_centroid(vertices, count);
+    shape->center = shape->centroid;
+    shape->rot = gjk_rotation(0.0f);
+    shape->radius = 0.0f;
+    gjk_update_bounds(shape);
 }
 
+void gjk_rounded(gjk_shape* shape, const gjk_vec2* vertices, size_t count, float radius)
+{
+    gjk_poly(shape, vertices, count);
+    shape->type = GJK_ROUNDED;
+    shape->radius = radius;
+    gjk_inflate_bounds(shape, radius);
+}
+
+void gjk_poly_soa(gjk_shape* shape, float* buffer)
+{
+    for (size_t i = 0; i < shape->count; ++i)
+    {
+        buffer[i] = shape->vertices[i].x;
+        buffer[shape->count + i] = shape->vertices[i].y;
+    }
+    shape->soa = buffer;
+}
+
+static gjk_aabb gjk_compute_aabb(const gjk_shape* shape);
+
 void gjk_set_center(gjk_shape* shape, gjk_vec2 center)
 {
-    gjk_vec2 d = gjk_sub(center, shape->center);
+    /* the bounds move with the shape */
+    gjk_vec2 delta = gjk_sub(center, shape->center);
+    shape->aabb.min = gjk_add(shape->aabb.min, delta);
+    shape->aabb.max = gjk_add(shape->aabb.max, delta);
     shape->center = center;
+}
 
-    if (shape->type == GJK_CIRCLE) return;
+void gjk_set_rotation(gjk_shape* shape, float angle)
+{
+    shape->rot = gjk_rotation(angle);
+    shape->aabb = gjk_compute_aabb(shape);
+}
 
-    for (size_t i = 0; i < shape->count; ++i)
-        shape->vertices[i] = gjk_add(shape->vertices[i], d);
+void gjk_set_transform(gjk_shape* shape, gjk_vec2 center, gjk_rot rot)
+{
+    shape->center = center;
+    shape->rot = rot;
+    shape->aabb = gjk_compute_aabb(shape);
 }
 
-uint8_t gjk_collision(const gjk_shape* s1, const gjk_shape* s2, gjk_vec2* simplex_ptr)
+void gjk_update_bounds(gjk_shape* shape)
 {
-    gjk_vec2 d = gjk_sub(s2->center, s1->center);
+    float r = 0.0f;
+    switch (shape->type)
+    {
+    case GJK_SEGMENT:
+    case GJK_CAPSULE:
+        r = shape->half_length;
+        break;
+    case GJK_BOX:
+        r = sqrtf(gjk_length_Squared(shape->extents));
+        break;
+    case GJK_ELLIPSE:
+        r = shape->extents.x > shape->extents.y ? shape->extents.x : shape->extents.y;
+        break;
+    case GJK_POLY:
+    case GJK_ROUNDED:
+    {
+        /* the only pass over the vertices, the setters work on the local aabb */
+        gjk_vec2 v = gjk_sub(shape->vertices[0], shape->centroid);
+        shape->local_aabb = (gjk_aabb) { v, v };
+        for (size_t i = 0; i < shape->count; ++i)
+        {
+            v = gjk_sub(shape->vertices[i], shape->centroid);
+            if (v.x < shape->local_aabb.min.x) shape->local_aabb.min.x = v.x;
+            if (v.y < shape->local_aabb.min.y) shape->local_aabb.min.y = v.y;
+            if (v.x > shape->local_aabb.max.x) shape->local_aabb.max.x = v.x;
+            if (v.y > shape->local_aabb.max.y) shape->local_aabb.max.y = v.y;
+
+            float l = gjk_length_Squared(v);
+            if (l > r) r = l;
+        }
+        r = sqrtf(r);
+        break;
+    }
+    default:
+        break;
+    }
+
+    shape->bounding_radius = r + shape->radius;
+    shape->aabb = gjk_compute_aabb(shape);
+}
+
+gjk_vec2 gjk_get_vertex(const gjk_shape* shape, size_t index)
+{
+    return gjk_add(shape->center, gjk_rotate(shape->rot, gjk_sub(shape->vertices[index], shape->centroid)));
+}
+
+static gjk_aabb gjk_compute_aabb(const gjk_shape* shape)
+{
+    /* half size of the core shape around the center */
+    gjk_vec2 e = { 0.0f, 0.0f };
+    float c = fabsf(shape->rot.c), s = fabsf(shape->rot.s);
+
+    switch (shape->type)
+    {
+    case GJK_SEGMENT:
+    case GJK_CAPSULE:
+        e = (gjk_vec2) { c * shape->half_length, s * shape->half_length };
+        break;
+    case GJK_BOX:
+        e = (gjk_vec2) { c * shape->extents.x + s * shape->extents.y, s * shape->extents.x + c * shape->extents.y };
+        break;
+    case GJK_ELLIPSE:
+    {
+        float a = shape->extents.x, b = shape->extents.y;
+        e = (gjk_vec2) { sqrtf(a * a * c * c + b * b * s * s), sqrtf(a * a * s * s + b * b * c * c) };
+        break;
+    }
+    case GJK_POLY:
+    case GJK_ROUNDED:
+    {
+        /* the rotated local aabb, clipped to the bounding circle of the core */
+        gjk_vec2 h = { 0.5f * (shape->local_aabb.max.x - shape->local_aabb.min.x), 0.5f * (shape->local_aabb.max.y - shape->local_aabb.min.y) };
+        gjk_vec2 m = { 0.5f * (shape->local_aabb.max.x + shape->local_aabb.min.x), 0.5f * (shape->local_aabb.max.y + shape->local_aabb.min.y) };
+        gjk_vec2 o = gjk_rotate(shape->rot, m);
+        float r = shape->bounding_radius - shape->radius;
+
+        gjk_aabb aabb = {
+            { fmaxf(o.x - c * h.x - s * h.y, -r), fmaxf(o.y - s * h.x - c * h.y, -r) },
+            { fminf(o.x + c * h.x + s * h.y,  r), fminf(o.y + s * h.x + c * h.y,  r) }
+        };
+        aabb.min.x += shape->center.x - shape->radius;
+        aabb.min.y += shape->center.y - shape->radius;
+        aabb.max.x += shape->center.x + shape->radius;
+        aabb.max.y += shape->center.y + shape->radius;
+        return aabb;
+    }
+    default:
+        break;
+    }
+
+    gjk_aabb aabb = {
+        { shape->center.x - e.x - shape->radius, shape->center.y - e.y - shape->radius },
+        { shape->center.x + e.x + shape->radius, shape->center.y + e.y + shape->radius }
+    };
+    return aabb;
+}
+
+gjk_aabb gjk_shape_aabb(const gjk_shape* shape)
+{
+    return shape->aabb;
+}
+
+uint8_t gjk_bounds_overlap(const gjk_shape* s1, const gjk_shape* s2)
+{
+    if (!gjk_aabb_overlap(s1->aabb, s2->aabb)) return 0;
+
+    /* the circles reject diagonal pairs with overlapping boxes */
+    float r = s1->bounding_radius + s2->bounding_radius;
+    return gjk_length_Squared(gjk_sub(s2->center, s1->center)) <= r * r;
+}
+
+typedef gjk_vec2 (*gjk_support_func)(const gjk_shape* shape, gjk_vec2 d, size_t* hint);
+
+/*
+ * support points are differences of world space points and carry their
+ * rounding error. Closer to the border of the minkowski difference than this
+ * fraction of the coordinates the cache can not tell touching from separated.
+ */
+#define GJK_CACHE_TOLERANCE (8.0f * FLT_EPSILON)
+
+static float gjk_cache_tolerance(const gjk_shape* s1, const gjk_shape* s2)
+{
+    float scale = fabsf(s1->center.x) + fabsf(s1->center.y) + fabsf(s2->center.x) + fabsf(s2->center.y);
+    return GJK_CACHE_TOLERANCE * (scale + s1->bounding_radius + s2->bounding_radius);
+}
+
+/* the support point p along d lies more than margin behind the origin */
+static uint8_t gjk_separates(gjk_vec2 p, gjk_vec2 d, float margin)
+{
+    float dist = gjk_dot_product(p, d);
+    return dist < 0.0f && dist * dist > margin * margin * gjk_length_Squared(d);
+}
+
+/* origin inside the triangle abc and at least margin away from its edges */
+static uint8_t gjk_triangle_contains_origin(gjk_vec2 a, gjk_vec2 b, gjk_vec2 c, float margin)
+{
+    /* twice the area of the triangle of the origin and each edge, they add up to the one of abc */
+    float ab = a.x * b.y - a.y * b.x;
+    float bc = b.x * c.y - b.y * c.x;
+    float ca = c.x * a.y - c.y * a.x;
+    if (ab + bc + ca < 0.0f)
+    {
+        ab = -ab;
+        bc = -bc;
+        ca = -ca;
+    }
+
+    if (ab <= 0.0f || bc <= 0.0f || ca <= 0.0f) return 0;
+
+    /* compared squared, the distance of the origin to an edge is its area over its length */
+    float margin_sq = margin * margin;
+    return ab * ab > margin_sq * gjk_length_Squared(gjk_sub(b, a))
+        && bc * bc > margin_sq * gjk_length_Squared(gjk_sub(c, b))
+        && ca * ca > margin_sq * gjk_length_Squared(gjk_sub(a, c));
+}
+
+/*
+ * GJK core shared by the single and the batched entry points, for shapes
+ * whose bounds overlap. The support functions are passed in and the core is
+ * forced inline, so the batch path can hand over the type specific ones and
+ * have them called directly instead of through the switch in
+ * gjk_furthest_point_hint for every support query.
+ * The support hints carry the last support vertex of every shape from one
+ * iteration to the next.
+ * With a cache the search starts from the last simplex or separating
+ * direction. A warm start only decides pairs that clearly overlap or are
+ * clearly apart, touching pairs are searched again from the direction
+ * between the shapes so they get the same answer as without a cache.
+ */
+MATH_INLINE uint8_t gjk_solve_overlapping(const gjk_shape* s1, gjk_support_func f1, const gjk_shape* s2, gjk_support_func f2, gjk_cache* cache, gjk_vec2* simplex_ptr, uint32_t* iterations)
+{
+    size_t hint1 = cache ? cache->hints[0] : GJK_NO_HINT;
+    size_t hint2 = cache ? cache->hints[1] : GJK_NO_HINT;
 
-    gjk_vec2 simplex[3] = { gjk_minkowski_difference(s1, s2, d), 0.0f, 0.0f };
+    /* search directions that produced the simplex points */
+    gjk_vec2 dirs[3];
+    gjk_vec2 simplex[3];
     size_t simplex_size = 1;
+    uint8_t collision = 0;
+    uint32_t queries = 0; /* support queries on the minkowski difference */
 
-    d = gjk_sub(GJK_ORIGIN, simplex[0]);
+    /* a warm start only decides pairs clearly apart or clearly overlapping */
+    float tolerance = cache && cache->count ? gjk_cache_tolerance(s1, s2) : 0.0f;
+    uint8_t warm = 0;
 
-    gjk_vec2 A, AB, AC, AO, ABperp, ACperp;
-    while (1)
+    if (cache && cache->count == 3)
     {
-        A = simplex[simplex_size++] = gjk_minkowski_difference(s1, s2, d);
-        if (gjk_dot_product(A, d) < 0) return 0;
+        /* rebuild the last simplex, resting contacts are done here */
+        for (size_t i = 0; i < 3; ++i)
+        {
+            dirs[i] = cache->directions[i];
+            simplex[i] = gjk_sub(f1(s1, dirs[i], &hint1), f2(s2, gjk_negate(dirs[i]), &hint2));
+        }
+        queries += 3;
 
+        if (gjk_triangle_contains_origin(simplex[0], simplex[1], simplex[2], tolerance))
+        {
+            simplex_size = 3;
+            collision = 1;
+            goto done;
+        }
+
+        /* restart from the newest point of the old simplex */
+        dirs[0] = dirs[2];
+        simplex[0] = simplex[2];
+        warm = 1;
+    }
+    else if (cache && cache->count == 1)
+    {
+        /* the last separating direction */
+        dirs[0] = cache->directions[0];
+        simplex[0] = gjk_sub(f1(s1, dirs[0], &hint1), f2(s2, gjk_negate(dirs[0]), &hint2));
+        queries++;
+
+        if (gjk_separates(simplex[0], dirs[0], tolerance))
+            goto done;
+        warm = 1;
+    }
+
+search:
+    if (!warm)
+    {
+        /* start in the direction between the shapes */
+        dirs[0] = gjk_sub(s2->center, s1->center);
+        if (dirs[0].x == 0.0f && dirs[0].y == 0.0f) dirs[0].x = 1.0f;
+        simplex[0] = gjk_sub(f1(s1, dirs[0], &hint1), f2(s2, gjk_negate(dirs[0]), &hint2));
+        queries++;
+    }
+
+    gjk_vec2 d = gjk_sub(GJK_ORIGIN, simplex[0]);
+    uint8_t clear = 0;
+
+    gjk_vec2 A, AB, AC, AO, ABperp, ACperp;
+    for (size_t iteration = 0; iteration < GJK_MAX_ITERATIONS; ++iteration)
+    {
+        dirs[simplex_size] = d;
+        A = simplex[simplex_size++] = gjk_sub(f1(s1, d, &hint1), f2(s2, gjk_negate(d), &hint2));
+        queries++;
+        if (gjk_dot_product(A, d) < 0)
+        {
+            /* d is a separating direction */
+            clear = warm && gjk_separates(A, d, tolerance);
+            dirs[0] = d;
+            simplex_size = 1;
+            break;
+        }
         if (simplex_size == 2)
         {
             AB = gjk_sub(simplex[0], A);
             AO = gjk_sub(GJK_ORIGIN, A);
             d = gjk_triple_product(AB, AO, AB);
+
+            /* the origin lies on the line through AB, search on either side */
+            if (gjk_length_Squared(d) <= FLT_EPSILON * gjk_length_Squared(AB) * gjk_length_Squared(AB))
+                d = gjk_perpendicular(AB);
         }
         else
         {
@@ -105,6 +642,8 @@ uint8_t gjk_collision(const gjk_shape* s1, const gjk_shape* s2, gjk_vec2* simple
                 /* remove simplex[0] */
                 simplex[0] = simplex[1];
                 simplex[1] = simplex[2];
+                dirs[0] = dirs[1];
+                dirs[1] = dirs[2];
                 simplex_size--;
                 d = ABperp;
             }
@@ -112,125 +651,825 @@ uint8_t gjk_collision(const gjk_shape* s1, const gjk_shape* s2, gjk_vec2* simple
             {
                 /* remove simplex[1] */
                 simplex[1] = simplex[2];
+                dirs[1] = dirs[2];
                 simplex_size--;
                 d = ACperp;
             }
             else
             {
-                if (simplex_ptr)
-                {
-                    simplex_ptr[0] = simplex[0];
-                    simplex_ptr[1] = simplex[1];
-                    simplex_ptr[2] = simplex[2];
-                }
-                return 1;
+                clear = warm && gjk_triangle_contains_origin(simplex[0], simplex[1], simplex[2], tolerance);
+                collision = 1;
+                break;
             }
         }
     }
 
-    return 0;
+    /* touching after a warm start, decide like a search without a cache */
+    if (warm && !clear)
+    {
+        warm = 0;
+        collision = 0;
+        simplex_size = 1;
+        goto search;
+    }
+
+
+done:
+    if (collision && simplex_ptr)
+    {
+        simplex_ptr[0] = simplex[0];
+        simplex_ptr[1] = simplex[1];
+        simplex_ptr[2] = simplex[2];
+    }
+
+    if (cache)
+    {
+        cache->count = collision ? 3 : (uint8_t)(simplex_size == 1);
+        for (size_t i = 0; i < cache->count; ++i)
+            cache->directions[i] = dirs[i];
+        cache->hints[0] = hint1;
+        cache->hints[1] = hint2;
+    }
+
+    if (iterations) *iterations = queries;
+    return collision;
+}
+
+static uint8_t gjk_solve(const gjk_shape* s1, const gjk_shape* s2, gjk_cache* cache, gjk_vec2* simplex_ptr, uint32_t* iterations)
+{
+    if (iterations) *iterations = 0;
+
+    /* most candidate pairs of sparse scenes are far apart, the cache stays as it is */
+    if (!gjk_bounds_overlap(s1, s2)) return 0;
+
+    return gjk_solve_overlapping(s1, gjk_furthest_point_hint, s2, gjk_furthest_point_hint, cache, simplex_ptr, iterations);
+}
+
+uint8_t gjk_collision(const gjk_shape* s1, const gjk_shape* s2, gjk_vec2* simplex_ptr)
+{
+    return gjk_solve(s1, s2, NULL, simplex_ptr, NULL);
+}
+
+uint8_t gjk_collision_stats(const gjk_shape* s1, const gjk_shape* s2, gjk_vec2* simplex_ptr, gjk_stats* stats)
+{
+    return gjk_solve(s1, s2, NULL, simplex_ptr, &stats->iterations);
+}
+
+void gjk_cache_reset(gjk_cache* cache)
+{
+    cache->count = 0;
+    cache->hints[0] = GJK_NO_HINT;
+    cache->hints[1] = GJK_NO_HINT;
+}
+
+uint8_t gjk_collision_cached(const gjk_shape* s1, const gjk_shape* s2, gjk_cache* cache, gjk_vec2* simplex_ptr)
+{
+    return gjk_solve(s1, s2, cache, simplex_ptr, NULL);
+}
+
+// ---------------| DISTANCE |---------------------------
+/* relative progress of the distance below which the search stops */
+#define GJK_DISTANCE_TOLERANCE 1e-6f
+
+/*
+ * round shapes are a core shape inflated by the radius. The distance query
+ * runs on the cores, which are points, segments and polygons for circles,
+ * capsules and rounded polygons, and subtracts the radii afterwards.
+ */
+static gjk_vec2 gjk_core_point(const gjk_shape* shape, gjk_vec2 d, size_t* hint)
+{
+    switch (shape->type)
+    {
+    case GJK_CIRCLE:  return shape->center;
+    case GJK_CAPSULE: return gjk_furthest_point_segment(shape, d, hint);
+    case GJK_ROUNDED: return gjk_furthest_point_poly(shape, d, hint);
+    default:          return gjk_furthest_point_hint(shape, d, hint);
+    }
+}
+
+typedef struct
+{
+    gjk_vec2 w;    /* point of the minkowski difference */
+    gjk_vec2 a, b; /* support points on s1 and s2 with w = a - b */
+    float u;       /* barycentric weight of the closest point */
+} gjk_simplex_vertex;
+
+/* reduces the simplex to the features closest to the origin and returns the closest point */
+static gjk_vec2 gjk_simplex_closest(gjk_simplex_vertex* v, size_t* count)
+{
+    #define GJK_KEEP1(i)          do { v[0] = v[i]; v[0].u = 1.0f; *count = 1; return v[0].w; } while (0)
+    #define GJK_KEEP2(i, j, t)    do { gjk_simplex_vertex vi = v[i], vj = v[j]; v[0] = vi; v[1] = vj; \
+                                       v[0].u = 1.0f - (t); v[1].u = (t); *count = 2; \
+                                       return (gjk_vec2) { vi.w.x + (t) * (vj.w.x - vi.w.x), vi.w.y + (t) * (vj.w.y - vi.w.y) }; } while (0)
+
+    gjk_vec2 a = v[0].w;
+    if (*count == 1)
+        GJK_KEEP1(0);
+
+    gjk_vec2 ab = gjk_sub(v[1].w, a);
+    if (*count == 2)
+    {
+        float t = -gjk_dot_product(a, ab) / gjk_length_Squared(ab);
+        if (t <= 0.0f) GJK_KEEP1(0);
+        if (t >= 1.0f) GJK_KEEP1(1);
+        GJK_KEEP2(0, 1, t);
+    }
+
+    /* triangle, voronoi regions from Ericson's closest point on triangle */
+    gjk_vec2 b = v[1].w, c = v[2].w;
+    gjk_vec2 ac = gjk_sub(c, a);
+
+    float d1 = -gjk_dot_product(ab, a), d2 = -gjk_dot_product(ac, a);
+    if (d1 <= 0.0f && d2 <= 0.0f) GJK_KEEP1(0);
+
+    float d3 = -gjk_dot_product(ab, b), d4 = -gjk_dot_product(ac, b);
+    if (d3 >= 0.0f && d4 <= d3) GJK_KEEP1(1);
+
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) GJK_KEEP2(0, 1, d1 / (d1 - d3));
+
+    float d5 = -gjk_dot_product(ab, c), d6 = -gjk_dot_product(ac, c);
+    if (d6 >= 0.0f && d5 <= d6) GJK_KEEP1(2);
+
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) GJK_KEEP2(0, 2, d2 / (d2 - d6));
+
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) GJK_KEEP2(1, 2, (d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+    /* the origin is inside the triangle */
+    float denom = 1.0f / (va + vb + vc);
+    v[1].u = vb * denom;
+    v[2].u = vc * denom;
+    v[0].u = 1.0f - v[1].u - v[2].u;
+    *count = 3;
+    return GJK_ORIGIN;
+
+    #undef GJK_KEEP1
+    #undef GJK_KEEP2
 }
 
-float epa_closest_edge(gjk_vec2* polytope, size_t size, epa_edge* edge)
+static float gjk_core_radius(const gjk_shape* shape)
 {
-    float dmin = FLT_MAX;
-    for (size_t i = 0; i < size; ++i)
+    return shape->type == GJK_CIRCLE || shape->type == GJK_CAPSULE || shape->type == GJK_ROUNDED ? shape->radius : 0.0f;
+}
+
+uint8_t gjk_closest_points(const gjk_shape* s1, const gjk_shape* s2, float max_distance, gjk_proximity* result)
+{
+    size_t hint1 = GJK_NO_HINT;
+    size_t hint2 = GJK_NO_HINT;
+
+    /* the search runs on the cores, so the radii are added to every bound */
+    float radii = gjk_core_radius(s1) + gjk_core_radius(s2);
+
+    gjk_vec2 d = gjk_sub(s1->center, s2->center);
+    if (d.x == 0.0f && d.y == 0.0f) d.x = 1.0f;
+
+    gjk_simplex_vertex v[3];
+    v[0].a = gjk_core_point(s1, gjk_negate(d), &hint1);
+    v[0].b = gjk_core_point(s2, d, &hint2);
+    v[0].w = gjk_sub(v[0].a, v[0].b);
+    v[0].u = 1.0f;
+    size_t count = 1;
+
+    result->iterations = 0;
+    result->normal = GJK_ORIGIN;
+
+    gjk_vec2 closest = v[0].w;
+    uint8_t early_out = 0;
+    for (size_t iteration = 0; iteration < GJK_MAX_ITERATIONS; ++iteration)
     {
-        size_t j = (i + 1) % size;
+        result->iterations++;
+
+        float dist_sq = gjk_length_Squared(closest);
+        if (dist_sq < FLT_MIN) break;
 
-        gjk_vec2 e = gjk_sub(polytope[j], polytope[i]);
-        gjk_vec2 n = gjk_normalize(gjk_triple_product(e, polytope[i], e));
-        float dist = gjk_dot_product(n, polytope[i]);
-        if (dist < dmin)
+        /* support point of the minkowski difference towards the origin */
+        gjk_simplex_vertex sv;
+        sv.a = gjk_core_point(s1, gjk_negate(closest), &hint1);
+        sv.b = gjk_core_point(s2, closest, &hint2);
+        sv.w = gjk_sub(sv.a, sv.b);
+
+        /* the supporting line through w separates the origin from the cores by at least this */
+        float bound = gjk_dot_product(closest, sv.w);
+        if (bound > 0.0f && bound * bound > dist_sq * (max_distance + radii) * (max_distance + radii))
         {
-            dmin = dist;
-            if (edge)
-            {
-                edge->p = polytope[i];
-                edge->q = polytope[j];
-                edge->n = n;
-                edge->index = j;
-            }
+            early_out = 1;
+            result->distance = bound / sqrtf(dist_sq) - radii;
+            break;
         }
+
+        /* no further progress towards the origin */
+        if (dist_sq - bound <= GJK_DISTANCE_TOLERANCE * dist_sq) break;
+
+        uint8_t duplicate = 0;
+        for (size_t i = 0; i < count; ++i)
+            duplicate |= v[i].w.x == sv.w.x && v[i].w.y == sv.w.y;
+        if (duplicate) break;
+
+        v[count++] = sv;
+        closest = gjk_simplex_closest(v, &count);
+        if (count == 3) break;
     }
 
-    return dmin;
+    /* closest points of the cores from the barycentric weights of the simplex */
+    gjk_vec2 pa = GJK_ORIGIN, pb = GJK_ORIGIN;
+    for (size_t i = 0; i < count; ++i)
+    {
+        pa.x += v[i].u * v[i].a.x;
+        pa.y += v[i].u * v[i].a.y;
+        pb.x += v[i].u * v[i].b.x;
+        pb.y += v[i].u * v[i].b.y;
+    }
+
+    float core = count == 3 ? 0.0f : sqrtf(gjk_length_Squared(closest));
+    if (core > 0.0f)
+        result->normal = (gjk_vec2) { (pb.x - pa.x) / core, (pb.y - pa.y) / core };
+
+    if (!early_out)
+        result->distance = core - radii > 0.0f ? core - radii : 0.0f;
+
+    /* move the points from the cores out to the surfaces */
+    float r1 = gjk_core_radius(s1), r2 = gjk_core_radius(s2);
+    result->point1 = (gjk_vec2) { pa.x + result->normal.x * r1, pa.y + result->normal.y * r1 };
+    result->point2 = (gjk_vec2) { pb.x - result->normal.x * r2, pb.y - result->normal.y * r2 };
+
+    return result->distance > 0.0f;
 }
 
-static void epa_polytope_insert(gjk_vec2* polytope, size_t size, size_t index, gjk_vec2 p)
+float gjk_distance(const gjk_shape* s1, const gjk_shape* s2, gjk_vec2* normal)
 {
-    for (size_t i = size - 1; i > index; i--)
-        polytope[i] = polytope[i - 1];
+    gjk_proximity proximity;
+    if (!gjk_closest_points(s1, s2, FLT_MAX, &proximity)) return 0.0f;
 
-    polytope[index] = p;
+    if (normal) *normal = proximity.normal;
+    return proximity.distance;
 }
 
+/* pairs that are classified and solved at once, the buckets live on the stack */
+#define GJK_BATCH_CHUNK 512
+
+/*
+ * circles and polygons make up most scenes, their four combinations get a
+ * solver with the support functions inlined. Everything else goes through
+ * the generic dispatch like gjk_collision.
+ */
+enum
+{
+    GJK_BATCH_CIRCLE_CIRCLE,
+    GJK_BATCH_CIRCLE_POLY,
+    GJK_BATCH_POLY_CIRCLE,
+    GJK_BATCH_POLY_POLY,
+    GJK_BATCH_GENERIC,
+    GJK_BATCH_CLASSES
+};
+
+/* overlapping pairs of a chunk sorted by class, with the shapes gathered next to the pair index */
+typedef struct
+{
+    const gjk_shape* s1[GJK_BATCH_CHUNK];
+    const gjk_shape* s2[GJK_BATCH_CHUNK];
+    uint32_t index[GJK_BATCH_CHUNK];
+    size_t start[GJK_BATCH_CLASSES + 1];
+} gjk_batch;
+
+MATH_INLINE void gjk_batch_solve(const gjk_batch* batch, size_t c, gjk_support_func f1, gjk_support_func f2, gjk_cache* caches, gjk_result* results)
+{
+    for (size_t i = batch->start[c]; i < batch->start[c + 1]; ++i)
+    {
+        gjk_result* result = &results[batch->index[i]];
+        gjk_cache* cache = caches ? &caches[batch->index[i]] : NULL;
+        result->collision = gjk_solve_overlapping(batch->s1[i], f1, batch->s2[i], f2, cache, result->simplex, NULL);
+    }
+}
+
+void gjk_collide_batch(const gjk_shape* shapes, const gjk_pair* pairs, size_t count, gjk_result* results)
+{
+    gjk_collide_batch_cached(shapes, pairs, NULL, count, results);
+}
+
+void gjk_collide_batch_cached(const gjk_shape* shapes, const gjk_pair* pairs, gjk_cache* caches, size_t count, gjk_result* results)
+{
+    gjk_batch batch;
+    uint16_t survivors[GJK_BATCH_CHUNK];
+    uint8_t classes[GJK_BATCH_CHUNK];
+
+    for (size_t offset = 0; offset < count; offset += GJK_BATCH_CHUNK)
+    {
+        size_t chunk = count - offset < GJK_BATCH_CHUNK ? count - offset : GJK_BATCH_CHUNK;
+
+        /*
+         * reject the pairs with separated bounds in one tight pass and classify
+         * the rest. The test is gjk_bounds_overlap without branches, every pair
+         * is written to the survivors and only the overlapping ones are kept.
+         */
+        size_t sizes[GJK_BATCH_CLASSES] = { 0 };
+        size_t overlapping = 0;
+        for (size_t i = 0; i < chunk; ++i)
+        {
+            const gjk_pair* pair = &pairs[offset + i];
+            const gjk_shape* s1 = &shapes[pair->a];
+            const gjk_shape* s2 = &shapes[pair->b];
+
+            float r = s1->bounding_radius + s2->bounding_radius;
+            gjk_vec2 d = gjk_sub(s2->center, s1->center);
+            uint8_t overlap = (s1->aabb.min.x <= s2->aabb.max.x) & (s2->aabb.min.x <= s1->aabb.max.x)
+                            & (s1->aabb.min.y <= s2->aabb.max.y) & (s2->aabb.min.y <= s1->aabb.max.y)
+                            & (gjk_length_Squared(d) <= r * r);
+
+            uint8_t c = s1->type <= GJK_POLY && s2->type <= GJK_POLY ? (uint8_t)(s1->type * 2 + s2->type) : GJK_BATCH_GENERIC;
+            results[offset + i].collision = 0;
+            survivors[overlapping] = (uint16_t)i;
+            classes[overlapping] = c;
+            overlapping += overlap;
+            sizes[c] += overlap;
+        }
+
+        batch.start[0] = 0;
+        for (size_t c = 0; c < GJK_BATCH_CLASSES; ++c)
+            batch.start[c + 1] = batch.start[c] + sizes[c];
+
+        /* gather the shapes of every class into consecutive runs */
+        size_t next[GJK_BATCH_CLASSES];
+        for (size_t c = 0; c < GJK_BATCH_CLASSES; ++c)
+            next[c] = batch.start[c];
+
+        for (size_t i = 0; i < overlapping; ++i)
+        {
+            size_t k = next[classes[i]]++;
+            const gjk_pair* pair = &pairs[offset + survivors[i]];
+            batch.s1[k] = &shapes[pair->a];
+            batch.s2[k] = &shapes[pair->b];
+            batch.index[k] = (uint32_t)(offset + survivors[i]);
+        }
+
+        gjk_batch_solve(&batch, GJK_BATCH_CIRCLE_CIRCLE, gjk_furthest_point_circle, gjk_furthest_point_circle, caches, results);
+        gjk_batch_solve(&batch, GJK_BATCH_CIRCLE_POLY, gjk_furthest_point_circle, gjk_furthest_point_poly, caches, results);
+        gjk_batch_solve(&batch, GJK_BATCH_POLY_CIRCLE, gjk_furthest_point_poly, gjk_furthest_point_circle, caches, results);
+        gjk_batch_solve(&batch, GJK_BATCH_POLY_POLY, gjk_furthest_point_poly, gjk_furthest_point_poly, caches, results);
+        gjk_batch_solve(&batch, GJK_BATCH_GENERIC, gjk_furthest_point_hint, gjk_furthest_point_hint, caches, results);
+    }
+}
+
+void epa_arena_free(epa_arena* arena)
+{
+    free(arena->edges);
+    arena->edges = NULL;
+    arena->capacity = 0;
+}
+
+/* edges used when no arena is supplied */
+#define EPA_STACK_EDGES 64
+
+#define EPA_MAX_ITERATIONS 128
+
 #define TOLERANCE 0.00001f
 
-float epa(const gjk_shape* s1, const gjk_shape* s2, const gjk_vec2* simplex, gjk_vec2* normal)
+typedef struct
 {
-    gjk_vec2 polytope[32] = { simplex[0], simplex[1], simplex[2] };
-    size_t size = 3;
-    // loop to find the collision information
+    epa_edge* edges;
+    size_t size;
+    size_t capacity;
+    epa_arena* arena;
+} epa_heap;
+
+static uint8_t epa_heap_push(epa_heap* heap, gjk_vec2 p, gjk_vec2 q, float winding)
+{
+    gjk_vec2 e = gjk_sub(q, p);
+    float length = sqrtf(gjk_length_Squared(e));
+    if (length <= 0.0f) return 1; /* degenerate edge, nothing to expand */
+
+    if (heap->size >= heap->capacity)
+    {
+        if (!heap->arena) return 0;
+
+        size_t capacity = heap->capacity * 2;
+        epa_edge* edges = realloc(heap->arena->edges, sizeof(epa_edge) * capacity);
+        if (!edges) return 0;
+
+        heap->arena->edges = heap->edges = edges;
+        heap->arena->capacity = heap->capacity = capacity;
+    }
+
+    /* the outward normal follows from the winding of the polytope */
+    epa_edge edge;
+    edge.p = p;
+    edge.q = q;
+    edge.n.x = winding * e.y / length;
+    edge.n.y = winding * -e.x / length;
+    edge.distance = gjk_dot_product(edge.n, p);
+
+    /* sift up */
+    size_t i = heap->size++;
+    while (i > 0)
+    {
+        size_t parent = (i - 1) / 2;
+        if (heap->edges[parent].distance <= edge.distance) break;
+        heap->edges[i] = heap->edges[parent];
+        i = parent;
+    }
+    heap->edges[i] = edge;
+    return 1;
+}
+
+static void epa_heap_pop(epa_heap* heap)
+{
+    epa_edge last = heap->edges[--heap->size];
+
+    /* sift down */
+    size_t i = 0;
     while (1)
     {
-        if (size >= 32) return -1.0f;
+        size_t child = 2 * i + 1;
+        if (child >= heap->size) break;
+        if (child + 1 < heap->size && heap->edges[child + 1].distance < heap->edges[child].distance) child++;
+        if (last.distance <= heap->edges[child].distance) break;
+        heap->edges[i] = heap->edges[child];
+        i = child;
+    }
+    heap->edges[i] = last;
+}
+
+static float epa_solve(const gjk_shape* s1, const gjk_shape* s2, const gjk_vec2* simplex, gjk_vec2* normal, epa_arena* arena, uint32_t* expansions, uint8_t* capped)
+{
+    *expansions = 0;
+    *capped = 0;
+
+    epa_edge stack[EPA_STACK_EDGES];
+    epa_heap heap = { stack, 0, EPA_STACK_EDGES, arena };
+
+    if (arena)
+    {
+        if (arena->capacity < EPA_STACK_EDGES)
+        {
+            epa_edge* edges = realloc(arena->edges, sizeof(epa_edge) * EPA_STACK_EDGES);
+            if (!edges) return -1.0f;
+
+            arena->edges = edges;
+            arena->capacity = EPA_STACK_EDGES;
+        }
+        heap.edges = arena->edges;
+        heap.capacity = arena->capacity;
+    }
+
+    /* the edges of the polytope are kept in a min heap ordered by distance */
+    gjk_vec2 ab = gjk_sub(simplex[1], simplex[0]);
+    gjk_vec2 ac = gjk_sub(simplex[2], simplex[0]);
+    float winding = ab.x * ac.y - ab.y * ac.x < 0.0f ? -1.0f : 1.0f;
+
+    epa_heap_push(&heap, simplex[0], simplex[1], winding);
+    epa_heap_push(&heap, simplex[1], simplex[2], winding);
+    epa_heap_push(&heap, simplex[2], simplex[0], winding);
+    if (heap.size == 0) return -1.0f;
+
+    size_t hint1 = GJK_NO_HINT;
+    size_t hint2 = GJK_NO_HINT;
+
+    for (size_t iteration = 0; iteration < EPA_MAX_ITERATIONS; ++iteration)
+    {
         // obtain the feature (edge for 2D) closest to the 
         // origin on the Minkowski Difference
-        epa_edge e;
-        float edge_dist = epa_closest_edge(polytope, size, &e);
+        epa_edge e = heap.edges[0];
+
         // obtain a new support point in the direction of the edge normal
+        gjk_vec2 p = gjk_sub(gjk_furthest_point_hint(s1, e.n, &hint1), gjk_furthest_point_hint(s2, gjk_negate(e.n), &hint2));
 
-        gjk_vec2 p = gjk_minkowski_difference(s1, s2, e.n);
         // check the distance from the origin to the edge against the
         // distance p is along e.normal
         float dist = gjk_dot_product(p, e.n);
-
-        if (dist - edge_dist < TOLERANCE)
+        if (dist - e.distance < TOLERANCE)
         {
-            // the tolerance should be something positive close to zero (ex. 0.00001)
-
             // if the difference is less than the tolerance then we can
-            // assume that we cannot expand the simplex any further and
+            // assume that we cannot expand the polytope any further and
             // we have our solution
             *normal = e.n;
             return dist;
         }
-        else
+
+        // we haven't reached the edge of the Minkowski Difference
+        // so continue expanding by replacing the closest edge with
+        // the two edges to the new point
+        (*expansions)++;
+        epa_heap_pop(&heap);
+        if (!epa_heap_push(&heap, e.p, p, winding) || !epa_heap_push(&heap, p, e.q, winding))
+        {
+            /* out of scratch memory, the closest edge is the best estimate */
+            *capped = 1;
+            *normal = e.n;
+            return e.distance;
+        }
+    }
+
+    *capped = 1;
+    *normal = heap.edges[0].n;
+    return heap.edges[0].distance;
+}
+
+float epa(const gjk_shape* s1, const gjk_shape* s2, const gjk_vec2* simplex, gjk_vec2* normal, epa_arena* arena, uint8_t* converged)
+{
+    uint32_t expansions;
+    uint8_t capped;
+    float depth = epa_solve(s1, s2, simplex, normal, arena, &expansions, &capped);
+    if (converged) *converged = !capped;
+    return depth;
+}
+
+float epa_stats(const gjk_shape* s1, const gjk_shape* s2, const gjk_vec2* simplex, gjk_vec2* normal, epa_arena* arena, gjk_stats* stats)
+{
+    return epa_solve(s1, s2, simplex, normal, arena, &stats->expansions, &stats->capped);
+}
+
+// ---------------| INTERSECT |--------------------------
+typedef uint8_t (*gjk_intersect_func)(const gjk_shape* s1, const gjk_shape* s2, gjk_penetration* penetration);
+
+static uint8_t gjk_intersect_general(const gjk_shape* s1, const gjk_shape* s2, gjk_penetration* penetration)
+{
+    gjk_vec2 simplex[3];
+    if (!gjk_collision(s1, s2, simplex)) return 0;
+
+    penetration->depth = epa(s1, s2, simplex, &penetration->normal, NULL, NULL);
+    return penetration->depth >= 0.0f;
+}
+
+/* overlap of the point p with a circle of the given radius around the origin */
+static uint8_t gjk_intersect_point(gjk_vec2 p, float radius, gjk_penetration* penetration)
+{
+    float dist_sq = gjk_length_Squared(p);
+    if (dist_sq > radius * radius) return 0;
+
+    float dist = sqrtf(dist_sq);
+    penetration->normal = dist > 0.0f ? (gjk_vec2) { p.x / dist, p.y / dist } : (gjk_vec2) { 1.0f, 0.0f };
+    penetration->depth = radius - dist;
+    return 1;
+}
+
+static uint8_t gjk_intersect_circle_circle(const gjk_shape* s1, const gjk_shape* s2, gjk_penetration* penetration)
+{
+    return gjk_intersect_point(gjk_sub(s2->center, s1->center), s1->radius + s2->radius, penetration);
+}
+
+/*
+ * closest feature of a convex polygon to the circle center in the local
+ * space of the polygon: the edge of maximum separation if the center is
+ * inside or in front of the edge, otherwise one of its vertices.
+ */
+static uint8_t gjk_intersect_poly_circle(const gjk_shape* s1, const gjk_shape* s2, gjk_penetration* penetration)
+{
+    if (s1->hill_climb) return gjk_intersect_general(s1, s2, penetration);
+
+    const gjk_vec2* v = s1->vertices;
+    size_t count = s1->count;
+    float radius = s1->radius + s2->radius;
+    gjk_vec2 p = gjk_add(gjk_inv_rotate(s1->rot, gjk_sub(s2->center, s1->center)), s1->centroid);
+
+    float separation = -FLT_MAX;
+    size_t edge = 0;
+    gjk_vec2 normal = { 0.0f, 0.0f };
+    for (size_t i = 0; i < count; ++i)
+    {
+        gjk_vec2 e = gjk_sub(v[(i + 1) % count], v[i]);
+        gjk_vec2 n = gjk_normalize(s1->winding > 0 ? (gjk_vec2) { e.y, -e.x } : (gjk_vec2) { -e.y, e.x });
+
+        float s = gjk_dot_product(n, gjk_sub(p, v[i]));
+        if (s > radius) return 0;
+        if (s > separation)
+        {
+            separation = s;
+            edge = i;
+            normal = n;
+        }
+    }
+
+    gjk_vec2 v1 = v[edge];
+    gjk_vec2 v2 = v[(edge + 1) % count];
+
+    /* the center lies in the voronoi region of a vertex */
+    if (separation > 0.0f)
+    {
+        gjk_vec2 corner = { 0.0f, 0.0f };
+        uint8_t vertex = 0;
+        if (gjk_dot_product(gjk_sub(p, v1), gjk_sub(v2, v1)) <= 0.0f)      { corner = v1; vertex = 1; }
+        else if (gjk_dot_product(gjk_sub(p, v2), gjk_sub(v1, v2)) <= 0.0f) { corner = v2; vertex = 1; }
+
+        if (vertex)
+        {
+            if (!gjk_intersect_point(gjk_sub(p, corner), radius, penetration)) return 0;
+            penetration->normal = gjk_rotate(s1->rot, penetration->normal);
+            return 1;
+        }
+    }
+
+    penetration->normal = gjk_rotate(s1->rot, normal);
+    penetration->depth = radius - separation;
+    return 1;
+}
+
+static uint8_t gjk_intersect_box_circle(const gjk_shape* s1, const gjk_shape* s2, gjk_penetration* penetration)
+{
+    gjk_vec2 p = gjk_inv_rotate(s1->rot, gjk_sub(s2->center, s1->center));
+    gjk_vec2 e = s1->extents;
+
+    /* closest point on the box */
+    gjk_vec2 q = {
+        p.x < -e.x ? -e.x : (p.x > e.x ? e.x : p.x),
+        p.y < -e.y ? -e.y : (p.y > e.y ? e.y : p.y)
+    };
+
+    if (q.x != p.x || q.y != p.y)
+    {
+        if (!gjk_intersect_point(gjk_sub(p, q), s2->radius, penetration)) return 0;
+        penetration->normal = gjk_rotate(s1->rot, penetration->normal);
+        return 1;
+    }
+
+    /* the center is inside, push out through the closest face */
+    float dx = e.x - fabsf(p.x);
+    float dy = e.y - fabsf(p.y);
+    gjk_vec2 n = dx < dy ? (gjk_vec2) { p.x < 0.0f ? -1.0f : 1.0f, 0.0f } : (gjk_vec2) { 0.0f, p.y < 0.0f ? -1.0f : 1.0f };
+
+    penetration->normal = gjk_rotate(s1->rot, n);
+    penetration->depth = (dx < dy ? dx : dy) + s2->radius;
+    return 1;
+}
+
+/* capsules and segments against circles are circles against the closest point on the core segment */
+static uint8_t gjk_intersect_capsule_circle(const gjk_shape* s1, const gjk_shape* s2, gjk_penetration* penetration)
+{
+    gjk_vec2 axis = { s1->rot.c, s1->rot.s };
+    gjk_vec2 d = gjk_sub(s2->center, s1->center);
+
+    float t = gjk_dot_product(d, axis);
+    if (t < -s1->half_length) t = -s1->half_length;
+    if (t > s1->half_length)  t = s1->half_length;
+
+    gjk_vec2 p = { d.x - axis.x * t, d.y - axis.y * t };
+    if (!gjk_intersect_point(p, s1->radius + s2->radius, penetration)) return 0;
+
+    /* the center lies on the core segment, push out to the side */
+    if (p.x == 0.0f && p.y == 0.0f) penetration->normal = (gjk_vec2) { -axis.y, axis.x };
+    return 1;
+}
+
+/*
+ * capsules and segments against boxes in the local space of the box. While the
+ * core segment overlaps the box the separating axes are the box faces and the
+ * segment normal, once it is apart the closest points are an endpoint of the
+ * segment and the box or a corner of the box and the segment.
+ */
+static uint8_t gjk_intersect_capsule_box(const gjk_shape* s1, const gjk_shape* s2, gjk_penetration* penetration)
+{
+    gjk_vec2 c = gjk_inv_rotate(s2->rot, gjk_sub(s1->center, s2->center));
+    gjk_vec2 axis = gjk_inv_rotate(s2->rot, (gjk_vec2) { s1->rot.c, s1->rot.s });
+    gjk_vec2 h = { axis.x * s1->half_length, axis.y * s1->half_length };
+    gjk_vec2 e = s2->extents;
+
+    gjk_vec2 axes[3] = { { 1.0f, 0.0f }, { 0.0f, 1.0f }, { -axis.y, axis.x } };
+
+    float depth = FLT_MAX;
+    gjk_vec2 normal = { 1.0f, 0.0f };
+    for (int i = 0; i < 3; ++i)
+    {
+        gjk_vec2 a = axes[i];
+        float r1 = fabsf(gjk_dot_product(a, h));
+        float r2 = e.x * fabsf(a.x) + e.y * fabsf(a.y);
+        float dist = -gjk_dot_product(a, c);
+
+        float overlap = r1 + r2 - fabsf(dist);
+        if (overlap < 0.0f)
+        {
+            depth = -1.0f;
+            break;
+        }
+        if (overlap < depth)
+        {
+            depth = overlap;
+            normal = dist < 0.0f ? gjk_negate(a) : a;
+        }
+    }
+
+    if (depth >= 0.0f)
+    {
+        penetration->normal = gjk_rotate(s2->rot, normal);
+        penetration->depth = depth + s1->radius;
+        return 1;
+    }
+
+    /* p on the segment, q on the box */
+    gjk_vec2 p = { 0.0f, 0.0f }, q = { 0.0f, 0.0f };
+    float dist_sq = FLT_MAX;
+    for (int i = 0; i < 2; ++i)
+    {
+        gjk_vec2 end = i ? gjk_add(c, h) : gjk_sub(c, h);
+        gjk_vec2 box = {
+            end.x < -e.x ? -e.x : (end.x > e.x ? e.x : end.x),
+            end.y < -e.y ? -e.y : (end.y > e.y ? e.y : end.y)
+        };
+
+        float d = gjk_length_Squared(gjk_sub(box, end));
+        if (d < dist_sq) { dist_sq = d; p = end; q = box; }
+    }
+
+    for (int i = 0; i < 4; ++i)
+    {
+        gjk_vec2 corner = { i & 1 ? e.x : -e.x, i & 2 ? e.y : -e.y };
+        float t = gjk_dot_product(gjk_sub(corner, c), axis);
+        if (t < -s1->half_length) t = -s1->half_length;
+        if (t > s1->half_length)  t = s1->half_length;
+
+        gjk_vec2 seg = { c.x + axis.x * t, c.y + axis.y * t };
+        float d = gjk_length_Squared(gjk_sub(corner, seg));
+        if (d < dist_sq) { dist_sq = d; p = seg; q = corner; }
+    }
+
+    if (!gjk_intersect_point(gjk_sub(q, p), s1->radius, penetration)) return 0;
+    penetration->normal = gjk_rotate(s2->rot, penetration->normal);
+    return 1;
+}
+
+/* separating axis test over the face normals of both boxes */
+static uint8_t gjk_intersect_box_box(const gjk_shape* s1, const gjk_shape* s2, gjk_penetration* penetration)
+{
+    gjk_vec2 d = gjk_sub(s2->center, s1->center);
+    gjk_vec2 axes[4] = {
+        {  s1->rot.c, s1->rot.s }, { -s1->rot.s, s1->rot.c },
+        {  s2->rot.c, s2->rot.s }, { -s2->rot.s, s2->rot.c }
+    };
+
+    float depth = FLT_MAX;
+    gjk_vec2 normal = { 1.0f, 0.0f };
+    for (int i = 0; i < 4; ++i)
+    {
+        gjk_vec2 a = axes[i];
+        float r1 = s1->extents.x * fabsf(gjk_dot_product(a, axes[0])) + s1->extents.y * fabsf(gjk_dot_product(a, axes[1]));
+        float r2 = s2->extents.x * fabsf(gjk_dot_product(a, axes[2])) + s2->extents.y * fabsf(gjk_dot_product(a, axes[3]));
+        float dist = gjk_dot_product(a, d);
+
+        float overlap = r1 + r2 - fabsf(dist);
+        if (overlap < 0.0f) return 0;
+        if (overlap < depth)
         {
-            epa_polytope_insert(polytope, ++size, e.index, p);
-            // we haven't reached the edge of the Minkowski Difference
-            // so continue expanding by adding the new point to the simplex
-            // in between the points that made the closest edge
+            depth = overlap;
+            normal = dist < 0.0f ? gjk_negate(a) : a;
         }
     }
-    return 0.0f;
+
+    penetration->normal = normal;
+    penetration->depth = depth;
+    return 1;
 }
 
-gjk_vec2 gjk_add(gjk_vec2 a, gjk_vec2 b)      { a.x += b.x; a.y += b.y; return a; }
-gjk_vec2 gjk_sub(gjk_vec2 a, gjk_vec2 b)      { a.x -= b.x; a.y -= b.y; return a; }
-gjk_vec2 gjk_negate(gjk_vec2 v)               { v.x = -v.x; v.y = -v.y; return v; }
-gjk_vec2 gjk_normalize(gjk_vec2 a)            { float n = sqrtf(a.x * a.x + a.y * a.y); return (gjk_vec2) { a.x / n, a.y / n }; }
-gjk_vec2 gjk_perpendicular(gjk_vec2 v)        { return (gjk_vec2) { v.y, -v.x }; }
-float gjk_dot_product(gjk_vec2 a, gjk_vec2 b) { return a.x * b.x + a.y * b.y; }
-float gjk_length_Squared(gjk_vec2 v)          { return v.x * v.x + v.y * v.y; }
+/* the flipped versions run the test with swapped shapes and turn the normal around */
+#define GJK_FLIPPED(name) \
+    static uint8_t name##_flipped(const gjk_shape* s1, const gjk_shape* s2, gjk_penetration* penetration) \
+    { \
+        if (!name(s2, s1, penetration)) return 0; \
+        penetration->normal = gjk_negate(penetration->normal); \
+        return 1; \
+    }
+
+GJK_FLIPPED(gjk_intersect_poly_circle)
+GJK_FLIPPED(gjk_intersect_box_circle)
+GJK_FLIPPED(gjk_intersect_capsule_circle)
+GJK_FLIPPED(gjk_intersect_capsule_box)
+
+#undef GJK_FLIPPED
 
-gjk_vec2 gjk_triple_product(gjk_vec2 a, gjk_vec2 b, gjk_vec2 c)
+/* closed form tests by shape type combination, NULL entries use gjk and epa */
+static const gjk_intersect_func gjk_intersect_funcs[GJK_SHAPE_COUNT][GJK_SHAPE_COUNT] = {
+    [GJK_CIRCLE][GJK_CIRCLE]  = gjk_intersect_circle_circle,
+    [GJK_CIRCLE][GJK_POLY]    = gjk_intersect_poly_circle_flipped,
+    [GJK_CIRCLE][GJK_ROUNDED] = gjk_intersect_poly_circle_flipped,
+    [GJK_CIRCLE][GJK_BOX]     = gjk_intersect_box_circle_flipped,
+    [GJK_CIRCLE][GJK_SEGMENT] = gjk_intersect_capsule_circle_flipped,
+    [GJK_CIRCLE][GJK_CAPSULE] = gjk_intersect_capsule_circle_flipped,
+    [GJK_POLY][GJK_CIRCLE]    = gjk_intersect_poly_circle,
+    [GJK_ROUNDED][GJK_CIRCLE] = gjk_intersect_poly_circle,
+    [GJK_BOX][GJK_CIRCLE]     = gjk_intersect_box_circle,
+    [GJK_SEGMENT][GJK_CIRCLE] = gjk_intersect_capsule_circle,
+    [GJK_CAPSULE][GJK_CIRCLE] = gjk_intersect_capsule_circle,
+    [GJK_BOX][GJK_BOX]        = gjk_intersect_box_box,
+    [GJK_BOX][GJK_SEGMENT]    = gjk_intersect_capsule_box_flipped,
+    [GJK_BOX][GJK_CAPSULE]    = gjk_intersect_capsule_box_flipped,
+    [GJK_SEGMENT][GJK_BOX]    = gjk_intersect_capsule_box,
+    [GJK_CAPSULE][GJK_BOX]    = gjk_intersect_capsule_box,
+};
+
+uint8_t gjk_intersect(const gjk_shape* s1, const gjk_shape* s2, gjk_penetration* penetration)
 {
-    float ac = a.x * c.x + a.y * c.y; // perform a dot c
-    float bc = b.x * c.x + b.y * c.y; // perform b dot c
+    gjk_intersect_func func = gjk_intersect_funcs[s1->type][s2->type];
+    return func ? func(s1, s2, penetration) : gjk_intersect_general(s1, s2, penetration);
+}
 
-    // perform b * (a dot c) - a * (b dot c)
-    gjk_vec2 result;
-    result.x = b.x * ac - a.x * bc;
-    result.y = b.y * ac - a.y * bc;
-    return result;
+gjk_rot gjk_rotation(float angle)
+{
+    gjk_rot r = { cosf(angle), sinf(angle) };
+    return r;
 }
 
-gjk_vec2 gjk_get_centroid(gjk_vec2* vertices, size_t count)
+gjk_vec2 gjk_get_centroid(const gjk_vec2* vertices, size_t count)
 {
     float det = 0;
-    gjk_vec2 centroid = { 0.0f };
+    gjk_vec2 centroid = { 0.0f, 0.0f };
 
     for (size_t i = 0; i < count; ++i)
     {
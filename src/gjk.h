@@ -2,62 +2,302 @@
 #define GJK_H
 
 #include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+#include "math/inline.h"
 
 typedef struct
 {
     float x, y;
 } gjk_vec2;
 
-gjk_vec2 gjk_add(gjk_vec2 a, gjk_vec2 b);
-gjk_vec2 gjk_sub(gjk_vec2 a, gjk_vec2 b);
-gjk_vec2 gjk_negate(gjk_vec2 v);
-gjk_vec2 gjk_normalize(gjk_vec2 a);
-gjk_vec2 gjk_perpendicular(gjk_vec2 v);
-float gjk_dot_product(gjk_vec2 a, gjk_vec2 b);
-float gjk_length_Squared(gjk_vec2 v);
+/* the vector helpers run in the inner loops of gjk and epa, they are inlined */
+MATH_INLINE gjk_vec2 gjk_add(gjk_vec2 a, gjk_vec2 b)      { a.x += b.x; a.y += b.y; return a; }
+MATH_INLINE gjk_vec2 gjk_sub(gjk_vec2 a, gjk_vec2 b)      { a.x -= b.x; a.y -= b.y; return a; }
+MATH_INLINE gjk_vec2 gjk_negate(gjk_vec2 v)               { v.x = -v.x; v.y = -v.y; return v; }
+MATH_INLINE gjk_vec2 gjk_normalize(gjk_vec2 a)            { float n = sqrtf(a.x * a.x + a.y * a.y); return (gjk_vec2) { a.x / n, a.y / n }; }
+MATH_INLINE gjk_vec2 gjk_perpendicular(gjk_vec2 v)        { return (gjk_vec2) { v.y, -v.x }; }
+MATH_INLINE float gjk_dot_product(gjk_vec2 a, gjk_vec2 b) { return a.x * b.x + a.y * b.y; }
+MATH_INLINE float gjk_length_Squared(gjk_vec2 v)          { return v.x * v.x + v.y * v.y; }
+
+/* b * (a dot c) - a * (b dot c) */
+MATH_INLINE gjk_vec2 gjk_triple_product(gjk_vec2 a, gjk_vec2 b, gjk_vec2 c)
+{
+    float ac = a.x * c.x + a.y * c.y;
+    float bc = b.x * c.x + b.y * c.y;
+    return (gjk_vec2) { b.x * ac - a.x * bc, b.y * ac - a.y * bc };
+}
+
+gjk_vec2 gjk_get_centroid(const gjk_vec2* vertices, size_t count);
+
+typedef struct
+{
+    float c, s; /* cosine and sine of the angle */
+} gjk_rot;
+
+gjk_rot gjk_rotation(float angle);
 
-gjk_vec2 gjk_triple_product(gjk_vec2 a, gjk_vec2 b, gjk_vec2 c);
-gjk_vec2 gjk_get_centroid(gjk_vec2* vertices, size_t count);
+MATH_INLINE gjk_vec2 gjk_rotate(gjk_rot r, gjk_vec2 v)     { return (gjk_vec2) { r.c * v.x - r.s * v.y, r.s * v.x + r.c * v.y }; }
+MATH_INLINE gjk_vec2 gjk_inv_rotate(gjk_rot r, gjk_vec2 v) { return (gjk_vec2) { r.c * v.x + r.s * v.y, r.c * v.y - r.s * v.x }; }
+
+typedef struct
+{
+    gjk_vec2 min, max;
+} gjk_aabb;
 
 typedef enum
 {
     GJK_CIRCLE,
-    GJK_POLY
+    GJK_POLY,
+    GJK_SEGMENT,
+    GJK_CAPSULE,
+    GJK_BOX,
+    GJK_ELLIPSE,
+    GJK_ROUNDED,    /* polygon with a radius */
+    GJK_SHAPE_COUNT
 } gjk_shape_type;
 
+/*
+ * All shapes are defined in local space and placed by the center and the
+ * rotation. Polygons keep their vertices in local space, so moving or
+ * rotating a shape never touches the vertices and copies of a shape share
+ * the same vertex array.
+ * Segments and capsules lie along the local x axis, boxes and ellipses are
+ * aligned to the local axes. Everything but polygons has a closed form
+ * support function, so the cost of a query does not depend on the roundness.
+ * Every shape caches its world space aabb and the radius of a circle around
+ * the center that contains it. The constructors and setters keep both up to
+ * date in O(1), polygons are bounded by their rotated local aabb instead of
+ * their vertices. After changing fields directly call gjk_update_bounds.
+ */
 typedef struct
 {
     gjk_shape_type type;
     gjk_vec2 center;
+    gjk_rot rot;
+    float radius; /* circle, capsule and rounded polygon */
+    gjk_aabb aabb;
+    float bounding_radius;
     union
     {
-        float radius;
+        float half_length; /* segment and capsule */
+        gjk_vec2 extents;  /* half size of a box, semi axes of an ellipse */
         struct
         {
-            gjk_vec2* vertices;
+            const gjk_vec2* vertices;
+            const float* soa;   /* optional copy of the vertices, see gjk_poly_soa */
             size_t count;
+            gjk_vec2 centroid;  /* local point that is placed at center */
+            gjk_aabb local_aabb; /* of the vertices relative to the centroid, see gjk_update_bounds */
+            uint8_t hill_climb; /* set by gjk_poly for large convex polygons */
+            int8_t winding;     /* 1 for counter-clockwise, -1 for clockwise vertices */
         };
     };
 } gjk_shape;
 
 void gjk_circle(gjk_shape* shape, gjk_vec2 center, float radius);
-void gjk_poly(gjk_shape* shape, gjk_vec2* vertices, size_t count);
+void gjk_segment(gjk_shape* shape, gjk_vec2 a, gjk_vec2 b);
+void gjk_capsule(gjk_shape* shape, gjk_vec2 a, gjk_vec2 b, float radius);
+void gjk_box(gjk_shape* shape, gjk_vec2 center, gjk_vec2 extents);
+void gjk_ellipse(gjk_shape* shape, gjk_vec2 center, gjk_vec2 radii);
+
+/* the shape starts out at the position of the vertices, centered at their centroid */
+void gjk_poly(gjk_shape* shape, const gjk_vec2* vertices, size_t count);
+void gjk_rounded(gjk_shape* shape, const gjk_vec2* vertices, size_t count, float radius);
+
+/*
+ * fills buffer (2 * count floats) with the x values of the vertices followed
+ * by the y values and lets the support function scan it with simd kernels.
+ * Like the vertices the buffer can be shared by all copies of the shape.
+ */
+void gjk_poly_soa(gjk_shape* shape, float* buffer);
 
 void gjk_set_center(gjk_shape* shape, gjk_vec2 center);
+void gjk_set_rotation(gjk_shape* shape, float angle); /* angle in radians */
+void gjk_set_transform(gjk_shape* shape, gjk_vec2 center, gjk_rot rot);
+
+/* recomputes the cached aabb and bounding radius */
+void gjk_update_bounds(gjk_shape* shape);
+
+/* world position of a vertex of a polygon or rounded polygon */
+gjk_vec2 gjk_get_vertex(const gjk_shape* shape, size_t index);
+
+/* the cached aabb */
+gjk_aabb gjk_shape_aabb(const gjk_shape* shape);
+
+/*
+ * cheap rejection test on the cached bounds, 0 means the shapes are
+ * separated. gjk_collision runs it before the first support query.
+ */
+uint8_t gjk_bounds_overlap(const gjk_shape* s1, const gjk_shape* s2);
+
+/* inlined, the broadphases call them for every node they touch */
+MATH_INLINE uint8_t gjk_aabb_overlap(gjk_aabb a, gjk_aabb b)
+{
+    return a.min.x <= b.max.x && a.max.x >= b.min.x && a.min.y <= b.max.y && a.max.y >= b.min.y;
+}
+
+/* is b inside a */
+MATH_INLINE uint8_t gjk_aabb_contains(gjk_aabb a, gjk_aabb b)
+{
+    return a.min.x <= b.min.x && a.min.y <= b.min.y && b.max.x <= a.max.x && b.max.y <= a.max.y;
+}
+
+MATH_INLINE gjk_aabb gjk_aabb_union(gjk_aabb a, gjk_aabb b)
+{
+    gjk_aabb result = {
+        { a.min.x < b.min.x ? a.min.x : b.min.x, a.min.y < b.min.y ? a.min.y : b.min.y },
+        { a.max.x > b.max.x ? a.max.x : b.max.x, a.max.y > b.max.y ? a.max.y : b.max.y }
+    };
+    return result;
+}
+
+MATH_INLINE float gjk_aabb_perimeter(gjk_aabb a)
+{
+    return 2.0f * ((a.max.x - a.min.x) + (a.max.y - a.min.y));
+}
+
+/* polygons with at least this many vertices use hill climbing for support queries */
+#define GJK_HILL_CLIMB_THRESHOLD 64
+
+#define GJK_NO_HINT ((size_t)-1)
 
 gjk_vec2 gjk_furthest_point(const gjk_shape* shape, gjk_vec2 d);
+
+/* 
+ * hint holds the index of the last support vertex and is updated with the new
+ * one. Large polygons climb from there instead of scanning all vertices.
+ * Initialize it with GJK_NO_HINT.
+ */
+gjk_vec2 gjk_furthest_point_hint(const gjk_shape* shape, gjk_vec2 d, size_t* hint);
 gjk_vec2 gjk_minkowski_difference(const gjk_shape* s1, const gjk_shape* s2, gjk_vec2 d);
 uint8_t gjk_collision(const gjk_shape* s1, const gjk_shape* s2, gjk_vec2* simplex_ptr);
 
+/*
+ * work done by the last query, filled by gjk_collision_stats and epa_stats.
+ * Both behave exactly like gjk_collision and epa and exist for benchmarks.
+ */
+typedef struct
+{
+    uint32_t iterations; /* support queries of gjk, 0 if the bounds rejected the pair */
+    uint32_t expansions; /* points epa added to the polytope */
+    uint8_t capped;      /* epa stopped at its iteration cap or out of memory, the depth is only an estimate */
+} gjk_stats;
+
+uint8_t gjk_collision_stats(const gjk_shape* s1, const gjk_shape* s2, gjk_vec2* simplex_ptr, gjk_stats* stats);
+
+typedef struct
+{
+    gjk_vec2 point1;     /* closest point on the surface of s1 */
+    gjk_vec2 point2;     /* closest point on the surface of s2 */
+    gjk_vec2 normal;     /* from point1 towards point2 */
+    float distance;      /* 0 if the shapes overlap */
+    uint32_t iterations;
+} gjk_proximity;
+
+/*
+ * distance and closest points of two separated shapes. The search runs on
+ * the cores of round shapes (the center of a circle, the segment of a capsule)
+ * and adds the radii afterwards.
+ * Stops as soon as the shapes are proven to be further apart than max_distance,
+ * distance is then a lower bound and the points are not the closest ones.
+ * Pass FLT_MAX for an exact result. Returns 1 if the shapes are separated.
+ */
+uint8_t gjk_closest_points(const gjk_shape* s1, const gjk_shape* s2, float max_distance, gjk_proximity* result);
+
+/*
+ * distance between the surfaces of two shapes, 0 if they overlap. Writes the
+ * direction from s1 towards s2 to normal if the shapes are separated.
+ */
+float gjk_distance(const gjk_shape* s1, const gjk_shape* s2, gjk_vec2* normal);
+
+/*
+ * persistent per pair state for warm starting gjk. Holds the search directions
+ * of the last simplex or the last separating direction and the support hints.
+ * Treat as opaque and initialize with gjk_cache_reset.
+ */
+typedef struct
+{
+    gjk_vec2 directions[3];
+    size_t hints[2];
+    uint8_t count;
+} gjk_cache;
+
+void gjk_cache_reset(gjk_cache* cache);
+
+/* like gjk_collision, but starts the search from the result stored in cache */
+uint8_t gjk_collision_cached(const gjk_shape* s1, const gjk_shape* s2, gjk_cache* cache, gjk_vec2* simplex_ptr);
+
+typedef struct
+{
+    uint32_t a, b; /* indices into the shape array */
+} gjk_pair;
+
+typedef struct
+{
+    gjk_vec2 simplex[3];
+    uint8_t collision;
+} gjk_result;
+
+/* 
+ * runs gjk_collision for every pair and writes the result to results[i].
+ * The bounds of all pairs are tested in one pass first, the overlapping pairs
+ * are grouped by their shape type combination and circles and polygons run
+ * with their support functions inlined.
+ */
+void gjk_collide_batch(const gjk_shape* shapes, const gjk_pair* pairs, size_t count, gjk_result* results);
+
+/* caches[i] belongs to pairs[i] */
+void gjk_collide_batch_cached(const gjk_shape* shapes, const gjk_pair* pairs, gjk_cache* caches, size_t count, gjk_result* results);
+
 typedef struct
 {
     gjk_vec2 p;
     gjk_vec2 q;
-    gjk_vec2 n;
-    size_t index;
+    gjk_vec2 n;     /* outward normal */
+    float distance; /* distance of the edge to the origin */
 } epa_edge;
 
-float epa_closest_edge(gjk_vec2* polytope, size_t size, epa_edge* e);
-float epa(const gjk_shape* s1, const gjk_shape* s2, const gjk_vec2* simplex, gjk_vec2* n);
+/*
+ * scratch memory for the polytope of epa. It is grown on demand and can be
+ * reused for any number of calls. Zero initialize and free with epa_arena_free.
+ */
+typedef struct
+{
+    epa_edge* edges;
+    size_t capacity;
+} epa_arena;
+
+void epa_arena_free(epa_arena* arena);
+
+/*
+ * returns the penetration depth and writes the penetration normal to n.
+ * Without an arena the polytope is limited to a small buffer on the stack.
+ * When the buffer or EPA_MAX_ITERATIONS runs out the closest edge found so
+ * far is returned and converged is set to 0: the depth is a lower bound and
+ * the normal an estimate. converged can be NULL.
+ */
+float epa(const gjk_shape* s1, const gjk_shape* s2, const gjk_vec2* simplex, gjk_vec2* n, epa_arena* arena, uint8_t* converged);
+float epa_stats(const gjk_shape* s1, const gjk_shape* s2, const gjk_vec2* simplex, gjk_vec2* n, epa_arena* arena, gjk_stats* stats);
+
+/*
+ * penetration of two overlapping shapes. The normal points from s1 towards s2,
+ * moving s1 by -normal * depth separates the shapes.
+ */
+typedef struct
+{
+    gjk_vec2 normal;
+    float depth;
+} gjk_penetration;
+
+/*
+ * tests two shapes for overlap and computes the penetration like gjk_collision
+ * followed by epa. The shape type combination selects a closed form test
+ * where there is one (circles against circles, polygons, boxes and capsules,
+ * boxes against boxes and capsules) and falls back to gjk and epa for all
+ * others. Segments count as capsules without radius.
+ */
+uint8_t gjk_intersect(const gjk_shape* s1, const gjk_shape* s2, gjk_penetration* penetration);
 
 #endif // !GJK_H
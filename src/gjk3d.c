@@ -0,0 +1,567 @@
+#include "gjk3d.h"
+
+#include <float.h>
+#include <math.h>
+
+static float gjk3d_length_squared(vec3 v) { return vec3_dot(v, v); }
+
+static vec3 gjk3d_safe_normalize(vec3 v)
+{
+    float l = gjk3d_length_squared(v);
+    return l > 0.0f ? vec3_mult(v, 1.0f / sqrtf(l)) : (vec3) { 1.0f, 0.0f, 0.0f };
+}
+
+/* some unit vector perpendicular to v */
+static vec3 gjk3d_perpendicular(vec3 v)
+{
+    vec3 axis = fabsf(v.x) < 0.57735f ? (vec3) { 1.0f, 0.0f, 0.0f } : (vec3) { 0.0f, 1.0f, 0.0f };
+    return gjk3d_safe_normalize(vec3_cross(v, axis));
+}
+
+gjk3d_rot gjk3d_rotation(vec3 axis, float angle)
+{
+    vec3 k = gjk3d_safe_normalize(axis);
+    float c = cosf(angle), s = sinf(angle), t = 1.0f - c;
+
+    gjk3d_rot r;
+    r.x = (vec3) { c + t * k.x * k.x,       t * k.x * k.y + s * k.z, t * k.x * k.z - s * k.y };
+    r.y = (vec3) { t * k.x * k.y - s * k.z, c + t * k.y * k.y,       t * k.y * k.z + s * k.x };
+    r.z = (vec3) { t * k.x * k.z + s * k.y, t * k.y * k.z - s * k.x, c + t * k.z * k.z };
+    return r;
+}
+
+gjk3d_rot gjk3d_rot_multiply(gjk3d_rot a, gjk3d_rot b)
+{
+    return (gjk3d_rot) { gjk3d_rotate(a, b.x), gjk3d_rotate(a, b.y), gjk3d_rotate(a, b.z) };
+}
+
+vec3 gjk3d_rotate(gjk3d_rot r, vec3 v)
+{
+    return (vec3) {
+        r.x.x * v.x + r.y.x * v.y + r.z.x * v.z,
+        r.x.y * v.x + r.y.y * v.y + r.z.y * v.z,
+        r.x.z * v.x + r.y.z * v.y + r.z.z * v.z
+    };
+}
+
+vec3 gjk3d_inv_rotate(gjk3d_rot r, vec3 v)
+{
+    return (vec3) { vec3_dot(r.x, v), vec3_dot(r.y, v), vec3_dot(r.z, v) };
+}
+
+// ---------------| SHAPES |-----------------------------
+static const gjk3d_rot GJK3D_IDENTITY = { { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } };
+
+void gjk3d_sphere(gjk3d_shape* shape, vec3 center, float radius)
+{
+    shape->type = GJK3D_SPHERE;
+    shape->center = center;
+    shape->rot = GJK3D_IDENTITY;
+    shape->radius = radius;
+}
+
+void gjk3d_box(gjk3d_shape* shape, vec3 center, vec3 extents)
+{
+    shape->type = GJK3D_BOX;
+    shape->center = center;
+    shape->rot = GJK3D_IDENTITY;
+    shape->radius = 0.0f;
+    shape->extents = extents;
+}
+
+void gjk3d_capsule(gjk3d_shape* shape, vec3 a, vec3 b, float radius)
+{
+    vec3 ab = vec3_sub(b, a);
+
+    /* a right handed frame with the local y axis along the segment */
+    vec3 y = gjk3d_safe_normalize(ab);
+    vec3 x = gjk3d_perpendicular(y);
+
+    shape->type = GJK3D_CAPSULE;
+    shape->center = vec3_lerp(a, b, 0.5f);
+    shape->rot = (gjk3d_rot) { x, y, vec3_cross(x, y) };
+    shape->radius = radius;
+    shape->half_length = 0.5f * sqrtf(gjk3d_length_squared(ab));
+}
+
+void gjk3d_hull(gjk3d_shape* shape, vec3 center, const vec3* vertices, size_t count)
+{
+    shape->type = GJK3D_HULL;
+    shape->center = center;
+    shape->rot = GJK3D_IDENTITY;
+    shape->radius = 0.0f;
+    shape->vertices = vertices;
+    shape->count = count;
+}
+
+void gjk3d_set_center(gjk3d_shape* shape, vec3 center)
+{
+    shape->center = center;
+}
+
+void gjk3d_set_rotation(gjk3d_shape* shape, vec3 axis, float angle)
+{
+    shape->rot = gjk3d_rotation(axis, angle);
+}
+
+gjk3d_aabb gjk3d_shape_aabb(const gjk3d_shape* shape)
+{
+    vec3 e = { 0.0f, 0.0f, 0.0f };
+    const gjk3d_rot* r = &shape->rot;
+
+    switch (shape->type)
+    {
+    case GJK3D_SPHERE:
+        break;
+    case GJK3D_BOX:
+    {
+        /* the absolute rotation matrix maps the extents to world space */
+        vec3 b = shape->extents;
+        e.x = fabsf(r->x.x) * b.x + fabsf(r->y.x) * b.y + fabsf(r->z.x) * b.z;
+        e.y = fabsf(r->x.y) * b.x + fabsf(r->y.y) * b.y + fabsf(r->z.y) * b.z;
+        e.z = fabsf(r->x.z) * b.x + fabsf(r->y.z) * b.y + fabsf(r->z.z) * b.z;
+        break;
+    }
+    case GJK3D_CAPSULE:
+        e = (vec3) { fabsf(r->y.x) * shape->half_length, fabsf(r->y.y) * shape->half_length, fabsf(r->y.z) * shape->half_length };
+        break;
+    case GJK3D_HULL:
+    {
+        vec3 v = gjk3d_rotate(*r, shape->vertices[0]);
+        gjk3d_aabb aabb = { v, v };
+        for (size_t i = 1; i < shape->count; ++i)
+        {
+            v = gjk3d_rotate(*r, shape->vertices[i]);
+            aabb.min = (vec3) { fminf(aabb.min.x, v.x), fminf(aabb.min.y, v.y), fminf(aabb.min.z, v.z) };
+            aabb.max = (vec3) { fmaxf(aabb.max.x, v.x), fmaxf(aabb.max.y, v.y), fmaxf(aabb.max.z, v.z) };
+        }
+        aabb.min = vec3_add(aabb.min, shape->center);
+        aabb.max = vec3_add(aabb.max, shape->center);
+        return aabb;
+    }
+    default:
+        break;
+    }
+
+    e = vec3_add(e, (vec3) { shape->radius, shape->radius, shape->radius });
+    return (gjk3d_aabb) { vec3_sub(shape->center, e), vec3_add(shape->center, e) };
+}
+
+// ---------------| SUPPORT |----------------------------
+static vec3 gjk3d_furthest_point_sphere(const gjk3d_shape* shape, vec3 d)
+{
+    return vec3_add(shape->center, vec3_mult(gjk3d_safe_normalize(d), shape->radius));
+}
+
+static vec3 gjk3d_furthest_point_box(const gjk3d_shape* shape, vec3 d)
+{
+    vec3 local = gjk3d_inv_rotate(shape->rot, d);
+    vec3 e = shape->extents;
+    vec3 p = { local.x < 0.0f ? -e.x : e.x, local.y < 0.0f ? -e.y : e.y, local.z < 0.0f ? -e.z : e.z };
+    return vec3_add(shape->center, gjk3d_rotate(shape->rot, p));
+}
+
+static vec3 gjk3d_furthest_point_capsule(const gjk3d_shape* shape, vec3 d)
+{
+    float h = vec3_dot(shape->rot.y, d) < 0.0f ? -shape->half_length : shape->half_length;
+    vec3 p = vec3_add(shape->center, vec3_mult(shape->rot.y, h));
+    return vec3_add(p, vec3_mult(gjk3d_safe_normalize(d), shape->radius));
+}
+
+static vec3 gjk3d_furthest_point_hull(const gjk3d_shape* shape, vec3 d)
+{
+    vec3 local = gjk3d_inv_rotate(shape->rot, d);
+
+    size_t index = 0;
+    float max_dot = vec3_dot(shape->vertices[0], local);
+    for (size_t i = 1; i < shape->count; ++i)
+    {
+        float dot = vec3_dot(shape->vertices[i], local);
+        if (dot > max_dot)
+        {
+            max_dot = dot;
+            index = i;
+        }
+    }
+    return vec3_add(shape->center, gjk3d_rotate(shape->rot, shape->vertices[index]));
+}
+
+vec3 gjk3d_furthest_point(const gjk3d_shape* shape, vec3 d)
+{
+    switch (shape->type)
+    {
+    case GJK3D_SPHERE:  return gjk3d_furthest_point_sphere(shape, d);
+    case GJK3D_BOX:     return gjk3d_furthest_point_box(shape, d);
+    case GJK3D_CAPSULE: return gjk3d_furthest_point_capsule(shape, d);
+    case GJK3D_HULL:    return gjk3d_furthest_point_hull(shape, d);
+    default:            return shape->center;
+    }
+}
+
+vec3 gjk3d_minkowski_difference(const gjk3d_shape* s1, const gjk3d_shape* s2, vec3 d)
+{
+    return vec3_sub(gjk3d_furthest_point(s1, d), gjk3d_furthest_point(s2, vec3_negate(d)));
+}
+
+// ---------------| GJK |--------------------------------
+#define GJK3D_MAX_ITERATIONS  64
+#define GJK3D_PLANE_TOLERANCE 1e-10f /* squared sine of the angle below which the origin lies on a face */
+
+/*
+ * The simplex is stored with the newest point last. Every case keeps the
+ * feature closest to the origin that the newest point belongs to and
+ * returns the next search direction towards the origin.
+ */
+static void gjk3d_line(vec3* s, size_t* count, vec3* d)
+{
+    vec3 a = s[1], b = s[0];
+    vec3 ab = vec3_sub(b, a), ao = vec3_negate(a);
+
+    if (vec3_dot(ab, ao) > 0.0f)
+    {
+        *d = vec3_cross(vec3_cross(ab, ao), ab);
+
+        /* the origin lies on the line, search on any side of it */
+        if (gjk3d_length_squared(*d) <= FLT_EPSILON * gjk3d_length_squared(ab) * gjk3d_length_squared(ao))
+            *d = gjk3d_perpendicular(ab);
+    }
+    else
+    {
+        s[0] = a;
+        *count = 1;
+        *d = ao;
+    }
+}
+
+static void gjk3d_triangle(vec3* s, size_t* count, vec3* d)
+{
+    vec3 a = s[2], b = s[1], c = s[0];
+    vec3 ab = vec3_sub(b, a), ac = vec3_sub(c, a), ao = vec3_negate(a);
+    vec3 abc = vec3_cross(ab, ac);
+
+    if (vec3_dot(vec3_cross(abc, ac), ao) > 0.0f)
+    {
+        if (vec3_dot(ac, ao) > 0.0f)
+        {
+            /* region AC */
+            s[0] = c;
+            s[1] = a;
+            *count = 2;
+            *d = vec3_cross(vec3_cross(ac, ao), ac);
+            return;
+        }
+
+        s[0] = b;
+        s[1] = a;
+        *count = 2;
+        gjk3d_line(s, count, d);
+    }
+    else if (vec3_dot(vec3_cross(ab, abc), ao) > 0.0f)
+    {
+        s[0] = b;
+        s[1] = a;
+        *count = 2;
+        gjk3d_line(s, count, d);
+    }
+    else if (vec3_dot(abc, ao) >= 0.0f)
+    {
+        /* above the triangle */
+        *d = abc;
+    }
+    else
+    {
+        /* below the triangle, flip it so the tetrahedron grows below */
+        s[0] = b;
+        s[1] = c;
+        *d = vec3_negate(abc);
+    }
+}
+
+static uint8_t gjk3d_tetrahedron(vec3* s, size_t* count, vec3* d)
+{
+    vec3 a = s[3], b = s[2], c = s[1], e = s[0];
+    vec3 ao = vec3_negate(a);
+
+    /* the faces through the newest point, the opposite face was checked before */
+    vec3 faces[3][3] = { { a, b, c }, { a, c, e }, { a, e, b } };
+    vec3 opposite[3] = { e, b, c };
+
+    for (int i = 0; i < 3; ++i)
+    {
+        vec3 n = vec3_cross(vec3_sub(faces[i][1], a), vec3_sub(faces[i][2], a));
+        if (vec3_dot(n, vec3_sub(opposite[i], a)) > 0.0f) n = vec3_negate(n);
+
+        /*
+         * the origin has to be clearly outside, with the origin on an edge
+         * rounding can put it outside of both faces through that edge and
+         * the simplex would cycle around the edge
+         */
+        float dot = vec3_dot(n, ao);
+        if (dot > 0.0f && dot * dot > GJK3D_PLANE_TOLERANCE * gjk3d_length_squared(n) * gjk3d_length_squared(ao))
+        {
+            s[0] = faces[i][2];
+            s[1] = faces[i][1];
+            s[2] = a;
+            *count = 3;
+            gjk3d_triangle(s, count, d);
+            return 0;
+        }
+    }
+
+    /* the origin is inside or on the boundary */
+    return 1;
+}
+
+uint8_t gjk3d_collision(const gjk3d_shape* s1, const gjk3d_shape* s2, vec3* simplex_ptr)
+{
+    vec3 d = vec3_sub(s2->center, s1->center);
+    if (gjk3d_length_squared(d) == 0.0f) d = (vec3) { 1.0f, 0.0f, 0.0f };
+
+    vec3 s[4];
+    size_t count = 1;
+    s[0] = gjk3d_minkowski_difference(s1, s2, d);
+    d = vec3_negate(s[0]);
+
+    for (size_t iteration = 0; iteration < GJK3D_MAX_ITERATIONS; ++iteration)
+    {
+        /* the origin is a vertex of the simplex, any direction finds a new point */
+        if (gjk3d_length_squared(d) == 0.0f) d = gjk3d_perpendicular(vec3_sub(s[count - 1], s[0]));
+
+        vec3 a = gjk3d_minkowski_difference(s1, s2, d);
+        if (vec3_dot(a, d) < 0.0f) return 0;
+
+        s[count++] = a;
+
+        uint8_t collision = 0;
+        switch (count)
+        {
+        case 2:  gjk3d_line(s, &count, &d); break;
+        case 3:  gjk3d_triangle(s, &count, &d); break;
+        default: collision = gjk3d_tetrahedron(s, &count, &d); break;
+        }
+
+        if (collision)
+        {
+            if (simplex_ptr)
+            {
+                for (int i = 0; i < 4; ++i)
+                    simplex_ptr[i] = s[i];
+            }
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// ---------------| EPA |--------------------------------
+#define EPA3D_MAX_POINTS     256
+#define EPA3D_MAX_FACES      1024
+#define EPA3D_MAX_EDGES      256
+#define EPA3D_MAX_ITERATIONS 255
+#define EPA3D_TOLERANCE      0.0001f
+
+typedef struct
+{
+    uint16_t v[3];   /* counter-clockwise seen from outside */
+    vec3 n;          /* outward normal */
+    float distance;  /* of the plane to the origin */
+    uint8_t alive;
+} epa3d_face;
+
+/*
+ * Faces live in an array and a min heap of face indices ordered by distance.
+ * Faces removed while expanding stay in the heap and are skipped once they
+ * reach the top.
+ */
+typedef struct
+{
+    vec3 points[EPA3D_MAX_POINTS];
+    size_t point_count;
+
+    epa3d_face faces[EPA3D_MAX_FACES];
+    size_t face_count;
+
+    uint16_t heap[EPA3D_MAX_FACES];
+    size_t heap_size;
+
+    vec3 interior; /* stays inside, the polytope only grows */
+} epa3d_polytope;
+
+static void epa3d_heap_push(epa3d_polytope* poly, uint16_t face)
+{
+    float distance = poly->faces[face].distance;
+    size_t i = poly->heap_size++;
+    while (i > 0)
+    {
+        size_t parent = (i - 1) / 2;
+        if (poly->faces[poly->heap[parent]].distance <= distance) break;
+        poly->heap[i] = poly->heap[parent];
+        i = parent;
+    }
+    poly->heap[i] = face;
+}
+
+static void epa3d_heap_pop(epa3d_polytope* poly)
+{
+    uint16_t last = poly->heap[--poly->heap_size];
+    float distance = poly->faces[last].distance;
+
+    size_t i = 0;
+    while (1)
+    {
+        size_t child = 2 * i + 1;
+        if (child >= poly->heap_size) break;
+        if (child + 1 < poly->heap_size && poly->faces[poly->heap[child + 1]].distance < poly->faces[poly->heap[child]].distance) child++;
+        if (distance <= poly->faces[poly->heap[child]].distance) break;
+        poly->heap[i] = poly->heap[child];
+        i = child;
+    }
+    poly->heap[i] = last;
+}
+
+static uint8_t epa3d_add_face(epa3d_polytope* poly, uint16_t a, uint16_t b, uint16_t c)
+{
+    if (poly->face_count >= EPA3D_MAX_FACES) return 0;
+
+    vec3 pa = poly->points[a];
+    vec3 n = vec3_cross(vec3_sub(poly->points[b], pa), vec3_sub(poly->points[c], pa));
+    float length = sqrtf(gjk3d_length_squared(n));
+    if (length <= 0.0f) return 1; /* degenerate face, nothing to expand */
+
+    n = vec3_mult(n, 1.0f / length);
+
+    /* keep the winding counter-clockwise from outside */
+    if (vec3_dot(n, vec3_sub(pa, poly->interior)) < 0.0f)
+    {
+        uint16_t t = b;
+        b = c;
+        c = t;
+        n = vec3_negate(n);
+    }
+
+    epa3d_face* face = &poly->faces[poly->face_count];
+    face->v[0] = a;
+    face->v[1] = b;
+    face->v[2] = c;
+    face->n = n;
+    face->distance = vec3_dot(n, pa);
+    face->alive = 1;
+
+    epa3d_heap_push(poly, (uint16_t)poly->face_count++);
+    return 1;
+}
+
+/* adds edge ab to the horizon, or removes ba if two removed faces share it */
+static uint8_t epa3d_add_edge(uint16_t (*edges)[2], size_t* count, uint16_t a, uint16_t b)
+{
+    for (size_t i = 0; i < *count; ++i)
+    {
+        if (edges[i][0] == b && edges[i][1] == a)
+        {
+            edges[i][0] = edges[*count - 1][0];
+            edges[i][1] = edges[*count - 1][1];
+            (*count)--;
+            return 1;
+        }
+    }
+
+    if (*count >= EPA3D_MAX_EDGES) return 0;
+    edges[*count][0] = a;
+    edges[*count][1] = b;
+    (*count)++;
+    return 1;
+}
+
+float epa3d(const gjk3d_shape* s1, const gjk3d_shape* s2, const vec3* simplex, vec3* n, uint8_t* converged)
+{
+    if (converged) *converged = 1;
+
+    epa3d_polytope poly;
+    poly.point_count = 4;
+    poly.face_count = 0;
+    poly.heap_size = 0;
+
+    for (int i = 0; i < 4; ++i)
+        poly.points[i] = simplex[i];
+    poly.interior = vec3_mult(vec3_add(vec3_add(simplex[0], simplex[1]), vec3_add(simplex[2], simplex[3])), 0.25f);
+
+    vec3 normal = vec3_cross(vec3_sub(simplex[1], simplex[0]), vec3_sub(simplex[2], simplex[0]));
+    float volume = vec3_dot(normal, vec3_sub(simplex[3], simplex[0]));
+    if (fabsf(volume) <= FLT_EPSILON * gjk3d_length_squared(normal))
+    {
+        /* flat tetrahedron, the shapes only touch */
+        *n = gjk3d_safe_normalize(normal);
+        return 0.0f;
+    }
+
+    epa3d_add_face(&poly, 0, 1, 2);
+    epa3d_add_face(&poly, 0, 3, 1);
+    epa3d_add_face(&poly, 0, 2, 3);
+    epa3d_add_face(&poly, 1, 3, 2);
+
+    uint16_t edges[EPA3D_MAX_EDGES][2];
+    const epa3d_face* closest = NULL;
+    uint8_t surface = 0;
+
+    for (size_t iteration = 0; iteration < EPA3D_MAX_ITERATIONS; ++iteration)
+    {
+        while (poly.heap_size > 0 && !poly.faces[poly.heap[0]].alive)
+            epa3d_heap_pop(&poly);
+        if (poly.heap_size == 0) break;
+
+        closest = &poly.faces[poly.heap[0]];
+
+        /* the face lies on the surface if the support point does not get further */
+        vec3 p = gjk3d_minkowski_difference(s1, s2, closest->n);
+        float distance = vec3_dot(p, closest->n);
+        if (distance - closest->distance < EPA3D_TOLERANCE)
+        {
+            surface = 1;
+            break;
+        }
+        if (poly.point_count >= EPA3D_MAX_POINTS) break;
+
+        uint16_t index = (uint16_t)poly.point_count;
+        poly.points[poly.point_count++] = p;
+
+        /* remove the faces p can see and collect the boundary of the hole */
+        size_t edge_count = 0;
+        uint8_t overflow = 0;
+        for (size_t i = 0; i < poly.face_count; ++i)
+        {
+            epa3d_face* face = &poly.faces[i];
+            if (!face->alive || vec3_dot(face->n, vec3_sub(p, poly.points[face->v[0]])) <= 0.0f) continue;
+
+            face->alive = 0;
+            for (int e = 0; e < 3; ++e)
+                overflow |= !epa3d_add_edge(edges, &edge_count, face->v[e], face->v[(e + 1) % 3]);
+        }
+
+        /* close the hole with a fan from the horizon to p */
+        for (size_t i = 0; i < edge_count; ++i)
+            overflow |= !epa3d_add_face(&poly, edges[i][0], edges[i][1], index);
+
+        /* out of buffers, the closest face is the best estimate */
+        if (overflow) break;
+    }
+
+    if (converged) *converged = surface;
+
+    if (!closest)
+    {
+        *n = gjk3d_safe_normalize(normal);
+        return 0.0f;
+    }
+
+    *n = closest->n;
+    return closest->distance;
+}
+
+uint8_t gjk3d_intersect(const gjk3d_shape* s1, const gjk3d_shape* s2, gjk3d_penetration* penetration)
+{
+    vec3 simplex[4];
+    if (!gjk3d_collision(s1, s2, simplex)) return 0;
+
+    penetration->depth = epa3d(s1, s2, simplex, &penetration->normal, &penetration->converged);
+    return 1;
+}
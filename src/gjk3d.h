@@ -0,0 +1,99 @@
+#ifndef GJK3D_H
+#define GJK3D_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "math/vec3.h"
+
+/*
+ * 3D counterpart of gjk.h on vec3. Shapes follow the same model as the 2D
+ * ones: a local shape placed by a center and a rotation, with a support
+ * function per shape type. gjk3d_collision evolves the simplex up to a
+ * tetrahedron around the origin, epa3d expands that tetrahedron into a
+ * polytope until the face closest to the origin lies on the surface of the
+ * minkowski difference.
+ */
+
+typedef struct
+{
+    vec3 x, y, z; /* columns of the rotation matrix, the local axes in world space */
+} gjk3d_rot;
+
+gjk3d_rot gjk3d_rotation(vec3 axis, float angle); /* angle in radians */
+gjk3d_rot gjk3d_rot_multiply(gjk3d_rot a, gjk3d_rot b);
+vec3 gjk3d_rotate(gjk3d_rot r, vec3 v);
+vec3 gjk3d_inv_rotate(gjk3d_rot r, vec3 v);
+
+typedef enum
+{
+    GJK3D_SPHERE,
+    GJK3D_BOX,
+    GJK3D_CAPSULE,
+    GJK3D_HULL,
+    GJK3D_SHAPE_COUNT
+} gjk3d_shape_type;
+
+/* capsules lie along the local y axis, boxes are aligned to the local axes */
+typedef struct
+{
+    gjk3d_shape_type type;
+    vec3 center;
+    gjk3d_rot rot;
+    float radius; /* sphere and capsule */
+    union
+    {
+        float half_length; /* capsule */
+        vec3 extents;      /* half size of a box */
+        struct
+        {
+            const vec3* vertices; /* local points, the hull is their convex hull */
+            size_t count;
+        };
+    };
+} gjk3d_shape;
+
+void gjk3d_sphere(gjk3d_shape* shape, vec3 center, float radius);
+void gjk3d_box(gjk3d_shape* shape, vec3 center, vec3 extents);
+void gjk3d_capsule(gjk3d_shape* shape, vec3 a, vec3 b, float radius);
+
+/* the vertices are in local space and not copied, the local origin is placed at center */
+void gjk3d_hull(gjk3d_shape* shape, vec3 center, const vec3* vertices, size_t count);
+
+void gjk3d_set_center(gjk3d_shape* shape, vec3 center);
+void gjk3d_set_rotation(gjk3d_shape* shape, vec3 axis, float angle);
+
+typedef struct
+{
+    vec3 min, max;
+} gjk3d_aabb;
+
+gjk3d_aabb gjk3d_shape_aabb(const gjk3d_shape* shape);
+
+vec3 gjk3d_furthest_point(const gjk3d_shape* shape, vec3 d);
+vec3 gjk3d_minkowski_difference(const gjk3d_shape* s1, const gjk3d_shape* s2, vec3 d);
+
+/* on a collision the tetrahedron around the origin is written to simplex_ptr (4 points) */
+uint8_t gjk3d_collision(const gjk3d_shape* s1, const gjk3d_shape* s2, vec3* simplex_ptr);
+
+/*
+ * returns the penetration depth for the tetrahedron of gjk3d_collision and
+ * writes the penetration normal to n. The polytope lives in fixed buffers on
+ * the stack. Round shapes can need more points than fit, then the search
+ * stops at the closest face found so far and converged is set to 0: the
+ * depth is a lower bound and the normal an estimate. converged can be NULL.
+ */
+float epa3d(const gjk3d_shape* s1, const gjk3d_shape* s2, const vec3* simplex, vec3* n, uint8_t* converged);
+
+/* the normal points from s1 towards s2, moving s1 by -normal * depth separates the shapes */
+typedef struct
+{
+    vec3 normal;
+    float depth;
+    uint8_t converged; /* 0 if epa3d stopped at its limits */
+} gjk3d_penetration;
+
+/* gjk3d_collision followed by epa3d */
+uint8_t gjk3d_intersect(const gjk3d_shape* s1, const gjk3d_shape* s2, gjk3d_penetration* penetration);
+
+#endif // !GJK3D_H
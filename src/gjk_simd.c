@@ -0,0 +1,192 @@
+#include "gjk_simd.h"
+#include "cpu_features.h"
+
+#ifdef CPU_X86
+#include <immintrin.h>
+
+#if defined(_MSC_VER)
+#define GJK_TARGET_AVX2
+#else
+#define GJK_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+static size_t gjk_support_scalar(const float* x, const float* y, size_t count, gjk_vec2 d)
+{
+    float max_dot = d.x * x[0] + d.y * y[0];
+    size_t index = 0;
+    for (size_t i = 1; i < count; ++i)
+    {
+        float dot = d.x * x[i] + d.y * y[i];
+        if (dot > max_dot)
+        {
+            max_dot = dot;
+            index = i;
+        }
+    }
+    return index;
+}
+
+/*
+ * every lane keeps the first maximum of its own vertices, the horizontal
+ * reduction picks the largest value and the lowest index among equal values.
+ * The remaining vertices are scanned in scalar and only win if they are
+ * strictly larger, so the result matches the scalar scan.
+ */
+static size_t gjk_support_reduce(const float* lane_dot, const int32_t* lane_index, size_t lanes,
+                                 const float* x, const float* y, size_t start, size_t count, gjk_vec2 d)
+{
+    float max_dot = lane_dot[0];
+    size_t index = (size_t)lane_index[0];
+    for (size_t i = 1; i < lanes; ++i)
+    {
+        if (lane_dot[i] > max_dot || (lane_dot[i] == max_dot && (size_t)lane_index[i] < index))
+        {
+            max_dot = lane_dot[i];
+            index = (size_t)lane_index[i];
+        }
+    }
+
+    for (size_t i = start; i < count; ++i)
+    {
+        float dot = d.x * x[i] + d.y * y[i];
+        if (dot > max_dot)
+        {
+            max_dot = dot;
+            index = i;
+        }
+    }
+    return index;
+}
+
+#ifdef CPU_X86
+
+static size_t gjk_support_sse2(const float* x, const float* y, size_t count, gjk_vec2 d)
+{
+    if (count < 8) return gjk_support_scalar(x, y, count, d);
+
+    __m128 dx = _mm_set1_ps(d.x);
+    __m128 dy = _mm_set1_ps(d.y);
+
+    __m128 max_dot = _mm_add_ps(_mm_mul_ps(dx, _mm_loadu_ps(x)), _mm_mul_ps(dy, _mm_loadu_ps(y)));
+    __m128i max_index = _mm_setr_epi32(0, 1, 2, 3);
+    __m128i index = max_index;
+    const __m128i step = _mm_set1_epi32(4);
+
+    size_t i = 4;
+    for (; i + 4 <= count; i += 4)
+    {
+        index = _mm_add_epi32(index, step);
+        __m128 dot = _mm_add_ps(_mm_mul_ps(dx, _mm_loadu_ps(x + i)), _mm_mul_ps(dy, _mm_loadu_ps(y + i)));
+
+        /* sse2 has no blend, select with and/andnot/or */
+        __m128 mask = _mm_cmpgt_ps(dot, max_dot);
+        __m128i imask = _mm_castps_si128(mask);
+        max_dot = _mm_or_ps(_mm_and_ps(mask, dot), _mm_andnot_ps(mask, max_dot));
+        max_index = _mm_or_si128(_mm_and_si128(imask, index), _mm_andnot_si128(imask, max_index));
+    }
+
+    float lane_dot[4];
+    int32_t lane_index[4];
+    _mm_storeu_ps(lane_dot, max_dot);
+    _mm_storeu_si128((__m128i*)lane_index, max_index);
+
+    return gjk_support_reduce(lane_dot, lane_index, 4, x, y, i, count, d);
+}
+
+GJK_TARGET_AVX2
+static size_t gjk_support_avx2(const float* x, const float* y, size_t count, gjk_vec2 d)
+{
+    if (count < 16) return gjk_support_scalar(x, y, count, d);
+
+    __m256 dx = _mm256_set1_ps(d.x);
+    __m256 dy = _mm256_set1_ps(d.y);
+
+    /* mul and add are kept separate so the dot products round like the scalar ones */
+    __m256 max_dot = _mm256_add_ps(_mm256_mul_ps(dx, _mm256_loadu_ps(x)), _mm256_mul_ps(dy, _mm256_loadu_ps(y)));
+    __m256i max_index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i index = max_index;
+    const __m256i step = _mm256_set1_epi32(8);
+
+    size_t i = 8;
+    for (; i + 8 <= count; i += 8)
+    {
+        index = _mm256_add_epi32(index, step);
+        __m256 dot = _mm256_add_ps(_mm256_mul_ps(dx, _mm256_loadu_ps(x + i)), _mm256_mul_ps(dy, _mm256_loadu_ps(y + i)));
+
+        __m256 mask = _mm256_cmp_ps(dot, max_dot, _CMP_GT_OQ);
+        max_dot = _mm256_blendv_ps(max_dot, dot, mask);
+        max_index = _mm256_blendv_epi8(max_index, index, _mm256_castps_si256(mask));
+    }
+
+    float lane_dot[8];
+    int32_t lane_index[8];
+    _mm256_storeu_ps(lane_dot, max_dot);
+    _mm256_storeu_si256((__m256i*)lane_index, max_index);
+
+    return gjk_support_reduce(lane_dot, lane_index, 8, x, y, i, count, d);
+}
+
+#endif // CPU_X86
+
+gjk_kernel gjk_kernel_detect()
+{
+#ifdef CPU_X86
+    if (cpu_has_avx2()) return GJK_KERNEL_AVX2;
+    if (cpu_has_sse2()) return GJK_KERNEL_SSE2;
+#endif
+    return GJK_KERNEL_SCALAR;
+}
+
+gjk_support_kernel gjk_kernel_get(gjk_kernel kernel)
+{
+    switch (kernel)
+    {
+    case GJK_KERNEL_SCALAR: return gjk_support_scalar;
+#ifdef CPU_X86
+    case GJK_KERNEL_SSE2:   return cpu_has_sse2() ? gjk_support_sse2 : NULL;
+    case GJK_KERNEL_AVX2:   return cpu_has_avx2() ? gjk_support_avx2 : NULL;
+#endif
+    default:                return NULL;
+    }
+}
+
+const char* gjk_kernel_name(gjk_kernel kernel)
+{
+    switch (kernel)
+    {
+    case GJK_KERNEL_SCALAR: return "scalar";
+    case GJK_KERNEL_SSE2:   return "sse2";
+    case GJK_KERNEL_AVX2:   return "avx2";
+    default:                return "unknown";
+    }
+}
+
+/* resolved on the first call, racing threads store the same values */
+static gjk_kernel gjk_selected_kernel = GJK_KERNEL_COUNT;
+static gjk_support_kernel gjk_selected_func = NULL;
+
+void gjk_kernel_select(gjk_kernel kernel)
+{
+    gjk_support_kernel func = gjk_kernel_get(kernel);
+    if (!func)
+    {
+        kernel = GJK_KERNEL_SCALAR;
+        func = gjk_support_scalar;
+    }
+
+    gjk_selected_kernel = kernel;
+    gjk_selected_func = func;
+}
+
+gjk_kernel gjk_kernel_selected()
+{
+    if (!gjk_selected_func) gjk_kernel_select(gjk_kernel_detect());
+    return gjk_selected_kernel;
+}
+
+size_t gjk_support_soa(const float* x, const float* y, size_t count, gjk_vec2 d)
+{
+    if (!gjk_selected_func) gjk_kernel_select(gjk_kernel_detect());
+    return gjk_selected_func(x, y, count, d);
+}
@@ -0,0 +1,37 @@
+#ifndef GJK_SIMD_H
+#define GJK_SIMD_H
+
+#include "gjk.h"
+
+/*
+ * Support point kernels for polygons stored as structure of arrays, with
+ * the x values of all vertices followed by the y values. Every kernel
+ * returns the index of the first vertex with the largest dot product,
+ * exactly like the scalar scan over gjk_vec2.
+ */
+
+typedef enum
+{
+    GJK_KERNEL_SCALAR,
+    GJK_KERNEL_SSE2,
+    GJK_KERNEL_AVX2,
+    GJK_KERNEL_COUNT
+} gjk_kernel;
+
+typedef size_t (*gjk_support_kernel)(const float* x, const float* y, size_t count, gjk_vec2 d);
+
+/* best kernel the cpu supports */
+gjk_kernel gjk_kernel_detect();
+
+/* returns NULL if the kernel is not available on this cpu or compiler */
+gjk_support_kernel gjk_kernel_get(gjk_kernel kernel);
+const char* gjk_kernel_name(gjk_kernel kernel);
+
+/* selects the kernel used by gjk_support_soa, falls back to scalar if unavailable */
+void gjk_kernel_select(gjk_kernel kernel);
+gjk_kernel gjk_kernel_selected();
+
+/* runs the selected kernel, detecting the best one on the first call */
+size_t gjk_support_soa(const float* x, const float* y, size_t count, gjk_vec2 d);
+
+#endif // !GJK_SIMD_H
@@ -0,0 +1,362 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "job_system.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+// ---------------| ATOMICS |----------------------------
+#ifdef _MSC_VER
+static int64_t job_load(volatile int64_t* p)              { return InterlockedCompareExchange64(p, 0, 0); }
+static void job_store(volatile int64_t* p, int64_t v)     { InterlockedExchange64(p, v); }
+static int64_t job_add(volatile int64_t* p, int64_t v)    { return InterlockedExchangeAdd64(p, v) + v; }
+static void job_fence()                                   { MemoryBarrier(); }
+static uint8_t job_cas(volatile int64_t* p, int64_t expected, int64_t desired)
+{
+    return InterlockedCompareExchange64(p, desired, expected) == expected;
+}
+#else
+static int64_t job_load(volatile int64_t* p)              { return __atomic_load_n(p, __ATOMIC_SEQ_CST); }
+static void job_store(volatile int64_t* p, int64_t v)     { __atomic_store_n(p, v, __ATOMIC_SEQ_CST); }
+static int64_t job_add(volatile int64_t* p, int64_t v)    { return __atomic_add_fetch(p, v, __ATOMIC_SEQ_CST); }
+static void job_fence()                                   { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static uint8_t job_cas(volatile int64_t* p, int64_t expected, int64_t desired)
+{
+    return __atomic_compare_exchange_n(p, &expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+#endif
+
+// ---------------| THREADS |----------------------------
+#ifdef _WIN32
+typedef HANDLE job_thread;
+typedef CRITICAL_SECTION job_mutex;
+typedef CONDITION_VARIABLE job_cond;
+
+#define job_mutex_init(m)      InitializeCriticalSection(m)
+#define job_mutex_destroy(m)   DeleteCriticalSection(m)
+#define job_mutex_lock(m)      EnterCriticalSection(m)
+#define job_mutex_unlock(m)    LeaveCriticalSection(m)
+#define job_cond_init(c)       InitializeConditionVariable(c)
+#define job_cond_destroy(c)
+#define job_cond_wait(c, m)    SleepConditionVariableCS(c, m, INFINITE)
+#define job_cond_broadcast(c)  WakeAllConditionVariable(c)
+#define job_yield()            SwitchToThread()
+#else
+typedef pthread_t job_thread;
+typedef pthread_mutex_t job_mutex;
+typedef pthread_cond_t job_cond;
+
+#define job_mutex_init(m)      pthread_mutex_init(m, NULL)
+#define job_mutex_destroy(m)   pthread_mutex_destroy(m)
+#define job_mutex_lock(m)      pthread_mutex_lock(m)
+#define job_mutex_unlock(m)    pthread_mutex_unlock(m)
+#define job_cond_init(c)       pthread_cond_init(c, NULL)
+#define job_cond_destroy(c)    pthread_cond_destroy(c)
+#define job_cond_wait(c, m)    pthread_cond_wait(c, m)
+#define job_cond_broadcast(c)  pthread_cond_broadcast(c)
+#define job_yield()            sched_yield()
+#endif
+
+uint32_t job_hardware_threads()
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors ? (uint32_t)info.dwNumberOfProcessors : 1;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (uint32_t)count : 1;
+#endif
+}
+
+// ---------------| MEMORY |-----------------------------
+void* job_aligned_calloc(size_t count, size_t size)
+{
+    if (size && count > SIZE_MAX / size) return NULL;
+
+    size_t bytes = count * size;
+#ifdef _WIN32
+    void* ptr = _aligned_malloc(bytes ? bytes : 1, JOB_CACHE_LINE);
+#else
+    void* ptr = NULL;
+    if (posix_memalign(&ptr, JOB_CACHE_LINE, bytes ? bytes : 1) != 0) ptr = NULL;
+#endif
+    if (ptr) memset(ptr, 0, bytes);
+    return ptr;
+}
+
+void job_aligned_free(void* ptr)
+{
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+// ---------------| DEQUE |------------------------------
+/* every split halves a range, so a deque never holds more than one range per bit of size_t */
+#define JOB_DEQUE_CAPACITY 128
+
+typedef struct
+{
+    size_t begin, end;
+} job_range;
+
+/*
+ * Chase-Lev deque with a fixed ring buffer. Only the owner pushes and takes
+ * at the bottom, thieves take from the top. top and bottom live on separate
+ * cache lines so thieves do not disturb the owner.
+ */
+typedef struct
+{
+    volatile int64_t top;
+    char pad_top[JOB_CACHE_LINE - sizeof(int64_t)];
+    volatile int64_t bottom;
+    char pad_bottom[JOB_CACHE_LINE - sizeof(int64_t)];
+    job_range ranges[JOB_DEQUE_CAPACITY];
+} job_deque;
+
+static uint8_t job_deque_push(job_deque* deque, job_range range)
+{
+    int64_t b = job_load(&deque->bottom);
+    int64_t t = job_load(&deque->top);
+    if (b - t >= JOB_DEQUE_CAPACITY) return 0;
+
+    deque->ranges[b & (JOB_DEQUE_CAPACITY - 1)] = range;
+    job_store(&deque->bottom, b + 1);
+    return 1;
+}
+
+static uint8_t job_deque_take(job_deque* deque, job_range* range)
+{
+    int64_t b = job_load(&deque->bottom) - 1;
+    job_store(&deque->bottom, b);
+    job_fence();
+    int64_t t = job_load(&deque->top);
+
+    if (t > b)
+    {
+        /* empty */
+        job_store(&deque->bottom, b + 1);
+        return 0;
+    }
+
+    *range = deque->ranges[b & (JOB_DEQUE_CAPACITY - 1)];
+    if (t < b) return 1;
+
+    /* last range, race against the thieves */
+    uint8_t won = job_cas(&deque->top, t, t + 1);
+    job_store(&deque->bottom, b + 1);
+    return won;
+}
+
+static uint8_t job_deque_steal(job_deque* deque, job_range* range)
+{
+    int64_t t = job_load(&deque->top);
+    job_fence();
+    int64_t b = job_load(&deque->bottom);
+    if (t >= b) return 0;
+
+    *range = deque->ranges[t & (JOB_DEQUE_CAPACITY - 1)];
+    return job_cas(&deque->top, t, t + 1);
+}
+
+// ---------------| SYSTEM |-----------------------------
+typedef struct
+{
+    job_system* jobs;
+    uint32_t index;
+} job_worker;
+
+struct job_system
+{
+    job_deque* deques;
+    job_worker* workers;
+    job_thread* threads;
+    uint32_t worker_count;
+
+    /* current loop, written before remaining is published */
+    job_func func;
+    void* user;
+    size_t grain;
+    volatile int64_t remaining; /* indices not processed yet */
+
+    /* idle workers sleep until the generation changes */
+    job_mutex mutex;
+    job_cond wake;
+    uint64_t generation;
+    uint8_t quit;
+};
+
+static void job_run(job_system* jobs, uint32_t worker, job_range range)
+{
+    /* keep the lower half and offer the upper half to the thieves */
+    while (range.end - range.begin > jobs->grain)
+    {
+        size_t mid = range.begin + (range.end - range.begin) / 2;
+        if (!job_deque_push(&jobs->deques[worker], (job_range) { mid, range.end })) break;
+        range.end = mid;
+    }
+
+    jobs->func(jobs->user, range.begin, range.end, worker);
+    job_add(&jobs->remaining, -(int64_t)(range.end - range.begin));
+}
+
+static uint8_t job_steal(job_system* jobs, uint32_t worker, job_range* range)
+{
+    for (uint32_t i = 1; i < jobs->worker_count; ++i)
+    {
+        uint32_t victim = (worker + i) % jobs->worker_count;
+        if (job_deque_steal(&jobs->deques[victim], range)) return 1;
+    }
+    return 0;
+}
+
+static void job_work(job_system* jobs, uint32_t worker)
+{
+    while (job_load(&jobs->remaining) > 0)
+    {
+        job_range range;
+        if (job_deque_take(&jobs->deques[worker], &range) || job_steal(jobs, worker, &range))
+            job_run(jobs, worker, range);
+        else
+            job_yield();
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI job_thread_main(LPVOID arg)
+#else
+static void* job_thread_main(void* arg)
+#endif
+{
+    job_worker* worker = arg;
+    job_system* jobs = worker->jobs;
+
+    uint64_t seen = 0;
+    for (;;)
+    {
+        job_mutex_lock(&jobs->mutex);
+        while (jobs->generation == seen && !jobs->quit)
+            job_cond_wait(&jobs->wake, &jobs->mutex);
+        seen = jobs->generation;
+        uint8_t quit = jobs->quit;
+        job_mutex_unlock(&jobs->mutex);
+
+        if (quit) break;
+        job_work(jobs, worker->index);
+    }
+    return 0;
+}
+
+job_system* job_system_create(uint32_t workers)
+{
+    if (!workers) workers = job_hardware_threads();
+
+    job_system* jobs = calloc(1, sizeof(job_system));
+    if (!jobs) return NULL;
+
+    jobs->deques = job_aligned_calloc(workers, sizeof(job_deque));
+    jobs->workers = calloc(workers, sizeof(job_worker));
+    jobs->threads = calloc(workers, sizeof(job_thread));
+    if (!jobs->deques || !jobs->workers || !jobs->threads)
+    {
+        job_aligned_free(jobs->deques);
+        free(jobs->workers);
+        free(jobs->threads);
+        free(jobs);
+        return NULL;
+    }
+
+    job_mutex_init(&jobs->mutex);
+    job_cond_init(&jobs->wake);
+
+    /* worker 0 is the thread calling job_parallel_for */
+    jobs->worker_count = 1;
+    for (uint32_t i = 1; i < workers; ++i)
+    {
+        jobs->workers[i].jobs = jobs;
+        jobs->workers[i].index = i;
+#ifdef _WIN32
+        jobs->threads[i] = CreateThread(NULL, 0, job_thread_main, &jobs->workers[i], 0, NULL);
+        if (!jobs->threads[i]) break;
+#else
+        if (pthread_create(&jobs->threads[i], NULL, job_thread_main, &jobs->workers[i]) != 0) break;
+#endif
+        jobs->worker_count++;
+    }
+
+    return jobs;
+}
+
+void job_system_destroy(job_system* jobs)
+{
+    if (!jobs) return;
+
+    job_mutex_lock(&jobs->mutex);
+    jobs->quit = 1;
+    job_cond_broadcast(&jobs->wake);
+    job_mutex_unlock(&jobs->mutex);
+
+    for (uint32_t i = 1; i < jobs->worker_count; ++i)
+    {
+#ifdef _WIN32
+        WaitForSingleObject(jobs->threads[i], INFINITE);
+        CloseHandle(jobs->threads[i]);
+#else
+        pthread_join(jobs->threads[i], NULL);
+#endif
+    }
+
+    job_cond_destroy(&jobs->wake);
+    job_mutex_destroy(&jobs->mutex);
+
+    job_aligned_free(jobs->deques);
+    free(jobs->workers);
+    free(jobs->threads);
+    free(jobs);
+}
+
+uint32_t job_system_worker_count(const job_system* jobs)
+{
+    return jobs->worker_count;
+}
+
+void job_parallel_for(job_system* jobs, size_t count, size_t grain, job_func func, void* user)
+{
+    if (!count) return;
+    if (!grain) grain = 1;
+
+    /* nothing to share the work with */
+    if (jobs->worker_count == 1 || count <= grain)
+    {
+        for (size_t begin = 0; begin < count; begin += grain)
+            func(user, begin, begin + grain < count ? begin + grain : count, 0);
+        return;
+    }
+
+    jobs->func = func;
+    jobs->user = user;
+    jobs->grain = grain;
+    job_store(&jobs->remaining, (int64_t)count);
+    job_deque_push(&jobs->deques[0], (job_range) { 0, count });
+
+    job_mutex_lock(&jobs->mutex);
+    jobs->generation++;
+    job_cond_broadcast(&jobs->wake);
+    job_mutex_unlock(&jobs->mutex);
+
+    job_work(jobs, 0);
+}
@@ -0,0 +1,48 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Work stealing thread pool for data parallel loops. Every worker owns a
+ * lock free deque of index ranges. A worker splits the range it runs in
+ * halves, keeps the lower half and pushes the upper half to the bottom of
+ * its deque. Idle workers steal from the top of the other deques, which
+ * holds the largest ranges. Locks are only taken to put idle workers to
+ * sleep and to wake them at the start of a loop.
+ */
+
+typedef struct job_system job_system;
+
+/* per worker data is padded to this, so workers do not write to the same line */
+#define JOB_CACHE_LINE 64
+
+/*
+ * zero initialized memory aligned to JOB_CACHE_LINE, the padding of per
+ * worker data only helps if the array starts on a line. Free it with
+ * job_aligned_free.
+ */
+void* job_aligned_calloc(size_t count, size_t size);
+void job_aligned_free(void* ptr);
+
+/* worker is in [0, job_system_worker_count) and stable for the whole call */
+typedef void (*job_func)(void* user, size_t begin, size_t end, uint32_t worker);
+
+/* number of hardware threads, at least 1 */
+uint32_t job_hardware_threads();
+
+/* workers includes the calling thread, 0 uses job_hardware_threads */
+job_system* job_system_create(uint32_t workers);
+void job_system_destroy(job_system* jobs);
+
+uint32_t job_system_worker_count(const job_system* jobs);
+
+/*
+ * calls func for disjoint ranges covering [0, count) with at most grain
+ * indices each and returns when all of them are done. The calling thread
+ * takes part as worker 0. Not reentrant, func must not call job_parallel_for.
+ */
+void job_parallel_for(job_system* jobs, size_t count, size_t grain, job_func func, void* user);
+
+#endif // !JOB_SYSTEM_H
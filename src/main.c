@@ -3,6 +3,7 @@
 int main()
 {
     MinimalApp app = example_cube();
+    //MinimalApp app = example_cubes();
     //MinimalApp app = example_gjk();
 
     if (minimalLoad(&app, "IgnisApp", 1024, 800, "4.4"))
@@ -0,0 +1,247 @@
+#include "manifold.h"
+
+#include <math.h>
+
+/* points separated by more than this are dropped */
+#define MANIFOLD_SLOP 0.005f
+
+/* a cached normal is reused while the relative pose moved less than this */
+#define MANIFOLD_REUSE_DISTANCE 0.01f
+#define MANIFOLD_REUSE_ANGLE    0.01f /* sine of the angle */
+
+/* s2 only becomes the reference if its edge is clearly more perpendicular, avoids flip flopping */
+#define MANIFOLD_REFERENCE_TOLERANCE 0.01f
+
+typedef struct
+{
+    gjk_vec2 v[2];     /* core points, without the radius */
+    uint32_t index[2]; /* vertex indices of the shape */
+    uint8_t count;     /* 1 for a single point, 2 for an edge */
+    float radius;
+} manifold_feature;
+
+static void manifold_set_edge(manifold_feature* f, gjk_vec2 a, uint32_t ia, gjk_vec2 b, uint32_t ib)
+{
+    f->v[0] = a;
+    f->v[1] = b;
+    f->index[0] = ia;
+    f->index[1] = ib;
+    f->count = 2;
+}
+
+/* picks the edge next to the support vertex v that is most perpendicular to d */
+static void manifold_pick_edge(manifold_feature* f, gjk_vec2 d, gjk_vec2 prev, uint32_t iprev, gjk_vec2 v, uint32_t iv, gjk_vec2 next, uint32_t inext)
+{
+    float dp = fabsf(gjk_dot_product(gjk_normalize(gjk_sub(v, prev)), d));
+    float dn = fabsf(gjk_dot_product(gjk_normalize(gjk_sub(next, v)), d));
+
+    if (dp < dn) manifold_set_edge(f, prev, iprev, v, iv);
+    else         manifold_set_edge(f, v, iv, next, inext);
+}
+
+/* the feature of shape that is furthest in direction d */
+static void manifold_get_feature(const gjk_shape* shape, gjk_vec2 d, manifold_feature* f)
+{
+    f->radius = shape->radius;
+
+    switch (shape->type)
+    {
+    case GJK_SEGMENT:
+    case GJK_CAPSULE:
+    {
+        gjk_vec2 axis = { shape->rot.c * shape->half_length, shape->rot.s * shape->half_length };
+        manifold_set_edge(f, gjk_sub(shape->center, axis), 0, gjk_add(shape->center, axis), 1);
+        return;
+    }
+    case GJK_BOX:
+    {
+        gjk_vec2 e = shape->extents;
+        gjk_vec2 corners[4] = { { -e.x, -e.y }, { e.x, -e.y }, { e.x, e.y }, { -e.x, e.y } };
+        for (int i = 0; i < 4; ++i)
+            corners[i] = gjk_add(shape->center, gjk_rotate(shape->rot, corners[i]));
+
+        gjk_vec2 local = gjk_inv_rotate(shape->rot, d);
+        uint32_t i = local.x >= 0.0f ? (local.y >= 0.0f ? 2 : 1) : (local.y >= 0.0f ? 3 : 0);
+        uint32_t prev = (i + 3) % 4, next = (i + 1) % 4;
+        manifold_pick_edge(f, d, corners[prev], prev, corners[i], i, corners[next], next);
+        return;
+    }
+    case GJK_POLY:
+    case GJK_ROUNDED:
+    {
+        /* the support hint is the index of the support vertex */
+        size_t i = GJK_NO_HINT;
+        gjk_furthest_point_hint(shape, d, &i);
+
+        size_t prev = i ? i - 1 : shape->count - 1;
+        size_t next = i + 1 < shape->count ? i + 1 : 0;
+        manifold_pick_edge(f, d, gjk_get_vertex(shape, prev), (uint32_t)prev, gjk_get_vertex(shape, i), (uint32_t)i,
+                           gjk_get_vertex(shape, next), (uint32_t)next);
+        return;
+    }
+    case GJK_ELLIPSE:
+        f->v[0] = gjk_furthest_point(shape, d);
+        break;
+    default:
+        f->v[0] = shape->center;
+        break;
+    }
+
+    f->index[0] = 0;
+    f->count = 1;
+}
+
+/* a single point on the round shape, the separation is measured along the normal */
+static uint8_t manifold_point_contact(const gjk_shape* s1, const gjk_shape* s2, uint8_t on_s1, gjk_vec2 normal, manifold* m)
+{
+    gjk_vec2 a = gjk_furthest_point(s1, normal);
+    gjk_vec2 b = gjk_furthest_point(s2, gjk_negate(normal));
+    float separation = gjk_dot_product(gjk_sub(b, a), normal);
+    if (separation > MANIFOLD_SLOP) return 0;
+
+    manifold_point* p = &m->points[0];
+    float offset = 0.5f * separation;
+    p->point = on_s1 ? (gjk_vec2) { a.x + normal.x * offset, a.y + normal.y * offset }
+                     : (gjk_vec2) { b.x - normal.x * offset, b.y - normal.y * offset };
+    p->separation = separation;
+    p->id = 0;
+    p->normal_impulse = 0.0f;
+    p->tangent_impulse = 0.0f;
+
+    m->count = 1;
+    return 1;
+}
+
+/* keeps the part of the incident edge with dot(p, t) * side >= bound * side */
+static uint8_t manifold_clip(gjk_vec2* p, gjk_vec2 t, float bound, float side)
+{
+    float u0 = (gjk_dot_product(p[0], t) - bound) * side;
+    float u1 = (gjk_dot_product(p[1], t) - bound) * side;
+
+    if (u0 < 0.0f && u1 < 0.0f) return 0;
+    if (u0 >= 0.0f && u1 >= 0.0f) return 1;
+
+    /* move the point outside onto the plane */
+    int out = u0 < 0.0f ? 0 : 1;
+    float s = u0 / (u0 - u1);
+    p[out] = (gjk_vec2) { p[0].x + s * (p[1].x - p[0].x), p[0].y + s * (p[1].y - p[0].y) };
+    return 1;
+}
+
+uint8_t manifold_build(const gjk_shape* s1, const gjk_shape* s2, gjk_vec2 normal, manifold* m)
+{
+    m->normal = normal;
+    m->count = 0;
+
+    manifold_feature f1, f2;
+    manifold_get_feature(s1, normal, &f1);
+    manifold_get_feature(s2, gjk_negate(normal), &f2);
+
+    if (f1.count == 1) return manifold_point_contact(s1, s2, 1, normal, m);
+    if (f2.count == 1) return manifold_point_contact(s1, s2, 0, normal, m);
+
+    /* the edge more perpendicular to the normal is the reference */
+    float e1 = fabsf(gjk_dot_product(gjk_normalize(gjk_sub(f1.v[1], f1.v[0])), normal));
+    float e2 = fabsf(gjk_dot_product(gjk_normalize(gjk_sub(f2.v[1], f2.v[0])), normal));
+    uint8_t flip = e2 + MANIFOLD_REFERENCE_TOLERANCE < e1;
+
+    const manifold_feature* ref = flip ? &f2 : &f1;
+    const manifold_feature* inc = flip ? &f1 : &f2;
+
+    /* face normal of the reference edge pointing towards the incident shape */
+    gjk_vec2 t = gjk_normalize(gjk_sub(ref->v[1], ref->v[0]));
+    gjk_vec2 face = gjk_perpendicular(t);
+    if (gjk_dot_product(face, flip ? gjk_negate(normal) : normal) < 0.0f) face = gjk_negate(face);
+
+    /*
+     * point i of the manifold lies on the side of reference vertex i. Its id pairs
+     * that vertex with the incident vertex on the same side, whether it was clipped
+     * or not, so jitter around the side planes does not change the ids.
+     */
+    int swap = gjk_dot_product(inc->v[0], t) > gjk_dot_product(inc->v[1], t);
+    gjk_vec2 p[2] = { inc->v[swap], inc->v[!swap] };
+    uint32_t key[2] = { inc->index[swap], inc->index[!swap] };
+
+    /* clip the incident edge to the side planes of the reference edge */
+    if (!manifold_clip(p, t, gjk_dot_product(ref->v[0], t),  1.0f)
+     || !manifold_clip(p, t, gjk_dot_product(ref->v[1], t), -1.0f))
+    {
+        return manifold_point_contact(s1, s2, 1, normal, m);
+    }
+
+    m->normal = flip ? gjk_negate(face) : face;
+    for (int i = 0; i < 2; ++i)
+    {
+        float separation = gjk_dot_product(gjk_sub(p[i], ref->v[0]), face) - ref->radius - inc->radius;
+        if (separation > MANIFOLD_SLOP) continue;
+
+        /* move from the incident core to halfway between the surfaces */
+        float offset = inc->radius + 0.5f * separation;
+
+        manifold_point* mp = &m->points[m->count++];
+        mp->point = (gjk_vec2) { p[i].x - face.x * offset, p[i].y - face.y * offset };
+        mp->separation = separation;
+        mp->id = ((uint32_t)flip << 31) | ((ref->index[i] & 0x7fffu) << 16) | (key[i] & 0xffffu);
+        mp->normal_impulse = 0.0f;
+        mp->tangent_impulse = 0.0f;
+    }
+    return m->count;
+}
+
+void manifold_match(manifold* m, const manifold* old)
+{
+    for (uint8_t i = 0; i < m->count; ++i)
+    {
+        for (uint8_t j = 0; j < old->count; ++j)
+        {
+            if (m->points[i].id != old->points[j].id) continue;
+
+            m->points[i].normal_impulse = old->points[j].normal_impulse;
+            m->points[i].tangent_impulse = old->points[j].tangent_impulse;
+            break;
+        }
+    }
+}
+
+uint8_t manifold_collide(const gjk_shape* s1, const gjk_shape* s2, manifold_cache* cache)
+{
+    gjk_vec2 local_center = gjk_inv_rotate(s1->rot, gjk_sub(s2->center, s1->center));
+    gjk_rot local_rot = {
+        s1->rot.c * s2->rot.c + s1->rot.s * s2->rot.s,
+        s1->rot.c * s2->rot.s - s1->rot.s * s2->rot.c
+    };
+
+    manifold old = cache->manifold;
+    manifold* m = &cache->manifold;
+
+    /* sine and cosine of the rotation since the normal was computed */
+    float sin_delta = local_rot.s * cache->local_rot.c - local_rot.c * cache->local_rot.s;
+    float cos_delta = local_rot.c * cache->local_rot.c + local_rot.s * cache->local_rot.s;
+
+    if (cache->valid && old.count
+        && gjk_length_Squared(gjk_sub(local_center, cache->local_center)) < MANIFOLD_REUSE_DISTANCE * MANIFOLD_REUSE_DISTANCE
+        && fabsf(sin_delta) < MANIFOLD_REUSE_ANGLE && cos_delta > 0.0f)
+    {
+        manifold_build(s1, s2, gjk_rotate(s1->rot, cache->local_normal), m);
+    }
+    else
+    {
+        gjk_penetration penetration;
+        if (!gjk_intersect(s1, s2, &penetration))
+        {
+            m->count = 0;
+            cache->valid = 0;
+            return 0;
+        }
+
+        manifold_build(s1, s2, penetration.normal, m);
+
+        cache->local_normal = gjk_inv_rotate(s1->rot, penetration.normal);
+        cache->local_center = local_center;
+        cache->local_rot = local_rot;
+        cache->valid = 1;
+    }
+
+    manifold_match(m, &old);
+    return m->count;
+}
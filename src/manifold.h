@@ -0,0 +1,57 @@
+#ifndef MANIFOLD_H
+#define MANIFOLD_H
+
+#include "gjk.h"
+
+/*
+ * Contact manifolds with up to two points. The penetration normal selects a
+ * feature on each shape, an edge or a single point. For two edges the edge
+ * that is more perpendicular to the normal becomes the reference edge and
+ * the other one is clipped against its side planes.
+ * Every point has a feature id built from a reference vertex and the
+ * incident vertex on the same side, so points can be matched across frames
+ * to carry over their accumulated impulses.
+ */
+
+typedef struct
+{
+    gjk_vec2 point;        /* midway between the surfaces */
+    float separation;      /* negative when penetrating */
+    uint32_t id;
+    float normal_impulse;  /* accumulated impulses, kept across frames */
+    float tangent_impulse;
+} manifold_point;
+
+typedef struct
+{
+    gjk_vec2 normal; /* from s1 towards s2 */
+    manifold_point points[2];
+    uint8_t count;
+} manifold;
+
+/* builds the manifold of two shapes for a penetration normal pointing from s1 towards s2 */
+uint8_t manifold_build(const gjk_shape* s1, const gjk_shape* s2, gjk_vec2 normal, manifold* m);
+
+/* copies the impulses of points in old to the points in m with the same feature id */
+void manifold_match(manifold* m, const manifold* old);
+
+/*
+ * persistent manifold of a pair. While the relative pose of the shapes stays
+ * within a small tolerance of the pose the normal was computed for, the cached
+ * normal is reused and only the clipping runs again, so resting contacts do
+ * not pay for gjk and epa every frame.
+ * Zero initialize, swapping s1 and s2 invalidates the cache.
+ */
+typedef struct
+{
+    manifold manifold;
+    gjk_vec2 local_normal;  /* normal in the frame of s1 */
+    gjk_vec2 local_center;  /* center of s2 in the frame of s1 */
+    gjk_rot local_rot;      /* rotation of s2 relative to s1 */
+    uint8_t valid;
+} manifold_cache;
+
+/* updates the manifold in cache and returns its point count */
+uint8_t manifold_collide(const gjk_shape* s1, const gjk_shape* s2, manifold_cache* cache);
+
+#endif // !MANIFOLD_H
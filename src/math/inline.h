@@ -0,0 +1,15 @@
+#ifndef MATH_INLINE_H
+#define MATH_INLINE_H
+
+/*
+ * The small math functions are defined in the headers and forced inline,
+ * a call across units would cost more than the math itself. They are
+ * static, so every unit gets its own copy and nothing has to be linked.
+ */
+#if defined(_MSC_VER)
+#define MATH_INLINE static __forceinline
+#else
+#define MATH_INLINE static inline __attribute__((always_inline))
+#endif
+
+#endif /* !MATH_INLINE_H */
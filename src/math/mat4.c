@@ -1,23 +1,13 @@
 #include "mat4.h"
+#include "quat.h"
 
 #include <math.h>
 
-mat4 mat4_identity()
-{
-    mat4 result = {
-        1.0f, 0.0f, 0.0f, 0.0f,
-        0.0f, 1.0f, 0.0f, 0.0f,
-        0.0f, 0.0f, 1.0f, 0.0f,
-        0.0f, 0.0f, 0.0f, 1.0f
-    };
-    return result;
-}
-
 mat4 mat4_perspective(float fov_y, float aspect, float near, float far)
 {
     float tan_half_fov_y = 1.0f / tanf(fov_y * 0.5f);
 
-    mat4 result = { 0.0f };
+    mat4 result = { 0 };
     result.v[0][0] = tan_half_fov_y / aspect;
     result.v[1][1] = tan_half_fov_y;
     result.v[2][2] = -((far + near) / (far - near));
@@ -33,7 +23,7 @@ mat4 mat4_ortho(float left, float right, float bottom, float top, float near, fl
     float tb = 1.0f / (top - bottom);
     float fn = -1.0f / (far - near);
 
-    mat4 result = { 0.0f };
+    mat4 result = { 0 };
     result.v[0][0] = 2.0f * rl;
     result.v[1][1] = 2.0f * tb;
     result.v[2][2] = 2.0f * fn;
@@ -62,7 +52,7 @@ mat4 mat4_rotation(vec3 axis, float angle)
     float l = xx + yy + zz;
     float sqrt_l = sqrtf(l);
 
-    mat4 result = { 0.0f };
+    mat4 result = { 0 };
     result.v[0][0] = (xx + (yy + zz) * c) / l;
     result.v[0][1] = (xy * one_c + z * sqrt_l * s) / l;
     result.v[0][2] = (xz * one_c - y * sqrt_l * s) / l;
@@ -76,11 +66,188 @@ mat4 mat4_rotation(vec3 axis, float angle)
     return result;
 }
 
-mat4 mat4_translation(vec3 v)
+mat4 mat4_look_at(vec3 eye, vec3 look_at, vec3 up)
+{
+    vec3 f = vec3_normalize(vec3_sub(look_at, eye));
+    vec3 s = vec3_normalize(vec3_cross(f, up));
+    vec3 t = vec3_cross(s, f);
+
+    mat4 result = { {
+        {  s.x, t.x, -f.x, 0.0f },
+        {  s.y, t.y, -f.y, 0.0f },
+        {  s.z, t.z, -f.z, 0.0f },
+        { -vec3_dot(s, eye), -vec3_dot(t, eye), vec3_dot(f, eye), 1.0f }
+    } };
+    return result;
+}
+
+/* the quaternion has to be normalized */
+mat4 mat4_cast(quat q)
+{
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+    mat4 result = { {
+        { 1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz),        2.0f * (xz - wy),        0.0f },
+        { 2.0f * (xy - wz),        1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx),        0.0f },
+        { 2.0f * (xz + wy),        2.0f * (yz - wx),        1.0f - 2.0f * (xx + yy), 0.0f },
+        { 0.0f,                    0.0f,                    0.0f,                    1.0f }
+    } };
+    return result;
+}
+
+/* 
+ * the rotations are applied before mat, like mat4_multiply(mat, rotation).
+ * Only two columns change, so they are combined directly.
+ */
+static mat4 mat4_rotate_columns(mat4 mat, int a, int b, float s, float c)
 {
-    mat4 result = mat4_identity();
-    result.v[3][0] = v.x;
-    result.v[3][1] = v.y;
-    result.v[3][2] = v.z;
+    mat4 result = mat;
+    for (int i = 0; i < 4; ++i)
+    {
+        result.v[a][i] = c * mat.v[a][i] + s * mat.v[b][i];
+        result.v[b][i] = c * mat.v[b][i] - s * mat.v[a][i];
+    }
     return result;
-}
\ No newline at end of file
+}
+
+mat4 mat4_rotate_x(mat4 mat, float f) { return mat4_rotate_columns(mat, 1, 2, sinf(f), cosf(f)); }
+mat4 mat4_rotate_y(mat4 mat, float f) { return mat4_rotate_columns(mat, 2, 0, sinf(f), cosf(f)); }
+mat4 mat4_rotate_z(mat4 mat, float f) { return mat4_rotate_columns(mat, 0, 1, sinf(f), cosf(f)); }
+
+// ---------------| INVERT |-----------------------------
+#if defined(MAT4_SSE)
+/*
+ * Block inversion on the four 2x2 sub matrices. Every __m128 holds a 2x2
+ * matrix (a b c d) in row order. The inverse of a matrix is the transpose of
+ * the inverse of its transpose, so the kernel works on columns the same way.
+ */
+#define MAT4_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+#define MAT4_SWIZZLE(v, x, y, z, w)    _mm_castsi128_ps(_mm_shuffle_epi32(_mm_castps_si128(v), _MM_SHUFFLE(w, z, y, x)))
+
+/* a * b */
+static inline __m128 mat2_multiply(__m128 a, __m128 b)
+{
+    return _mm_add_ps(_mm_mul_ps(a, MAT4_SWIZZLE(b, 0, 3, 0, 3)), _mm_mul_ps(MAT4_SWIZZLE(a, 1, 0, 3, 2), MAT4_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+/* adjugate(a) * b */
+static inline __m128 mat2_adj_multiply(__m128 a, __m128 b)
+{
+    return _mm_sub_ps(_mm_mul_ps(MAT4_SWIZZLE(a, 3, 3, 0, 0), b), _mm_mul_ps(MAT4_SWIZZLE(a, 1, 1, 2, 2), MAT4_SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+/* a * adjugate(b) */
+static inline __m128 mat2_multiply_adj(__m128 a, __m128 b)
+{
+    return _mm_sub_ps(_mm_mul_ps(a, MAT4_SWIZZLE(b, 3, 0, 3, 0)), _mm_mul_ps(MAT4_SWIZZLE(a, 1, 0, 3, 2), MAT4_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+/* the matrix is expected to be invertible */
+mat4 mat4_invert(mat4 m)
+{
+    __m128 c0 = _mm_loadu_ps(m.v[0]);
+    __m128 c1 = _mm_loadu_ps(m.v[1]);
+    __m128 c2 = _mm_loadu_ps(m.v[2]);
+    __m128 c3 = _mm_loadu_ps(m.v[3]);
+
+    /* sub matrices | A B |
+     *              | C D | */
+    __m128 a = _mm_movelh_ps(c0, c1);
+    __m128 b = _mm_movehl_ps(c1, c0);
+    __m128 c = _mm_movelh_ps(c2, c3);
+    __m128 d = _mm_movehl_ps(c3, c2);
+
+    /* determinants of the sub matrices (|A| |B| |C| |D|) */
+    __m128 det_sub = _mm_sub_ps(
+        _mm_mul_ps(MAT4_SHUFFLE(c0, c2, 0, 2, 0, 2), MAT4_SHUFFLE(c1, c3, 1, 3, 1, 3)),
+        _mm_mul_ps(MAT4_SHUFFLE(c0, c2, 1, 3, 1, 3), MAT4_SHUFFLE(c1, c3, 0, 2, 0, 2)));
+    __m128 det_a = MAT4_SWIZZLE(det_sub, 0, 0, 0, 0);
+    __m128 det_b = MAT4_SWIZZLE(det_sub, 1, 1, 1, 1);
+    __m128 det_c = MAT4_SWIZZLE(det_sub, 2, 2, 2, 2);
+    __m128 det_d = MAT4_SWIZZLE(det_sub, 3, 3, 3, 3);
+
+    __m128 d_c = mat2_adj_multiply(d, c);
+    __m128 a_b = mat2_adj_multiply(a, b);
+
+    /* adjugates of the blocks of the inverse */
+    __m128 x = _mm_sub_ps(_mm_mul_ps(det_d, a), mat2_multiply(b, d_c));
+    __m128 w = _mm_sub_ps(_mm_mul_ps(det_a, d), mat2_multiply(c, a_b));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(det_b, c), mat2_multiply_adj(d, a_b));
+    __m128 z = _mm_sub_ps(_mm_mul_ps(det_c, b), mat2_multiply_adj(a, d_c));
+
+    /* |M| = |A| |D| + |B| |C| - tr((A# B) (D# C)) */
+    __m128 tr = _mm_mul_ps(a_b, MAT4_SWIZZLE(d_c, 0, 2, 1, 3));
+    tr = _mm_add_ps(tr, _mm_movehl_ps(tr, tr));
+    tr = _mm_add_ss(tr, _mm_shuffle_ps(tr, tr, 1));
+    tr = MAT4_SWIZZLE(tr, 0, 0, 0, 0);
+
+    __m128 det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(det_a, det_d), _mm_mul_ps(det_b, det_c)), tr);
+    __m128 inv_det = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+
+    x = _mm_mul_ps(x, inv_det);
+    y = _mm_mul_ps(y, inv_det);
+    z = _mm_mul_ps(z, inv_det);
+    w = _mm_mul_ps(w, inv_det);
+
+    /* the adjugate shuffle of the blocks and the store order in one */
+    mat4 result;
+    _mm_storeu_ps(result.v[0], MAT4_SHUFFLE(x, y, 3, 1, 3, 1));
+    _mm_storeu_ps(result.v[1], MAT4_SHUFFLE(x, y, 2, 0, 2, 0));
+    _mm_storeu_ps(result.v[2], MAT4_SHUFFLE(z, w, 3, 1, 3, 1));
+    _mm_storeu_ps(result.v[3], MAT4_SHUFFLE(z, w, 2, 0, 2, 0));
+    return result;
+}
+#else
+/* cofactors from the 2x2 determinants of the first and last two columns */
+mat4 mat4_invert(mat4 m)
+{
+    float s0 = m.v[0][0] * m.v[1][1] - m.v[1][0] * m.v[0][1];
+    float s1 = m.v[0][0] * m.v[1][2] - m.v[1][0] * m.v[0][2];
+    float s2 = m.v[0][0] * m.v[1][3] - m.v[1][0] * m.v[0][3];
+    float s3 = m.v[0][1] * m.v[1][2] - m.v[1][1] * m.v[0][2];
+    float s4 = m.v[0][1] * m.v[1][3] - m.v[1][1] * m.v[0][3];
+    float s5 = m.v[0][2] * m.v[1][3] - m.v[1][2] * m.v[0][3];
+
+    float c0 = m.v[2][0] * m.v[3][1] - m.v[3][0] * m.v[2][1];
+    float c1 = m.v[2][0] * m.v[3][2] - m.v[3][0] * m.v[2][2];
+    float c2 = m.v[2][0] * m.v[3][3] - m.v[3][0] * m.v[2][3];
+    float c3 = m.v[2][1] * m.v[3][2] - m.v[3][1] * m.v[2][2];
+    float c4 = m.v[2][1] * m.v[3][3] - m.v[3][1] * m.v[2][3];
+    float c5 = m.v[2][2] * m.v[3][3] - m.v[3][2] * m.v[2][3];
+
+    float inv_det = 1.0f / (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+
+    mat4 result;
+    result.v[0][0] = ( m.v[1][1] * c5 - m.v[1][2] * c4 + m.v[1][3] * c3) * inv_det;
+    result.v[0][1] = (-m.v[0][1] * c5 + m.v[0][2] * c4 - m.v[0][3] * c3) * inv_det;
+    result.v[0][2] = ( m.v[3][1] * s5 - m.v[3][2] * s4 + m.v[3][3] * s3) * inv_det;
+    result.v[0][3] = (-m.v[2][1] * s5 + m.v[2][2] * s4 - m.v[2][3] * s3) * inv_det;
+
+    result.v[1][0] = (-m.v[1][0] * c5 + m.v[1][2] * c2 - m.v[1][3] * c1) * inv_det;
+    result.v[1][1] = ( m.v[0][0] * c5 - m.v[0][2] * c2 + m.v[0][3] * c1) * inv_det;
+    result.v[1][2] = (-m.v[3][0] * s5 + m.v[3][2] * s2 - m.v[3][3] * s1) * inv_det;
+    result.v[1][3] = ( m.v[2][0] * s5 - m.v[2][2] * s2 + m.v[2][3] * s1) * inv_det;
+
+    result.v[2][0] = ( m.v[1][0] * c4 - m.v[1][1] * c2 + m.v[1][3] * c0) * inv_det;
+    result.v[2][1] = (-m.v[0][0] * c4 + m.v[0][1] * c2 - m.v[0][3] * c0) * inv_det;
+    result.v[2][2] = ( m.v[3][0] * s4 - m.v[3][1] * s2 + m.v[3][3] * s0) * inv_det;
+    result.v[2][3] = (-m.v[2][0] * s4 + m.v[2][1] * s2 - m.v[2][3] * s0) * inv_det;
+
+    result.v[3][0] = (-m.v[1][0] * c3 + m.v[1][1] * c1 - m.v[1][2] * c0) * inv_det;
+    result.v[3][1] = ( m.v[0][0] * c3 - m.v[0][1] * c1 + m.v[0][2] * c0) * inv_det;
+    result.v[3][2] = (-m.v[3][0] * s3 + m.v[3][1] * s1 - m.v[3][2] * s0) * inv_det;
+    result.v[3][3] = ( m.v[2][0] * s3 - m.v[2][1] * s1 + m.v[2][2] * s0) * inv_det;
+    return result;
+}
+#endif
+
+/* slerps the rotations and lerps the translations of two rigid transforms */
+mat4 mat4_interpolate(mat4 mat0, mat4 mat1, float time)
+{
+    mat4 result = mat4_cast(quat_slerp(quat_cast(mat0), quat_cast(mat1), time));
+    for (int i = 0; i < 3; ++i)
+        result.v[3][i] = mat0.v[3][i] + time * (mat1.v[3][i] - mat0.v[3][i]);
+    return result;
+}
@@ -3,17 +3,49 @@
 
 #include "vec3.h"
 
+/*
+ * Matrices are column major, v[column][row], the same layout as mat4x4 in
+ * linmath.h. Multiply and invert run as SSE kernels on x86, using fused
+ * multiply adds when the compiler targets them. Define MAT4_NO_SIMD to
+ * build the scalar versions.
+ */
+#if !defined(MAT4_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define MAT4_SSE
+#include <emmintrin.h>
+
+/* msvc has no __FMA__, every cpu with avx2 also has fma */
+#if defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define MAT4_FMA
+#include <immintrin.h>
+#endif
+#endif
+
 typedef struct quat
 {
     float x, y, z, w;
 } quat;
 
+typedef struct
+{
+    float x, y, z, w;
+} vec4;
+
 typedef struct
 {
     float v[4][4];
 } mat4;
 
-mat4 mat4_identity();
+MATH_INLINE mat4 mat4_identity()
+{
+    mat4 result = { {
+        { 1.0f, 0.0f, 0.0f, 0.0f },
+        { 0.0f, 1.0f, 0.0f, 0.0f },
+        { 0.0f, 0.0f, 1.0f, 0.0f },
+        { 0.0f, 0.0f, 0.0f, 1.0f }
+    } };
+    return result;
+}
+
 mat4 mat4_cast(quat q);
 
 mat4 mat4_perspective(float fov_y, float aspect, float near, float far);
@@ -22,22 +54,73 @@ mat4 mat4_ortho(float left, float right, float bottom, float top, float near, fl
 mat4 mat4_look_at(vec3 eye, vec3 look_at, vec3 up);
 
 mat4 mat4_rotation(vec3 axis, float angle); /* angle in radians */
-mat4 mat4_translation(vec3 v);
-mat4 mat4_scale(vec3 v);
+
+MATH_INLINE mat4 mat4_translation(vec3 v)
+{
+    mat4 result = mat4_identity();
+    result.v[3][0] = v.x;
+    result.v[3][1] = v.y;
+    result.v[3][2] = v.z;
+    return result;
+}
+
+MATH_INLINE mat4 mat4_scale(vec3 v)
+{
+    mat4 result = mat4_identity();
+    result.v[0][0] = v.x;
+    result.v[1][1] = v.y;
+    result.v[2][2] = v.z;
+    return result;
+}
 
 mat4 mat4_rotate_x(mat4 mat, float f);
 mat4 mat4_rotate_y(mat4 mat, float f);
 mat4 mat4_rotate_z(mat4 mat, float f);
 
-mat4 mat4_multiply(mat4 l, mat4 r);
+#if defined(MAT4_FMA)
+#define MAT4_MADD(a, b, c) _mm_fmadd_ps(a, b, c)
+#else
+#define MAT4_MADD(a, b, c) _mm_add_ps(_mm_mul_ps(a, b), c)
+#endif
 
-mat4 mat4_invert(mat4 m);
+#if defined(MAT4_SSE)
+/* every column of the result combines the columns of l with the broadcast entries of a column of r */
+MATH_INLINE mat4 mat4_multiply(mat4 l, mat4 r)
+{
+    __m128 l0 = _mm_loadu_ps(l.v[0]);
+    __m128 l1 = _mm_loadu_ps(l.v[1]);
+    __m128 l2 = _mm_loadu_ps(l.v[2]);
+    __m128 l3 = _mm_loadu_ps(l.v[3]);
 
-mat4 mat4_interpolate(mat4 mat0, mat4 mat1, float time);
+    mat4 result;
+    for (int c = 0; c < 4; ++c)
+    {
+        __m128 sum = _mm_mul_ps(l0, _mm_set1_ps(r.v[c][0]));
+        sum = MAT4_MADD(l1, _mm_set1_ps(r.v[c][1]), sum);
+        sum = MAT4_MADD(l2, _mm_set1_ps(r.v[c][2]), sum);
+        sum = MAT4_MADD(l3, _mm_set1_ps(r.v[c][3]), sum);
+        _mm_storeu_ps(result.v[c], sum);
+    }
+    return result;
+}
+#else
+MATH_INLINE mat4 mat4_multiply(mat4 l, mat4 r)
+{
+    mat4 result;
+    for (int c = 0; c < 4; ++c)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            result.v[c][i] = l.v[0][i] * r.v[c][0] + l.v[1][i] * r.v[c][1]
+                           + l.v[2][i] * r.v[c][2] + l.v[3][i] * r.v[c][3];
+        }
+    }
+    return result;
+}
+#endif
 
-quat quat_identity();
+mat4 mat4_invert(mat4 m);
 
-quat quat_slerp(quat q0, quat q1, float value);
-quat quat_cast(mat4 mat);
+mat4 mat4_interpolate(mat4 mat0, mat4 mat1, float time);
 
 #endif /* !MAT4_H */
@@ -8,11 +8,12 @@
 #include "vec3.h"
 
 #include "mat4.h"
+#include "quat.h"
 
 #define MPI   3.1415926536f
 #define MPI_2 1.5707963268f
 #define MPI_4 0.7853981634f
 
-inline float degToRad(float angle) { return MPI * angle / 180.f; }
+MATH_INLINE float degToRad(float angle) { return MPI * angle / 180.f; }
 
 #endif /* !MATH_H */
@@ -0,0 +1,264 @@
+#include "quat.h"
+
+#if defined(MAT4_SSE)
+#include <xmmintrin.h>
+#endif
+
+quat quat_slerp(quat q0, quat q1, float value)
+{
+    float cos_theta = quat_dot(q0, q1);
+    if (cos_theta < 0.0f)
+    {
+        q1 = (quat) { -q1.x, -q1.y, -q1.z, -q1.w };
+        cos_theta = -cos_theta;
+    }
+
+    float k0 = 1.0f - value, k1 = value;
+
+    /* sin(theta) vanishes for close rotations, a normalized lerp is exact enough there */
+    if (cos_theta < 0.9995f)
+    {
+        float theta = acosf(cos_theta);
+        float inv_sin = 1.0f / sinf(theta);
+        k0 = sinf((1.0f - value) * theta) * inv_sin;
+        k1 = sinf(value * theta) * inv_sin;
+    }
+
+    quat result = {
+        k0 * q0.x + k1 * q1.x,
+        k0 * q0.y + k1 * q1.y,
+        k0 * q0.z + k1 * q1.z,
+        k0 * q0.w + k1 * q1.w
+    };
+    return quat_normalize(result);
+}
+
+/*
+ * Cubic correction of the interpolation value for nlerp, fitted over the
+ * absolute cosine d of the half angle between the keyframes (zeux.io,
+ * "Approximating slerp"). Keep in sync with the sse version below.
+ */
+static float quat_slerp_correction(float t, float d)
+{
+    float a = 1.0904f + d * (-3.2452f + d * (3.55645f - d * 1.43519f));
+    float b = 0.848013f + d * (-1.06021f + d * 0.215638f);
+    float k = a * (t - 0.5f) * (t - 0.5f) + b;
+    return t + t * (t - 0.5f) * (t - 1.0f) * k;
+}
+
+quat quat_slerp_approx(quat q0, quat q1, float value)
+{
+    return quat_nlerp(q0, q1, quat_slerp_correction(value, fabsf(quat_dot(q0, q1))));
+}
+
+/* starts from the largest of w, x, y and z for precision */
+quat quat_cast(mat4 mat)
+{
+    float m00 = mat.v[0][0], m11 = mat.v[1][1], m22 = mat.v[2][2];
+    float trace = m00 + m11 + m22;
+
+    quat q;
+    if (trace > 0.0f)
+    {
+        float s = 0.5f / sqrtf(trace + 1.0f);
+        q.w = 0.25f / s;
+        q.x = (mat.v[1][2] - mat.v[2][1]) * s;
+        q.y = (mat.v[2][0] - mat.v[0][2]) * s;
+        q.z = (mat.v[0][1] - mat.v[1][0]) * s;
+    }
+    else if (m00 > m11 && m00 > m22)
+    {
+        float s = 2.0f * sqrtf(1.0f + m00 - m11 - m22);
+        q.w = (mat.v[1][2] - mat.v[2][1]) / s;
+        q.x = 0.25f * s;
+        q.y = (mat.v[1][0] + mat.v[0][1]) / s;
+        q.z = (mat.v[2][0] + mat.v[0][2]) / s;
+    }
+    else if (m11 > m22)
+    {
+        float s = 2.0f * sqrtf(1.0f + m11 - m00 - m22);
+        q.w = (mat.v[2][0] - mat.v[0][2]) / s;
+        q.x = (mat.v[1][0] + mat.v[0][1]) / s;
+        q.y = 0.25f * s;
+        q.z = (mat.v[2][1] + mat.v[1][2]) / s;
+    }
+    else
+    {
+        float s = 2.0f * sqrtf(1.0f + m22 - m00 - m11);
+        q.w = (mat.v[0][1] - mat.v[1][0]) / s;
+        q.x = (mat.v[2][0] + mat.v[0][2]) / s;
+        q.y = (mat.v[2][1] + mat.v[1][2]) / s;
+        q.z = 0.25f * s;
+    }
+    return quat_normalize(q);
+}
+
+// ---------------| BATCH |------------------------------
+void quat_batch_slerp(const quat* q0, const quat* q1, const float* values, quat* out, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        out[i] = quat_slerp(q0[i], q1[i], values[i]);
+}
+
+#if defined(MAT4_SSE)
+/* four quaternions as one register per component */
+static inline void quat_load4(const quat* q, __m128* x, __m128* y, __m128* z, __m128* w)
+{
+    __m128 r0 = _mm_loadu_ps(&q[0].x);
+    __m128 r1 = _mm_loadu_ps(&q[1].x);
+    __m128 r2 = _mm_loadu_ps(&q[2].x);
+    __m128 r3 = _mm_loadu_ps(&q[3].x);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    *x = r0;
+    *y = r1;
+    *z = r2;
+    *w = r3;
+}
+
+static inline void quat_store4(float* p0, float* p1, float* p2, float* p3, __m128 x, __m128 y, __m128 z, __m128 w)
+{
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    _mm_storeu_ps(p0, x);
+    _mm_storeu_ps(p1, y);
+    _mm_storeu_ps(p2, z);
+    _mm_storeu_ps(p3, w);
+}
+
+/* rsqrt with one newton step, close to the precision of 1 / sqrtf */
+static inline __m128 quat_rsqrt4(__m128 l)
+{
+    __m128 r = _mm_rsqrt_ps(l);
+    __m128 rrl = _mm_mul_ps(_mm_mul_ps(r, r), l);
+    return _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), r), _mm_sub_ps(_mm_set1_ps(3.0f), rrl));
+}
+
+static void quat_batch_interpolate(const quat* q0, const quat* q1, const float* values, quat* out, size_t count, int correct)
+{
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 ax, ay, az, aw, bx, by, bz, bw;
+        quat_load4(q0 + i, &ax, &ay, &az, &aw);
+        quat_load4(q1 + i, &bx, &by, &bz, &bw);
+        __m128 t = _mm_loadu_ps(values + i);
+
+        __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_add_ps(_mm_mul_ps(az, bz), _mm_mul_ps(aw, bw)));
+
+        if (correct)
+        {
+            __m128 ad = _mm_andnot_ps(sign, d);
+            __m128 a = _mm_add_ps(_mm_set1_ps(-3.2452f), _mm_mul_ps(ad, _mm_sub_ps(_mm_set1_ps(3.55645f), _mm_mul_ps(ad, _mm_set1_ps(1.43519f)))));
+            a = _mm_add_ps(_mm_set1_ps(1.0904f), _mm_mul_ps(ad, a));
+            __m128 b = _mm_add_ps(_mm_set1_ps(-1.06021f), _mm_mul_ps(ad, _mm_set1_ps(0.215638f)));
+            b = _mm_add_ps(_mm_set1_ps(0.848013f), _mm_mul_ps(ad, b));
+
+            __m128 th = _mm_sub_ps(t, half);
+            __m128 k = _mm_add_ps(_mm_mul_ps(a, _mm_mul_ps(th, th)), b);
+            t = _mm_add_ps(t, _mm_mul_ps(_mm_mul_ps(t, th), _mm_mul_ps(_mm_sub_ps(t, one), k)));
+        }
+
+        /* the shorter arc: q1 is negated through the sign of its weight */
+        __m128 k0 = _mm_sub_ps(one, t);
+        __m128 k1 = _mm_xor_ps(t, _mm_and_ps(d, sign));
+
+        __m128 x = _mm_add_ps(_mm_mul_ps(k0, ax), _mm_mul_ps(k1, bx));
+        __m128 y = _mm_add_ps(_mm_mul_ps(k0, ay), _mm_mul_ps(k1, by));
+        __m128 z = _mm_add_ps(_mm_mul_ps(k0, az), _mm_mul_ps(k1, bz));
+        __m128 w = _mm_add_ps(_mm_mul_ps(k0, aw), _mm_mul_ps(k1, bw));
+
+        __m128 l = quat_rsqrt4(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_add_ps(_mm_mul_ps(z, z), _mm_mul_ps(w, w))));
+        quat_store4(&out[i].x, &out[i + 1].x, &out[i + 2].x, &out[i + 3].x,
+            _mm_mul_ps(x, l), _mm_mul_ps(y, l), _mm_mul_ps(z, l), _mm_mul_ps(w, l));
+    }
+
+    for (; i < count; ++i)
+        out[i] = correct ? quat_slerp_approx(q0[i], q1[i], values[i]) : quat_nlerp(q0[i], q1[i], values[i]);
+}
+
+void quat_batch_nlerp(const quat* q0, const quat* q1, const float* values, quat* out, size_t count)
+{
+    quat_batch_interpolate(q0, q1, values, out, count, 0);
+}
+
+void quat_batch_slerp_approx(const quat* q0, const quat* q1, const float* values, quat* out, size_t count)
+{
+    quat_batch_interpolate(q0, q1, values, out, count, 1);
+}
+
+/* the rotation columns are computed for four matrices and transposed into place */
+void quat_batch_to_mat4(const quat* rotations, const vec3* translations, mat4* out, size_t count)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 zero = _mm_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 x, y, z, w;
+        quat_load4(rotations + i, &x, &y, &z, &w);
+
+        __m128 x2 = _mm_mul_ps(x, two), y2 = _mm_mul_ps(y, two), z2 = _mm_mul_ps(z, two);
+        __m128 xx = _mm_mul_ps(x, x2), yy = _mm_mul_ps(y, y2), zz = _mm_mul_ps(z, z2);
+        __m128 xy = _mm_mul_ps(x, y2), xz = _mm_mul_ps(x, z2), yz = _mm_mul_ps(y, z2);
+        __m128 wx = _mm_mul_ps(w, x2), wy = _mm_mul_ps(w, y2), wz = _mm_mul_ps(w, z2);
+
+        quat_store4(out[i].v[0], out[i + 1].v[0], out[i + 2].v[0], out[i + 3].v[0],
+            _mm_sub_ps(one, _mm_add_ps(yy, zz)), _mm_add_ps(xy, wz), _mm_sub_ps(xz, wy), zero);
+        quat_store4(out[i].v[1], out[i + 1].v[1], out[i + 2].v[1], out[i + 3].v[1],
+            _mm_sub_ps(xy, wz), _mm_sub_ps(one, _mm_add_ps(xx, zz)), _mm_add_ps(yz, wx), zero);
+        quat_store4(out[i].v[2], out[i + 1].v[2], out[i + 2].v[2], out[i + 3].v[2],
+            _mm_add_ps(xz, wy), _mm_sub_ps(yz, wx), _mm_sub_ps(one, _mm_add_ps(xx, yy)), zero);
+
+        for (size_t k = i; k < i + 4; ++k)
+        {
+            vec3 t = translations ? translations[k] : (vec3) { 0.0f, 0.0f, 0.0f };
+            out[k].v[3][0] = t.x;
+            out[k].v[3][1] = t.y;
+            out[k].v[3][2] = t.z;
+            out[k].v[3][3] = 1.0f;
+        }
+    }
+
+    for (; i < count; ++i)
+    {
+        out[i] = mat4_cast(rotations[i]);
+        if (translations)
+        {
+            out[i].v[3][0] = translations[i].x;
+            out[i].v[3][1] = translations[i].y;
+            out[i].v[3][2] = translations[i].z;
+        }
+    }
+}
+#else
+void quat_batch_nlerp(const quat* q0, const quat* q1, const float* values, quat* out, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        out[i] = quat_nlerp(q0[i], q1[i], values[i]);
+}
+
+void quat_batch_slerp_approx(const quat* q0, const quat* q1, const float* values, quat* out, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        out[i] = quat_slerp_approx(q0[i], q1[i], values[i]);
+}
+
+void quat_batch_to_mat4(const quat* rotations, const vec3* translations, mat4* out, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        out[i] = mat4_cast(rotations[i]);
+        if (translations)
+        {
+            out[i].v[3][0] = translations[i].x;
+            out[i].v[3][1] = translations[i].y;
+            out[i].v[3][2] = translations[i].z;
+        }
+    }
+}
+#endif
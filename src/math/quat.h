@@ -0,0 +1,98 @@
+#ifndef QUAT_H
+#define QUAT_H
+
+#include <stddef.h>
+
+#include "mat4.h"
+
+/*
+ * Rotations as unit quaternions (x, y, z, w), w is the scalar part. The
+ * interpolations take the shorter arc and return normalized quaternions.
+ */
+
+MATH_INLINE quat quat_identity()
+{
+    quat result = { 0.0f, 0.0f, 0.0f, 1.0f };
+    return result;
+}
+
+MATH_INLINE float quat_dot(quat a, quat b)
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+}
+
+MATH_INLINE quat quat_normalize(quat q)
+{
+    float l = 1.0f / sqrtf(quat_dot(q, q));
+    quat result = { q.x * l, q.y * l, q.z * l, q.w * l };
+    return result;
+}
+
+MATH_INLINE quat quat_conjugate(quat q)
+{
+    quat result = { -q.x, -q.y, -q.z, q.w };
+    return result;
+}
+
+/* the rotation of b followed by the rotation of a */
+MATH_INLINE quat quat_multiply(quat a, quat b)
+{
+    quat result = {
+        a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+        a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+        a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+        a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z
+    };
+    return result;
+}
+
+/* the axis has to be normalized, angle in radians */
+MATH_INLINE quat quat_from_axis_angle(vec3 axis, float angle)
+{
+    float s = sinf(angle * 0.5f);
+    quat result = { axis.x * s, axis.y * s, axis.z * s, cosf(angle * 0.5f) };
+    return result;
+}
+
+MATH_INLINE vec3 quat_rotate(quat q, vec3 v)
+{
+    /* v + 2w (u x v) + 2u x (u x v) with u = (x, y, z) */
+    vec3 u = { q.x, q.y, q.z };
+    vec3 t = vec3_mult(vec3_cross(u, v), 2.0f);
+    return vec3_add(vec3_add(v, vec3_mult(t, q.w)), vec3_cross(u, t));
+}
+
+/* normalized lerp, the angle runs fast in the middle for large rotations */
+MATH_INLINE quat quat_nlerp(quat q0, quat q1, float value)
+{
+    float s = quat_dot(q0, q1) < 0.0f ? -value : value;
+    float k = 1.0f - value;
+    quat result = { k * q0.x + s * q1.x, k * q0.y + s * q1.y, k * q0.z + s * q1.z, k * q0.w + s * q1.w };
+    return quat_normalize(result);
+}
+
+quat quat_slerp(quat q0, quat q1, float value);
+
+/*
+ * nlerp with a corrected value that follows the speed of slerp. The rotation
+ * differs from quat_slerp by less than 1e-3 radians for any pair.
+ */
+quat quat_slerp_approx(quat q0, quat q1, float value);
+
+/* rotation part of mat, the matrix must not be scaled */
+quat quat_cast(mat4 mat);
+
+// ---------------| BATCH |------------------------------
+/*
+ * Interpolate count pairs of keyframes with one value each. nlerp and the
+ * approximate slerp run four quaternions at a time with SSE, the exact
+ * slerp stays scalar for acos and sin. The output may alias the input.
+ */
+void quat_batch_nlerp(const quat* q0, const quat* q1, const float* values, quat* out, size_t count);
+void quat_batch_slerp(const quat* q0, const quat* q1, const float* values, quat* out, size_t count);
+void quat_batch_slerp_approx(const quat* q0, const quat* q1, const float* values, quat* out, size_t count);
+
+/* rigid transforms from the rotations and translations, translations may be NULL */
+void quat_batch_to_mat4(const quat* rotations, const vec3* translations, mat4* out, size_t count);
+
+#endif /* !QUAT_H */
@@ -0,0 +1,596 @@
+#include "vec3_batch.h"
+#include "cpu_features.h"
+
+#include <math.h>
+
+#ifdef CPU_X86
+#include <immintrin.h>
+
+#if defined(_MSC_VER)
+#define VEC3_TARGET_AVX2
+#else
+#define VEC3_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#endif
+
+/* every kernel set implements the whole api, the matrix is passed by pointer internally */
+typedef struct
+{
+    void (*transform_points)(const mat4* m, const vec3* in, vec3* out, size_t count);
+    void (*transform_dirs)(const mat4* m, const vec3* in, vec3* out, size_t count);
+    void (*normalize)(const vec3* in, vec3* out, size_t count);
+    void (*lerp)(const vec3* a, const vec3* b, float t, vec3* out, size_t count);
+    void (*dot)(const vec3* a, const vec3* b, float* out, size_t count);
+    void (*cross)(const vec3* a, const vec3* b, vec3* out, size_t count);
+    void (*transform4)(const mat4* m, const vec4* in, vec4* out, size_t count);
+
+    void (*soa_transform)(const mat4* m, vec3_soa in, vec3_soa out, float w, size_t count);
+    void (*soa_normalize)(vec3_soa in, vec3_soa out, size_t count);
+    void (*soa_lerp)(vec3_soa a, vec3_soa b, float t, vec3_soa out, size_t count);
+    void (*soa_dot)(vec3_soa a, vec3_soa b, float* out, size_t count);
+    void (*soa_cross)(vec3_soa a, vec3_soa b, vec3_soa out, size_t count);
+} vec3_batch_funcs;
+
+static vec3_soa vec3_soa_offset(vec3_soa s, size_t offset)
+{
+    vec3_soa result = { s.x + offset, s.y + offset, s.z + offset };
+    return result;
+}
+
+// ---------------| SCALAR |-----------------------------
+static void vec3_transform_scalar(const mat4* m, const vec3* in, vec3* out, float w, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        vec3 v = in[i];
+        out[i].x = m->v[0][0] * v.x + m->v[1][0] * v.y + m->v[2][0] * v.z + m->v[3][0] * w;
+        out[i].y = m->v[0][1] * v.x + m->v[1][1] * v.y + m->v[2][1] * v.z + m->v[3][1] * w;
+        out[i].z = m->v[0][2] * v.x + m->v[1][2] * v.y + m->v[2][2] * v.z + m->v[3][2] * w;
+    }
+}
+
+static void vec3_transform_points_scalar(const mat4* m, const vec3* in, vec3* out, size_t count)
+{
+    vec3_transform_scalar(m, in, out, 1.0f, count);
+}
+
+static void vec3_transform_dirs_scalar(const mat4* m, const vec3* in, vec3* out, size_t count)
+{
+    vec3_transform_scalar(m, in, out, 0.0f, count);
+}
+
+static void vec3_normalize_scalar(const vec3* in, vec3* out, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        vec3 v = in[i];
+        float l = 1.0f / sqrtf(v.x * v.x + v.y * v.y + v.z * v.z);
+        out[i] = (vec3) { v.x * l, v.y * l, v.z * l };
+    }
+}
+
+static void vec3_lerp_scalar(const vec3* a, const vec3* b, float t, vec3* out, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        vec3 va = a[i], vb = b[i];
+        out[i] = (vec3) { va.x + t * (vb.x - va.x), va.y + t * (vb.y - va.y), va.z + t * (vb.z - va.z) };
+    }
+}
+
+static void vec3_dot_scalar(const vec3* a, const vec3* b, float* out, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        out[i] = a[i].x * b[i].x + a[i].y * b[i].y + a[i].z * b[i].z;
+}
+
+static void vec3_cross_scalar(const vec3* a, const vec3* b, vec3* out, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        vec3 va = a[i], vb = b[i];
+        out[i] = (vec3) { va.y * vb.z - va.z * vb.y, va.z * vb.x - va.x * vb.z, va.x * vb.y - va.y * vb.x };
+    }
+}
+
+static void vec4_transform_scalar(const mat4* m, const vec4* in, vec4* out, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        vec4 v = in[i];
+        out[i].x = m->v[0][0] * v.x + m->v[1][0] * v.y + m->v[2][0] * v.z + m->v[3][0] * v.w;
+        out[i].y = m->v[0][1] * v.x + m->v[1][1] * v.y + m->v[2][1] * v.z + m->v[3][1] * v.w;
+        out[i].z = m->v[0][2] * v.x + m->v[1][2] * v.y + m->v[2][2] * v.z + m->v[3][2] * v.w;
+        out[i].w = m->v[0][3] * v.x + m->v[1][3] * v.y + m->v[2][3] * v.z + m->v[3][3] * v.w;
+    }
+}
+
+static void vec3_soa_transform_scalar(const mat4* m, vec3_soa in, vec3_soa out, float w, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        float x = in.x[i], y = in.y[i], z = in.z[i];
+        out.x[i] = m->v[0][0] * x + m->v[1][0] * y + m->v[2][0] * z + m->v[3][0] * w;
+        out.y[i] = m->v[0][1] * x + m->v[1][1] * y + m->v[2][1] * z + m->v[3][1] * w;
+        out.z[i] = m->v[0][2] * x + m->v[1][2] * y + m->v[2][2] * z + m->v[3][2] * w;
+    }
+}
+
+static void vec3_soa_normalize_scalar(vec3_soa in, vec3_soa out, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        float x = in.x[i], y = in.y[i], z = in.z[i];
+        float l = 1.0f / sqrtf(x * x + y * y + z * z);
+        out.x[i] = x * l;
+        out.y[i] = y * l;
+        out.z[i] = z * l;
+    }
+}
+
+static void vec3_soa_lerp_scalar(vec3_soa a, vec3_soa b, float t, vec3_soa out, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        out.x[i] = a.x[i] + t * (b.x[i] - a.x[i]);
+        out.y[i] = a.y[i] + t * (b.y[i] - a.y[i]);
+        out.z[i] = a.z[i] + t * (b.z[i] - a.z[i]);
+    }
+}
+
+static void vec3_soa_dot_scalar(vec3_soa a, vec3_soa b, float* out, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        out[i] = a.x[i] * b.x[i] + a.y[i] * b.y[i] + a.z[i] * b.z[i];
+}
+
+static void vec3_soa_cross_scalar(vec3_soa a, vec3_soa b, vec3_soa out, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        float ax = a.x[i], ay = a.y[i], az = a.z[i];
+        float bx = b.x[i], by = b.y[i], bz = b.z[i];
+        out.x[i] = ay * bz - az * by;
+        out.y[i] = az * bx - ax * bz;
+        out.z[i] = ax * by - ay * bx;
+    }
+}
+
+static const vec3_batch_funcs vec3_batch_scalar = {
+    vec3_transform_points_scalar,
+    vec3_transform_dirs_scalar,
+    vec3_normalize_scalar,
+    vec3_lerp_scalar,
+    vec3_dot_scalar,
+    vec3_cross_scalar,
+    vec4_transform_scalar,
+    vec3_soa_transform_scalar,
+    vec3_soa_normalize_scalar,
+    vec3_soa_lerp_scalar,
+    vec3_soa_dot_scalar,
+    vec3_soa_cross_scalar
+};
+
+#ifdef CPU_X86
+// ---------------| AVX2 |-------------------------------
+/*
+ * AoS kernels work on 8 vectors at a time: the 24 floats are loaded as six
+ * 128 bit quarters and shuffled into one register per component, the result
+ * is shuffled back the same way before the store. The kernels clear the
+ * upper halves of the registers before the scalar tail: gcc turns the tail
+ * into a jump without vzeroupper, and the dirty state slowed every later
+ * sse instruction, libm included, about five times.
+ */
+VEC3_TARGET_AVX2
+static inline void vec3_load8(const vec3* v, __m256* x, __m256* y, __m256* z)
+{
+    const float* p = &v->x;
+    __m256 m03 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p)), _mm_loadu_ps(p + 12), 1);
+    __m256 m14 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + 4)), _mm_loadu_ps(p + 16), 1);
+    __m256 m25 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + 8)), _mm_loadu_ps(p + 20), 1);
+
+    __m256 xy = _mm256_shuffle_ps(m14, m25, _MM_SHUFFLE(2, 1, 3, 2));
+    __m256 yz = _mm256_shuffle_ps(m03, m14, _MM_SHUFFLE(1, 0, 2, 1));
+    *x = _mm256_shuffle_ps(m03, xy, _MM_SHUFFLE(2, 0, 3, 0));
+    *y = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+    *z = _mm256_shuffle_ps(yz, m25, _MM_SHUFFLE(3, 0, 3, 1));
+}
+
+VEC3_TARGET_AVX2
+static inline void vec3_store8(vec3* v, __m256 x, __m256 y, __m256 z)
+{
+    __m256 rxy = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+    __m256 ryz = _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+    __m256 rzx = _mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+
+    __m256 r03 = _mm256_shuffle_ps(rxy, rzx, _MM_SHUFFLE(2, 0, 2, 0));
+    __m256 r14 = _mm256_shuffle_ps(ryz, rxy, _MM_SHUFFLE(3, 1, 2, 0));
+    __m256 r25 = _mm256_shuffle_ps(rzx, ryz, _MM_SHUFFLE(3, 1, 3, 1));
+
+    float* p = &v->x;
+    _mm_storeu_ps(p, _mm256_castps256_ps128(r03));
+    _mm_storeu_ps(p + 4, _mm256_castps256_ps128(r14));
+    _mm_storeu_ps(p + 8, _mm256_castps256_ps128(r25));
+    _mm_storeu_ps(p + 12, _mm256_extractf128_ps(r03, 1));
+    _mm_storeu_ps(p + 16, _mm256_extractf128_ps(r14, 1));
+    _mm_storeu_ps(p + 20, _mm256_extractf128_ps(r25, 1));
+}
+
+/* the rows of the upper 3x4 block broadcast to all lanes, w scales the translation */
+typedef struct
+{
+    __m256 m[3][4];
+} vec3_mat8;
+
+VEC3_TARGET_AVX2
+static inline vec3_mat8 vec3_mat8_load(const mat4* m, float w)
+{
+    vec3_mat8 result;
+    for (int r = 0; r < 3; ++r)
+    {
+        for (int c = 0; c < 3; ++c)
+            result.m[r][c] = _mm256_set1_ps(m->v[c][r]);
+        result.m[r][3] = _mm256_set1_ps(m->v[3][r] * w);
+    }
+    return result;
+}
+
+VEC3_TARGET_AVX2
+static inline __m256 vec3_mat8_row(const vec3_mat8* m, int r, __m256 x, __m256 y, __m256 z)
+{
+    return _mm256_fmadd_ps(m->m[r][0], x, _mm256_fmadd_ps(m->m[r][1], y, _mm256_fmadd_ps(m->m[r][2], z, m->m[r][3])));
+}
+
+VEC3_TARGET_AVX2
+static inline __m256 vec3_rlength8(__m256 x, __m256 y, __m256 z)
+{
+    __m256 l = _mm256_fmadd_ps(x, x, _mm256_fmadd_ps(y, y, _mm256_mul_ps(z, z)));
+    return _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(l));
+}
+
+VEC3_TARGET_AVX2
+static void vec3_transform_avx2(const mat4* m, const vec3* in, vec3* out, float w, size_t count)
+{
+    vec3_mat8 m8 = vec3_mat8_load(m, w);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 x, y, z;
+        vec3_load8(in + i, &x, &y, &z);
+        vec3_store8(out + i, vec3_mat8_row(&m8, 0, x, y, z), vec3_mat8_row(&m8, 1, x, y, z), vec3_mat8_row(&m8, 2, x, y, z));
+    }
+    _mm256_zeroupper();
+    vec3_transform_scalar(m, in + i, out + i, w, count - i);
+}
+
+static void vec3_transform_points_avx2(const mat4* m, const vec3* in, vec3* out, size_t count)
+{
+    vec3_transform_avx2(m, in, out, 1.0f, count);
+}
+
+static void vec3_transform_dirs_avx2(const mat4* m, const vec3* in, vec3* out, size_t count)
+{
+    vec3_transform_avx2(m, in, out, 0.0f, count);
+}
+
+VEC3_TARGET_AVX2
+static void vec3_normalize_avx2(const vec3* in, vec3* out, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 x, y, z;
+        vec3_load8(in + i, &x, &y, &z);
+        __m256 l = vec3_rlength8(x, y, z);
+        vec3_store8(out + i, _mm256_mul_ps(x, l), _mm256_mul_ps(y, l), _mm256_mul_ps(z, l));
+    }
+    _mm256_zeroupper();
+    vec3_normalize_scalar(in + i, out + i, count - i);
+}
+
+/* the components do not mix, the arrays are lerped as flat floats */
+VEC3_TARGET_AVX2
+static void vec3_lerp_avx2(const vec3* a, const vec3* b, float t, vec3* out, size_t count)
+{
+    const float* pa = &a->x;
+    const float* pb = &b->x;
+    float* po = &out->x;
+    __m256 t8 = _mm256_set1_ps(t);
+
+    size_t n = 3 * count, i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 va = _mm256_loadu_ps(pa + i);
+        _mm256_storeu_ps(po + i, _mm256_fmadd_ps(t8, _mm256_sub_ps(_mm256_loadu_ps(pb + i), va), va));
+    }
+    for (; i < n; ++i)
+        po[i] = pa[i] + t * (pb[i] - pa[i]);
+}
+
+VEC3_TARGET_AVX2
+static void vec3_dot_avx2(const vec3* a, const vec3* b, float* out, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 ax, ay, az, bx, by, bz;
+        vec3_load8(a + i, &ax, &ay, &az);
+        vec3_load8(b + i, &bx, &by, &bz);
+        _mm256_storeu_ps(out + i, _mm256_fmadd_ps(ax, bx, _mm256_fmadd_ps(ay, by, _mm256_mul_ps(az, bz))));
+    }
+    _mm256_zeroupper();
+    vec3_dot_scalar(a + i, b + i, out + i, count - i);
+}
+
+VEC3_TARGET_AVX2
+static void vec3_cross_avx2(const vec3* a, const vec3* b, vec3* out, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 ax, ay, az, bx, by, bz;
+        vec3_load8(a + i, &ax, &ay, &az);
+        vec3_load8(b + i, &bx, &by, &bz);
+        vec3_store8(out + i,
+            _mm256_fmsub_ps(ay, bz, _mm256_mul_ps(az, by)),
+            _mm256_fmsub_ps(az, bx, _mm256_mul_ps(ax, bz)),
+            _mm256_fmsub_ps(ax, by, _mm256_mul_ps(ay, bx)));
+    }
+    _mm256_zeroupper();
+    vec3_cross_scalar(a + i, b + i, out + i, count - i);
+}
+
+/* two vec4 per register, the columns are repeated in both 128 bit lanes */
+VEC3_TARGET_AVX2
+static void vec4_transform_avx2(const mat4* m, const vec4* in, vec4* out, size_t count)
+{
+    __m256 c0 = _mm256_broadcast_ps((const __m128*)m->v[0]);
+    __m256 c1 = _mm256_broadcast_ps((const __m128*)m->v[1]);
+    __m256 c2 = _mm256_broadcast_ps((const __m128*)m->v[2]);
+    __m256 c3 = _mm256_broadcast_ps((const __m128*)m->v[3]);
+
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+        __m256 v = _mm256_loadu_ps(&in[i].x);
+        __m256 r = _mm256_mul_ps(c0, _mm256_permute_ps(v, 0x00));
+        r = _mm256_fmadd_ps(c1, _mm256_permute_ps(v, 0x55), r);
+        r = _mm256_fmadd_ps(c2, _mm256_permute_ps(v, 0xAA), r);
+        r = _mm256_fmadd_ps(c3, _mm256_permute_ps(v, 0xFF), r);
+        _mm256_storeu_ps(&out[i].x, r);
+    }
+    _mm256_zeroupper();
+    vec4_transform_scalar(m, in + i, out + i, count - i);
+}
+
+VEC3_TARGET_AVX2
+static void vec3_soa_transform_avx2(const mat4* m, vec3_soa in, vec3_soa out, float w, size_t count)
+{
+    vec3_mat8 m8 = vec3_mat8_load(m, w);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(in.x + i);
+        __m256 y = _mm256_loadu_ps(in.y + i);
+        __m256 z = _mm256_loadu_ps(in.z + i);
+        _mm256_storeu_ps(out.x + i, vec3_mat8_row(&m8, 0, x, y, z));
+        _mm256_storeu_ps(out.y + i, vec3_mat8_row(&m8, 1, x, y, z));
+        _mm256_storeu_ps(out.z + i, vec3_mat8_row(&m8, 2, x, y, z));
+    }
+    _mm256_zeroupper();
+    vec3_soa_transform_scalar(m, vec3_soa_offset(in, i), vec3_soa_offset(out, i), w, count - i);
+}
+
+VEC3_TARGET_AVX2
+static void vec3_soa_normalize_avx2(vec3_soa in, vec3_soa out, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(in.x + i);
+        __m256 y = _mm256_loadu_ps(in.y + i);
+        __m256 z = _mm256_loadu_ps(in.z + i);
+        __m256 l = vec3_rlength8(x, y, z);
+        _mm256_storeu_ps(out.x + i, _mm256_mul_ps(x, l));
+        _mm256_storeu_ps(out.y + i, _mm256_mul_ps(y, l));
+        _mm256_storeu_ps(out.z + i, _mm256_mul_ps(z, l));
+    }
+    _mm256_zeroupper();
+    vec3_soa_normalize_scalar(vec3_soa_offset(in, i), vec3_soa_offset(out, i), count - i);
+}
+
+VEC3_TARGET_AVX2
+static void vec3_soa_lerp_avx2(vec3_soa a, vec3_soa b, float t, vec3_soa out, size_t count)
+{
+    __m256 t8 = _mm256_set1_ps(t);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(a.x + i);
+        __m256 y = _mm256_loadu_ps(a.y + i);
+        __m256 z = _mm256_loadu_ps(a.z + i);
+        _mm256_storeu_ps(out.x + i, _mm256_fmadd_ps(t8, _mm256_sub_ps(_mm256_loadu_ps(b.x + i), x), x));
+        _mm256_storeu_ps(out.y + i, _mm256_fmadd_ps(t8, _mm256_sub_ps(_mm256_loadu_ps(b.y + i), y), y));
+        _mm256_storeu_ps(out.z + i, _mm256_fmadd_ps(t8, _mm256_sub_ps(_mm256_loadu_ps(b.z + i), z), z));
+    }
+    _mm256_zeroupper();
+    vec3_soa_lerp_scalar(vec3_soa_offset(a, i), vec3_soa_offset(b, i), t, vec3_soa_offset(out, i), count - i);
+}
+
+VEC3_TARGET_AVX2
+static void vec3_soa_dot_avx2(vec3_soa a, vec3_soa b, float* out, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 d = _mm256_mul_ps(_mm256_loadu_ps(a.z + i), _mm256_loadu_ps(b.z + i));
+        d = _mm256_fmadd_ps(_mm256_loadu_ps(a.y + i), _mm256_loadu_ps(b.y + i), d);
+        d = _mm256_fmadd_ps(_mm256_loadu_ps(a.x + i), _mm256_loadu_ps(b.x + i), d);
+        _mm256_storeu_ps(out + i, d);
+    }
+    _mm256_zeroupper();
+    vec3_soa_dot_scalar(vec3_soa_offset(a, i), vec3_soa_offset(b, i), out + i, count - i);
+}
+
+VEC3_TARGET_AVX2
+static void vec3_soa_cross_avx2(vec3_soa a, vec3_soa b, vec3_soa out, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 ax = _mm256_loadu_ps(a.x + i), ay = _mm256_loadu_ps(a.y + i), az = _mm256_loadu_ps(a.z + i);
+        __m256 bx = _mm256_loadu_ps(b.x + i), by = _mm256_loadu_ps(b.y + i), bz = _mm256_loadu_ps(b.z + i);
+        _mm256_storeu_ps(out.x + i, _mm256_fmsub_ps(ay, bz, _mm256_mul_ps(az, by)));
+        _mm256_storeu_ps(out.y + i, _mm256_fmsub_ps(az, bx, _mm256_mul_ps(ax, bz)));
+        _mm256_storeu_ps(out.z + i, _mm256_fmsub_ps(ax, by, _mm256_mul_ps(ay, bx)));
+    }
+    _mm256_zeroupper();
+    vec3_soa_cross_scalar(vec3_soa_offset(a, i), vec3_soa_offset(b, i), vec3_soa_offset(out, i), count - i);
+}
+
+static const vec3_batch_funcs vec3_batch_avx2 = {
+    vec3_transform_points_avx2,
+    vec3_transform_dirs_avx2,
+    vec3_normalize_avx2,
+    vec3_lerp_avx2,
+    vec3_dot_avx2,
+    vec3_cross_avx2,
+    vec4_transform_avx2,
+    vec3_soa_transform_avx2,
+    vec3_soa_normalize_avx2,
+    vec3_soa_lerp_avx2,
+    vec3_soa_dot_avx2,
+    vec3_soa_cross_avx2
+};
+
+#endif // CPU_X86
+
+vec3_batch_kernel vec3_batch_detect()
+{
+#ifdef CPU_X86
+    if (cpu_has_avx2() && cpu_has_fma()) return VEC3_BATCH_AVX2;
+#endif
+    return VEC3_BATCH_SCALAR;
+}
+
+const char* vec3_batch_name(vec3_batch_kernel kernel)
+{
+    switch (kernel)
+    {
+    case VEC3_BATCH_SCALAR: return "scalar";
+    case VEC3_BATCH_AVX2:   return "avx2";
+    default:                return "unknown";
+    }
+}
+
+/* resolved on the first call, racing threads store the same values */
+static vec3_batch_kernel vec3_batch_selected_kernel = VEC3_BATCH_KERNEL_COUNT;
+static const vec3_batch_funcs* vec3_batch_selected_funcs = NULL;
+
+void vec3_batch_select(vec3_batch_kernel kernel)
+{
+    const vec3_batch_funcs* funcs = &vec3_batch_scalar;
+#ifdef CPU_X86
+    if (kernel == VEC3_BATCH_AVX2 && cpu_has_avx2() && cpu_has_fma()) funcs = &vec3_batch_avx2;
+#endif
+    vec3_batch_selected_kernel = funcs == &vec3_batch_scalar ? VEC3_BATCH_SCALAR : kernel;
+    vec3_batch_selected_funcs = funcs;
+}
+
+static const vec3_batch_funcs* vec3_batch_funcs_get()
+{
+    if (!vec3_batch_selected_funcs) vec3_batch_select(vec3_batch_detect());
+    return vec3_batch_selected_funcs;
+}
+
+vec3_batch_kernel vec3_batch_selected()
+{
+    vec3_batch_funcs_get();
+    return vec3_batch_selected_kernel;
+}
+
+// ---------------| AOS |--------------------------------
+void vec3_batch_transform_points(mat4 m, const vec3* in, vec3* out, size_t count)
+{
+    vec3_batch_funcs_get()->transform_points(&m, in, out, count);
+}
+
+void vec3_batch_transform_dirs(mat4 m, const vec3* in, vec3* out, size_t count)
+{
+    vec3_batch_funcs_get()->transform_dirs(&m, in, out, count);
+}
+
+void vec3_batch_normalize(const vec3* in, vec3* out, size_t count)
+{
+    vec3_batch_funcs_get()->normalize(in, out, count);
+}
+
+void vec3_batch_lerp(const vec3* a, const vec3* b, float t, vec3* out, size_t count)
+{
+    vec3_batch_funcs_get()->lerp(a, b, t, out, count);
+}
+
+void vec3_batch_dot(const vec3* a, const vec3* b, float* out, size_t count)
+{
+    vec3_batch_funcs_get()->dot(a, b, out, count);
+}
+
+void vec3_batch_cross(const vec3* a, const vec3* b, vec3* out, size_t count)
+{
+    vec3_batch_funcs_get()->cross(a, b, out, count);
+}
+
+void vec4_batch_transform(mat4 m, const vec4* in, vec4* out, size_t count)
+{
+    vec3_batch_funcs_get()->transform4(&m, in, out, count);
+}
+
+// ---------------| SOA |--------------------------------
+void vec3_soa_from_aos(vec3_soa out, const vec3* in, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        out.x[i] = in[i].x;
+        out.y[i] = in[i].y;
+        out.z[i] = in[i].z;
+    }
+}
+
+void vec3_soa_to_aos(vec3* out, vec3_soa in, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        out[i] = (vec3) { in.x[i], in.y[i], in.z[i] };
+}
+
+void vec3_soa_transform_points(mat4 m, vec3_soa in, vec3_soa out, size_t count)
+{
+    vec3_batch_funcs_get()->soa_transform(&m, in, out, 1.0f, count);
+}
+
+void vec3_soa_transform_dirs(mat4 m, vec3_soa in, vec3_soa out, size_t count)
+{
+    vec3_batch_funcs_get()->soa_transform(&m, in, out, 0.0f, count);
+}
+
+void vec3_soa_normalize(vec3_soa in, vec3_soa out, size_t count)
+{
+    vec3_batch_funcs_get()->soa_normalize(in, out, count);
+}
+
+void vec3_soa_lerp(vec3_soa a, vec3_soa b, float t, vec3_soa out, size_t count)
+{
+    vec3_batch_funcs_get()->soa_lerp(a, b, t, out, count);
+}
+
+void vec3_soa_dot(vec3_soa a, vec3_soa b, float* out, size_t count)
+{
+    vec3_batch_funcs_get()->soa_dot(a, b, out, count);
+}
+
+void vec3_soa_cross(vec3_soa a, vec3_soa b, vec3_soa out, size_t count)
+{
+    vec3_batch_funcs_get()->soa_cross(a, b, out, count);
+}
@@ -0,0 +1,61 @@
+#ifndef VEC3_BATCH_H
+#define VEC3_BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "vec3.h"
+#include "mat4.h"
+
+/*
+ * Kernels over arrays of vectors, for arrays as vec3[] (AoS) and as separate
+ * x, y and z arrays (SoA). Points are transformed with w = 1 and without the
+ * perspective divide, directions with w = 0. The output may alias the input.
+ * The avx2 kernels use fused multiply adds and can differ from the scalar
+ * ones in the last bit.
+ */
+
+typedef struct
+{
+    float* x;
+    float* y;
+    float* z;
+} vec3_soa;
+
+typedef enum
+{
+    VEC3_BATCH_SCALAR,
+    VEC3_BATCH_AVX2,
+    VEC3_BATCH_KERNEL_COUNT
+} vec3_batch_kernel;
+
+/* best kernel the cpu supports */
+vec3_batch_kernel vec3_batch_detect();
+const char* vec3_batch_name(vec3_batch_kernel kernel);
+
+/* falls back to scalar if the kernel is unavailable, the best one is selected on the first call otherwise */
+void vec3_batch_select(vec3_batch_kernel kernel);
+vec3_batch_kernel vec3_batch_selected();
+
+// ---------------| AOS |--------------------------------
+void vec3_batch_transform_points(mat4 m, const vec3* in, vec3* out, size_t count);
+void vec3_batch_transform_dirs(mat4 m, const vec3* in, vec3* out, size_t count);
+void vec3_batch_normalize(const vec3* in, vec3* out, size_t count);
+void vec3_batch_lerp(const vec3* a, const vec3* b, float t, vec3* out, size_t count);
+void vec3_batch_dot(const vec3* a, const vec3* b, float* out, size_t count);
+void vec3_batch_cross(const vec3* a, const vec3* b, vec3* out, size_t count);
+
+void vec4_batch_transform(mat4 m, const vec4* in, vec4* out, size_t count);
+
+// ---------------| SOA |--------------------------------
+void vec3_soa_from_aos(vec3_soa out, const vec3* in, size_t count);
+void vec3_soa_to_aos(vec3* out, vec3_soa in, size_t count);
+
+void vec3_soa_transform_points(mat4 m, vec3_soa in, vec3_soa out, size_t count);
+void vec3_soa_transform_dirs(mat4 m, vec3_soa in, vec3_soa out, size_t count);
+void vec3_soa_normalize(vec3_soa in, vec3_soa out, size_t count);
+void vec3_soa_lerp(vec3_soa a, vec3_soa b, float t, vec3_soa out, size_t count);
+void vec3_soa_dot(vec3_soa a, vec3_soa b, float* out, size_t count);
+void vec3_soa_cross(vec3_soa a, vec3_soa b, vec3_soa out, size_t count);
+
+#endif /* !VEC3_BATCH_H */
@@ -0,0 +1,89 @@
+#include "narrowphase.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* pairs per job, large enough to hide the cost of stealing */
+#define NARROWPHASE_GRAIN 256
+
+uint8_t narrowphase_init(narrowphase* np, job_system* jobs)
+{
+    np->buffer_count = jobs ? job_system_worker_count(jobs) : 1;
+    np->buffers = job_aligned_calloc(np->buffer_count, sizeof(narrowphase_buffer));
+    np->shapes = NULL;
+    np->pairs = NULL;
+    return np->buffers != NULL;
+}
+
+void narrowphase_destroy(narrowphase* np)
+{
+    for (uint32_t i = 0; i < np->buffer_count; ++i)
+        free(np->buffers[i].contacts);
+    job_aligned_free(np->buffers);
+    np->buffers = NULL;
+    np->buffer_count = 0;
+}
+
+static void narrowphase_job(void* user, size_t begin, size_t end, uint32_t worker)
+{
+    narrowphase* np = user;
+    narrowphase_buffer* buffer = &np->buffers[worker];
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        gjk_pair pair = np->pairs[i];
+        gjk_penetration penetration;
+        if (!gjk_intersect(&np->shapes[pair.a], &np->shapes[pair.b], &penetration)) continue;
+
+        if (buffer->count >= buffer->capacity)
+        {
+            size_t capacity = buffer->capacity ? buffer->capacity * 2 : 256;
+            narrowphase_contact* contacts = realloc(buffer->contacts, capacity * sizeof(narrowphase_contact));
+            if (!contacts)
+            {
+                buffer->failed = 1;
+                return;
+            }
+            buffer->contacts = contacts;
+            buffer->capacity = capacity;
+        }
+
+        narrowphase_contact* contact = &buffer->contacts[buffer->count++];
+        contact->pair = pair;
+        contact->penetration = penetration;
+    }
+}
+
+size_t narrowphase_run(narrowphase* np, job_system* jobs, const gjk_shape* shapes, const gjk_pair* pairs, size_t count)
+{
+    for (uint32_t i = 0; i < np->buffer_count; ++i)
+    {
+        np->buffers[i].count = 0;
+        np->buffers[i].failed = 0;
+    }
+
+    np->shapes = shapes;
+    np->pairs = pairs;
+
+    if (jobs && job_system_worker_count(jobs) <= np->buffer_count)
+        job_parallel_for(jobs, count, NARROWPHASE_GRAIN, narrowphase_job, np);
+    else
+        narrowphase_job(np, 0, count, 0);
+
+    size_t total = 0;
+    for (uint32_t i = 0; i < np->buffer_count; ++i)
+        total += np->buffers[i].count;
+    return total;
+}
+
+size_t narrowphase_gather(const narrowphase* np, narrowphase_contact* contacts)
+{
+    size_t offset = 0;
+    for (uint32_t i = 0; i < np->buffer_count; ++i)
+    {
+        if (np->buffers[i].count)
+            memcpy(contacts + offset, np->buffers[i].contacts, np->buffers[i].count * sizeof(narrowphase_contact));
+        offset += np->buffers[i].count;
+    }
+    return offset;
+}
@@ -0,0 +1,54 @@
+#ifndef NARROWPHASE_H
+#define NARROWPHASE_H
+
+#include "gjk.h"
+#include "job_system.h"
+
+/*
+ * Runs gjk_intersect over the candidate pairs of a broadphase and collects
+ * the overlapping ones. The pair list is split into chunks for the workers
+ * of a job system and every worker appends to its own contact buffer, so
+ * the hot path shares no state and takes no locks.
+ */
+
+typedef struct
+{
+    gjk_pair pair;
+    gjk_penetration penetration;
+} narrowphase_contact;
+
+typedef struct
+{
+    narrowphase_contact* contacts;
+    size_t count;
+    size_t capacity;
+    uint8_t failed; /* ran out of memory during the last run */
+
+    /* pad to a cache line so workers do not write to the same line */
+    char pad[JOB_CACHE_LINE - sizeof(void*) - 2 * sizeof(size_t) - sizeof(uint8_t)];
+} narrowphase_buffer;
+
+typedef struct
+{
+    narrowphase_buffer* buffers; /* one per worker, aligned to a cache line */
+    uint32_t buffer_count;
+
+    /* input of the current run */
+    const gjk_shape* shapes;
+    const gjk_pair* pairs;
+} narrowphase;
+
+/* jobs can be NULL for a single threaded narrowphase */
+uint8_t narrowphase_init(narrowphase* np, job_system* jobs);
+void narrowphase_destroy(narrowphase* np);
+
+/*
+ * tests all pairs and fills the worker buffers, returns the number of contacts.
+ * jobs has to be the job system passed to narrowphase_init or NULL.
+ */
+size_t narrowphase_run(narrowphase* np, job_system* jobs, const gjk_shape* shapes, const gjk_pair* pairs, size_t count);
+
+/* copies the contacts of all workers to contacts, ordered by worker */
+size_t narrowphase_gather(const narrowphase* np, narrowphase_contact* contacts);
+
+#endif // !NARROWPHASE_H
@@ -0,0 +1,431 @@
+#include "raycast.h"
+
+#include <stdlib.h>
+#include <float.h>
+#include <math.h>
+
+/* the ray in the frame of shape, with the local origin at the centroid for polygons */
+static raycast_ray raycast_to_local(const gjk_shape* shape, raycast_ray ray, gjk_vec2 offset)
+{
+    raycast_ray local;
+    local.origin = gjk_add(gjk_inv_rotate(shape->rot, gjk_sub(ray.origin, shape->center)), offset);
+    local.translation = gjk_inv_rotate(shape->rot, ray.translation);
+    return local;
+}
+
+static uint8_t raycast_set_hit(raycast_hit* hit, raycast_ray ray, float fraction, gjk_vec2 normal)
+{
+    hit->point = (gjk_vec2) { ray.origin.x + ray.translation.x * fraction, ray.origin.y + ray.translation.y * fraction };
+    hit->normal = normal;
+    hit->fraction = fraction;
+    hit->hit = 1;
+    return 1;
+}
+
+// ---------------| CLOSED FORM |------------------------
+static uint8_t raycast_circle(const gjk_shape* shape, raycast_ray ray, float max_fraction, raycast_hit* hit)
+{
+    gjk_vec2 m = gjk_sub(ray.origin, shape->center);
+    float c = gjk_length_Squared(m) - shape->radius * shape->radius;
+    if (c <= 0.0f) return raycast_set_hit(hit, ray, 0.0f, (gjk_vec2) { 0.0f, 0.0f });
+
+    float a = gjk_length_Squared(ray.translation);
+    float b = gjk_dot_product(m, ray.translation);
+    float discriminant = b * b - a * c;
+    if (b >= 0.0f || discriminant < 0.0f || a <= 0.0f) return 0;
+
+    float t = (-b - sqrtf(discriminant)) / a;
+    if (t > max_fraction) return 0;
+
+    gjk_vec2 p = { ray.origin.x + ray.translation.x * t, ray.origin.y + ray.translation.y * t };
+    return raycast_set_hit(hit, ray, t, gjk_normalize(gjk_sub(p, shape->center)));
+}
+
+/* the ellipse is scaled to the unit circle, which keeps the fraction */
+static uint8_t raycast_ellipse(const gjk_shape* shape, raycast_ray ray, float max_fraction, raycast_hit* hit)
+{
+    raycast_ray local = raycast_to_local(shape, ray, (gjk_vec2) { 0.0f, 0.0f });
+    gjk_vec2 e = shape->extents;
+
+    gjk_vec2 m = { local.origin.x / e.x, local.origin.y / e.y };
+    gjk_vec2 d = { local.translation.x / e.x, local.translation.y / e.y };
+
+    float c = gjk_length_Squared(m) - 1.0f;
+    if (c <= 0.0f) return raycast_set_hit(hit, ray, 0.0f, (gjk_vec2) { 0.0f, 0.0f });
+
+    float a = gjk_length_Squared(d);
+    float b = gjk_dot_product(m, d);
+    float discriminant = b * b - a * c;
+    if (b >= 0.0f || discriminant < 0.0f || a <= 0.0f) return 0;
+
+    float t = (-b - sqrtf(discriminant)) / a;
+    if (t > max_fraction) return 0;
+
+    /* the gradient of the implicit function is the normal */
+    gjk_vec2 p = { local.origin.x + local.translation.x * t, local.origin.y + local.translation.y * t };
+    gjk_vec2 n = gjk_normalize((gjk_vec2) { p.x / (e.x * e.x), p.y / (e.y * e.y) });
+    return raycast_set_hit(hit, ray, t, gjk_rotate(shape->rot, n));
+}
+
+/* clips the ray against one slab or edge plane dot(n, p) <= offset */
+static uint8_t raycast_clip(gjk_vec2 n, float offset, raycast_ray ray, float* lower, float* upper, gjk_vec2* normal)
+{
+    float numerator = offset - gjk_dot_product(n, ray.origin);
+    float denominator = gjk_dot_product(n, ray.translation);
+
+    if (denominator == 0.0f) return numerator >= 0.0f;
+
+    float t = numerator / denominator;
+    if (denominator < 0.0f)
+    {
+        /* entering */
+        if (t > *lower)
+        {
+            *lower = t;
+            *normal = n;
+        }
+    }
+    else if (t < *upper)
+    {
+        *upper = t;
+    }
+    return *lower <= *upper;
+}
+
+static uint8_t raycast_box(const gjk_shape* shape, raycast_ray ray, float max_fraction, raycast_hit* hit)
+{
+    raycast_ray local = raycast_to_local(shape, ray, (gjk_vec2) { 0.0f, 0.0f });
+    gjk_vec2 e = shape->extents;
+
+    float lower = 0.0f, upper = max_fraction;
+    gjk_vec2 normal = { 0.0f, 0.0f };
+    if (!raycast_clip((gjk_vec2) {  1.0f,  0.0f }, e.x, local, &lower, &upper, &normal)
+     || !raycast_clip((gjk_vec2) { -1.0f,  0.0f }, e.x, local, &lower, &upper, &normal)
+     || !raycast_clip((gjk_vec2) {  0.0f,  1.0f }, e.y, local, &lower, &upper, &normal)
+     || !raycast_clip((gjk_vec2) {  0.0f, -1.0f }, e.y, local, &lower, &upper, &normal))
+    {
+        return 0;
+    }
+
+    return raycast_set_hit(hit, ray, lower, gjk_rotate(shape->rot, normal));
+}
+
+static uint8_t raycast_poly(const gjk_shape* shape, raycast_ray ray, float max_fraction, raycast_hit* hit)
+{
+    raycast_ray local = raycast_to_local(shape, ray, shape->centroid);
+
+    float lower = 0.0f, upper = max_fraction;
+    gjk_vec2 normal = { 0.0f, 0.0f };
+    for (size_t i = 0; i < shape->count; ++i)
+    {
+        gjk_vec2 a = shape->vertices[i];
+        gjk_vec2 e = gjk_sub(shape->vertices[i + 1 < shape->count ? i + 1 : 0], a);
+
+        /* outward normal, not normalized to keep the loop cheap */
+        gjk_vec2 n = { shape->winding * e.y, shape->winding * -e.x };
+        if (!raycast_clip(n, gjk_dot_product(n, a), local, &lower, &upper, &normal)) return 0;
+    }
+
+    if (lower > 0.0f) normal = gjk_rotate(shape->rot, gjk_normalize(normal));
+    return raycast_set_hit(hit, ray, lower, normal);
+}
+
+// ---------------| GJK |--------------------------------
+/*
+ * conservative advancement along a straight line. The closest points give the
+ * distance and a direction that no point of cast can cross faster than the
+ * translation projected onto it, so the step never passes the surface.
+ */
+static uint8_t raycast_advance(const gjk_shape* cast, gjk_vec2 translation, const gjk_shape* target, float max_fraction, raycast_hit* hit)
+{
+    float t = 0.0f;
+    gjk_shape moved = *cast;
+    for (uint32_t iteration = 0; iteration < RAYCAST_MAX_ITERATIONS; ++iteration)
+    {
+        gjk_set_center(&moved, (gjk_vec2) { cast->center.x + translation.x * t, cast->center.y + translation.y * t });
+
+        gjk_proximity proximity;
+        if (!gjk_closest_points(&moved, target, FLT_MAX, &proximity))
+        {
+            /* every advance stops short of the surface, so this only happens at the start */
+            hit->point = moved.center;
+            hit->normal = (gjk_vec2) { 0.0f, 0.0f };
+            hit->fraction = t;
+            hit->hit = 1;
+            return 1;
+        }
+
+        if (proximity.distance < RAYCAST_TOLERANCE)
+        {
+            hit->point = proximity.point2;
+            hit->normal = gjk_negate(proximity.normal);
+            hit->fraction = t;
+            hit->hit = 1;
+            return 1;
+        }
+
+        float speed = gjk_dot_product(translation, proximity.normal);
+        if (speed <= 0.0f) return 0;
+
+        t += (proximity.distance - 0.5f * RAYCAST_TOLERANCE) / speed;
+        if (t > max_fraction) return 0;
+    }
+    return 0;
+}
+
+uint8_t raycast_shape(const gjk_shape* shape, raycast_ray ray, float max_fraction, raycast_hit* hit)
+{
+    switch (shape->type)
+    {
+    case GJK_CIRCLE:  return raycast_circle(shape, ray, max_fraction, hit);
+    case GJK_ELLIPSE: return raycast_ellipse(shape, ray, max_fraction, hit);
+    case GJK_BOX:     return raycast_box(shape, ray, max_fraction, hit);
+    case GJK_POLY:    return raycast_poly(shape, ray, max_fraction, hit);
+    default:
+    {
+        gjk_shape point;
+        gjk_circle(&point, ray.origin, 0.0f);
+        return raycast_advance(&point, ray.translation, shape, max_fraction, hit);
+    }
+    }
+}
+
+uint8_t raycast_shape_cast(const gjk_shape* cast, gjk_vec2 translation, const gjk_shape* target, float max_fraction, raycast_hit* hit)
+{
+    return raycast_advance(cast, translation, target, max_fraction, hit);
+}
+
+// ---------------| BATCH |------------------------------
+/*
+ * The packet is stored as structure of arrays, so the slab tests of all rays
+ * against a node run in one loop the compiler can vectorize. Shape casts
+ * enlarge every node by the half size of the aabb of the cast.
+ */
+typedef struct
+{
+    float origin_x[RAYCAST_PACKET_SIZE];
+    float origin_y[RAYCAST_PACKET_SIZE];
+    float inv_x[RAYCAST_PACKET_SIZE];
+    float inv_y[RAYCAST_PACKET_SIZE];
+    float extent_x[RAYCAST_PACKET_SIZE];
+    float extent_y[RAYCAST_PACKET_SIZE];
+    float max_fraction[RAYCAST_PACKET_SIZE]; /* shrinks with every hit */
+    size_t count;
+} raycast_packet;
+
+typedef struct
+{
+    int32_t node;
+    uint32_t mask;
+    float entry; /* smallest entry fraction of the rays in mask */
+} raycast_entry;
+
+static float raycast_inverse(float d)
+{
+    /* a huge value instead of infinity, 0 * inf would be nan for origins on a slab */
+    if (fabsf(d) < 1e-20f) return d < 0.0f ? -1e20f : 1e20f;
+    return 1.0f / d;
+}
+
+static void raycast_packet_add(raycast_packet* packet, gjk_vec2 origin, gjk_vec2 translation, gjk_vec2 extent)
+{
+    size_t i = packet->count++;
+    packet->origin_x[i] = origin.x;
+    packet->origin_y[i] = origin.y;
+    packet->inv_x[i] = raycast_inverse(translation.x);
+    packet->inv_y[i] = raycast_inverse(translation.y);
+    packet->extent_x[i] = extent.x;
+    packet->extent_y[i] = extent.y;
+    packet->max_fraction[i] = 1.0f;
+}
+
+/* returns the mask of the rays that enter aabb before their max fraction */
+static uint32_t raycast_packet_test(const raycast_packet* packet, gjk_aabb aabb, float* entry)
+{
+    float lower[RAYCAST_PACKET_SIZE];
+    float upper[RAYCAST_PACKET_SIZE];
+
+    for (size_t i = 0; i < RAYCAST_PACKET_SIZE; ++i)
+    {
+        float x1 = (aabb.min.x - packet->extent_x[i] - packet->origin_x[i]) * packet->inv_x[i];
+        float x2 = (aabb.max.x + packet->extent_x[i] - packet->origin_x[i]) * packet->inv_x[i];
+        float y1 = (aabb.min.y - packet->extent_y[i] - packet->origin_y[i]) * packet->inv_y[i];
+        float y2 = (aabb.max.y + packet->extent_y[i] - packet->origin_y[i]) * packet->inv_y[i];
+
+        /* plain compares instead of fminf and fmaxf, which are not inlined without fast math */
+        float x_lo = x1 < x2 ? x1 : x2, x_hi = x1 < x2 ? x2 : x1;
+        float y_lo = y1 < y2 ? y1 : y2, y_hi = y1 < y2 ? y2 : y1;
+        float lo = x_lo > y_lo ? x_lo : y_lo;
+        float hi = x_hi < y_hi ? x_hi : y_hi;
+        lower[i] = lo > 0.0f ? lo : 0.0f;
+        upper[i] = hi < packet->max_fraction[i] ? hi : packet->max_fraction[i];
+    }
+
+    uint32_t mask = 0;
+    float min = FLT_MAX;
+    for (size_t i = 0; i < packet->count; ++i)
+    {
+        if (lower[i] > upper[i]) continue;
+
+        mask |= 1u << i;
+        if (lower[i] < min) min = lower[i];
+    }
+    *entry = min;
+    return mask;
+}
+
+typedef uint8_t (*raycast_leaf_func)(const void* user, size_t index, const gjk_shape* shape, float max_fraction, raycast_hit* hit);
+
+/*
+ * depth first traversal for a whole packet. Children are visited nearest
+ * first, so the max fractions shrink early and cull the farther subtrees.
+ */
+static void raycast_packet_traverse(const aabb_tree* tree, raycast_entry* stack, raycast_packet* packet, const gjk_shape* shapes,
+                                    raycast_leaf_func func, const void* user, size_t first, raycast_hit* hits)
+{
+    for (size_t i = 0; i < packet->count; ++i)
+        hits[i].hit = 0;
+
+    float entry;
+    uint32_t mask = raycast_packet_test(packet, tree->nodes[tree->root].aabb, &entry);
+    if (!mask) return;
+
+    size_t top = 0;
+    stack[top++] = (raycast_entry) { tree->root, mask, entry };
+    while (top > 0)
+    {
+        raycast_entry current = stack[--top];
+
+        /* drop the rays that found a closer hit since the node was pushed */
+        mask = current.mask;
+        for (size_t i = 0; i < packet->count; ++i)
+            if (packet->max_fraction[i] < current.entry) mask &= ~(1u << i);
+        if (!mask) continue;
+
+        const aabb_tree_node* node = &tree->nodes[current.node];
+        if (node->height == 0)
+        {
+            for (size_t i = 0; i < packet->count; ++i)
+            {
+                if (!(mask & (1u << i))) continue;
+
+                raycast_hit hit;
+                if (!func(user, first + i, &shapes[node->shape], packet->max_fraction[i], &hit)) continue;
+
+                hit.shape = node->shape;
+                hits[i] = hit;
+                packet->max_fraction[i] = hit.fraction;
+            }
+            continue;
+        }
+
+        float entry_left, entry_right;
+        uint32_t left = raycast_packet_test(packet, tree->nodes[node->left].aabb, &entry_left) & mask;
+        uint32_t right = raycast_packet_test(packet, tree->nodes[node->right].aabb, &entry_right) & mask;
+
+        /* push the farther child first */
+        if (entry_left < entry_right)
+        {
+            if (right) stack[top++] = (raycast_entry) { node->right, right, entry_right };
+            if (left)  stack[top++] = (raycast_entry) { node->left, left, entry_left };
+        }
+        else
+        {
+            if (left)  stack[top++] = (raycast_entry) { node->left, left, entry_left };
+            if (right) stack[top++] = (raycast_entry) { node->right, right, entry_right };
+        }
+    }
+}
+
+static uint8_t raycast_leaf_ray(const void* user, size_t index, const gjk_shape* shape, float max_fraction, raycast_hit* hit)
+{
+    const raycast_ray* rays = user;
+    return raycast_shape(shape, rays[index], max_fraction, hit);
+}
+
+typedef struct
+{
+    const gjk_shape* casts;
+    const gjk_vec2* translations;
+} raycast_casts;
+
+static uint8_t raycast_leaf_cast(const void* user, size_t index, const gjk_shape* shape, float max_fraction, raycast_hit* hit)
+{
+    const raycast_casts* casts = user;
+    return raycast_advance(&casts->casts[index], casts->translations[index], shape, max_fraction, hit);
+}
+
+/* every node on the way down pushes at most two entries */
+static raycast_entry* raycast_alloc_stack(const aabb_tree* tree)
+{
+    return malloc(sizeof(raycast_entry) * (2 * (size_t)aabb_tree_get_height(tree) + 2));
+}
+
+static void raycast_packet_init(raycast_packet* packet)
+{
+    /* unused lanes never enter anything */
+    for (size_t i = 0; i < RAYCAST_PACKET_SIZE; ++i)
+    {
+        packet->origin_x[i] = packet->origin_y[i] = 0.0f;
+        packet->inv_x[i] = packet->inv_y[i] = 1.0f;
+        packet->extent_x[i] = packet->extent_y[i] = 0.0f;
+        packet->max_fraction[i] = -1.0f;
+    }
+    packet->count = 0;
+}
+
+void raycast_batch(const aabb_tree* tree, const gjk_shape* shapes, const raycast_ray* rays, size_t count, raycast_hit* hits)
+{
+    raycast_entry* stack = tree->root != AABB_TREE_NULL ? raycast_alloc_stack(tree) : NULL;
+    if (!stack)
+    {
+        for (size_t i = 0; i < count; ++i)
+            hits[i].hit = 0;
+        return;
+    }
+
+    for (size_t first = 0; first < count; first += RAYCAST_PACKET_SIZE)
+    {
+        raycast_packet packet;
+        raycast_packet_init(&packet);
+
+        size_t end = first + RAYCAST_PACKET_SIZE < count ? first + RAYCAST_PACKET_SIZE : count;
+        for (size_t i = first; i < end; ++i)
+            raycast_packet_add(&packet, rays[i].origin, rays[i].translation, (gjk_vec2) { 0.0f, 0.0f });
+
+        raycast_packet_traverse(tree, stack, &packet, shapes, raycast_leaf_ray, rays, first, hits + first);
+    }
+
+    free(stack);
+}
+
+void raycast_shape_cast_batch(const aabb_tree* tree, const gjk_shape* shapes, const gjk_shape* casts, const gjk_vec2* translations, size_t count, raycast_hit* hits)
+{
+    raycast_entry* stack = tree->root != AABB_TREE_NULL ? raycast_alloc_stack(tree) : NULL;
+    if (!stack)
+    {
+        for (size_t i = 0; i < count; ++i)
+            hits[i].hit = 0;
+        return;
+    }
+
+    raycast_casts user = { casts, translations };
+    for (size_t first = 0; first < count; first += RAYCAST_PACKET_SIZE)
+    {
+        raycast_packet packet;
+        raycast_packet_init(&packet);
+
+        size_t end = first + RAYCAST_PACKET_SIZE < count ? first + RAYCAST_PACKET_SIZE : count;
+        for (size_t i = first; i < end; ++i)
+        {
+            gjk_aabb aabb = gjk_shape_aabb(&casts[i]);
+            gjk_vec2 center = { 0.5f * (aabb.min.x + aabb.max.x), 0.5f * (aabb.min.y + aabb.max.y) };
+            gjk_vec2 extent = { 0.5f * (aabb.max.x - aabb.min.x), 0.5f * (aabb.max.y - aabb.min.y) };
+            raycast_packet_add(&packet, center, translations[i], extent);
+        }
+
+        raycast_packet_traverse(tree, stack, &packet, shapes, raycast_leaf_cast, &user, first, hits + first);
+    }
+
+    free(stack);
+}
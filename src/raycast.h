@@ -0,0 +1,63 @@
+#ifndef RAYCAST_H
+#define RAYCAST_H
+
+#include "gjk.h"
+#include "aabb_tree.h"
+
+/*
+ * Ray casts and shape casts. Rays are segments from origin to origin +
+ * translation, a hit is reported by the fraction of the translation.
+ * Circles, ellipses, boxes and polygons are intersected in closed form, the
+ * other shapes and all shape casts advance along the translation with
+ * gjk_closest_points until the surfaces touch.
+ * A cast that starts inside a shape hits it at fraction 0 with a zero normal.
+ */
+
+typedef struct
+{
+    gjk_vec2 origin;
+    gjk_vec2 translation;
+} raycast_ray;
+
+typedef struct
+{
+    gjk_vec2 point;  /* on the surface of the shape that was hit */
+    gjk_vec2 normal; /* surface normal at point, facing the cast */
+    float fraction;  /* of the translation */
+    uint32_t shape;  /* index of the shape, only set by the batch queries */
+    uint8_t hit;
+} raycast_hit;
+
+/* distance to the surface at which a gjk based cast counts as a hit */
+#define RAYCAST_TOLERANCE      0.001f
+#define RAYCAST_MAX_ITERATIONS 32
+
+/* rays of a batch that are traversed together */
+#define RAYCAST_PACKET_SIZE 8
+
+/* returns 1 if the ray hits the shape before max_fraction */
+uint8_t raycast_shape(const gjk_shape* shape, raycast_ray ray, float max_fraction, raycast_hit* hit);
+
+/* moves cast along translation and returns 1 if it touches target before max_fraction */
+uint8_t raycast_shape_cast(const gjk_shape* cast, gjk_vec2 translation, const gjk_shape* target, float max_fraction, raycast_hit* hit);
+
+/*
+ * nearest hit for every ray against the shapes in the tree, the leaves of the
+ * tree index into shapes. Consecutive rays are traversed as packets of
+ * RAYCAST_PACKET_SIZE, a node is visited once for all rays of a packet that
+ * can still hit something inside. Rays that start close to each other and
+ * point in similar directions, like the rays of one viewer, should be passed
+ * next to each other.
+ * The tree is only read and the traversal stack is allocated per call, so
+ * several threads can cast against the same tree while it is not modified.
+ */
+void raycast_batch(const aabb_tree* tree, const gjk_shape* shapes, const raycast_ray* rays, size_t count, raycast_hit* hits);
+
+/*
+ * nearest hit for every shape in casts moved by its translation. The tree is
+ * traversed with the aabbs of the casts, so a cast shape that is in the tree
+ * itself hits itself at fraction 0. Reads the tree like raycast_batch.
+ */
+void raycast_shape_cast_batch(const aabb_tree* tree, const gjk_shape* shapes, const gjk_shape* casts, const gjk_vec2* translations, size_t count, raycast_hit* hits);
+
+#endif // !RAYCAST_H
@@ -0,0 +1,136 @@
+#include "scene_graph.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define SCENE_GRAPH_INITIAL_CAPACITY 64
+
+void scene_graph_init(scene_graph* graph)
+{
+    memset(graph, 0, sizeof(*graph));
+}
+
+void scene_graph_destroy(scene_graph* graph)
+{
+    free(graph->parents);
+    free(graph->translations);
+    free(graph->rotations);
+    free(graph->scales);
+    free(graph->locals);
+    free(graph->worlds);
+    free(graph->flags);
+    memset(graph, 0, sizeof(*graph));
+}
+
+static uint8_t scene_graph_reserve(scene_graph* graph)
+{
+    if (graph->count < graph->capacity) return 1;
+
+    int32_t capacity = graph->capacity ? graph->capacity * 2 : SCENE_GRAPH_INITIAL_CAPACITY;
+
+    int32_t* parents = realloc(graph->parents, sizeof(int32_t) * capacity);
+    if (parents) graph->parents = parents;
+    vec3* translations = realloc(graph->translations, sizeof(vec3) * capacity);
+    if (translations) graph->translations = translations;
+    quat* rotations = realloc(graph->rotations, sizeof(quat) * capacity);
+    if (rotations) graph->rotations = rotations;
+    vec3* scales = realloc(graph->scales, sizeof(vec3) * capacity);
+    if (scales) graph->scales = scales;
+    mat4* locals = realloc(graph->locals, sizeof(mat4) * capacity);
+    if (locals) graph->locals = locals;
+    mat4* worlds = realloc(graph->worlds, sizeof(mat4) * capacity);
+    if (worlds) graph->worlds = worlds;
+    uint8_t* flags = realloc(graph->flags, sizeof(uint8_t) * capacity);
+    if (flags) graph->flags = flags;
+
+    if (!parents || !translations || !rotations || !scales || !locals || !worlds || !flags) return 0;
+
+    graph->capacity = capacity;
+    return 1;
+}
+
+static void scene_graph_mark(scene_graph* graph, int32_t node)
+{
+    graph->flags[node] |= SCENE_GRAPH_DIRTY;
+    if (node < graph->first_dirty) graph->first_dirty = node;
+}
+
+int32_t scene_graph_add(scene_graph* graph, int32_t parent, vec3 translation, quat rotation, vec3 scale)
+{
+    if (parent < SCENE_GRAPH_NULL || parent >= graph->count) return SCENE_GRAPH_NULL;
+    if (!scene_graph_reserve(graph)) return SCENE_GRAPH_NULL;
+
+    int32_t node = graph->count++;
+    graph->parents[node] = parent;
+    graph->translations[node] = translation;
+    graph->rotations[node] = rotation;
+    graph->scales[node] = scale;
+    graph->flags[node] = 0;
+    scene_graph_mark(graph, node);
+    return node;
+}
+
+void scene_graph_set_translation(scene_graph* graph, int32_t node, vec3 translation)
+{
+    graph->translations[node] = translation;
+    scene_graph_mark(graph, node);
+}
+
+void scene_graph_set_rotation(scene_graph* graph, int32_t node, quat rotation)
+{
+    graph->rotations[node] = rotation;
+    scene_graph_mark(graph, node);
+}
+
+void scene_graph_set_scale(scene_graph* graph, int32_t node, vec3 scale)
+{
+    graph->scales[node] = scale;
+    scene_graph_mark(graph, node);
+}
+
+/* translation * rotation * scale, the scale goes into the rotation columns */
+static mat4 scene_graph_local(vec3 t, quat r, vec3 s)
+{
+    mat4 m = mat4_cast(r);
+    for (int i = 0; i < 3; ++i)
+    {
+        m.v[0][i] *= s.x;
+        m.v[1][i] *= s.y;
+        m.v[2][i] *= s.z;
+    }
+    m.v[3][0] = t.x;
+    m.v[3][1] = t.y;
+    m.v[3][2] = t.z;
+    return m;
+}
+
+int32_t scene_graph_update(scene_graph* graph)
+{
+    int32_t first = graph->first_dirty;
+
+    /* the nodes in front of the first dirty one keep their worlds, only their flags of the last update go */
+    for (int32_t i = graph->first_moved; i < first; ++i)
+        graph->flags[i] &= ~SCENE_GRAPH_MOVED;
+
+    int32_t updated = 0;
+    for (int32_t i = first; i < graph->count; ++i)
+    {
+        uint8_t flags = graph->flags[i];
+        int32_t parent = graph->parents[i];
+
+        /* parents in front of first did not move in this update, whatever their flags say */
+        uint8_t moved = (flags & SCENE_GRAPH_DIRTY) || (parent >= first && (graph->flags[parent] & SCENE_GRAPH_MOVED));
+        graph->flags[i] = moved ? SCENE_GRAPH_MOVED : 0;
+        if (!moved) continue;
+
+        if (flags & SCENE_GRAPH_DIRTY)
+            graph->locals[i] = scene_graph_local(graph->translations[i], graph->rotations[i], graph->scales[i]);
+
+        graph->worlds[i] = parent == SCENE_GRAPH_NULL ? graph->locals[i] : mat4_multiply(graph->worlds[parent], graph->locals[i]);
+        updated++;
+    }
+
+    graph->first_moved = first;
+    graph->first_dirty = graph->count;
+    return updated;
+}
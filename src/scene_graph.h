@@ -0,0 +1,52 @@
+#ifndef SCENE_GRAPH_H
+#define SCENE_GRAPH_H
+
+#include <stdint.h>
+
+#include "math/quat.h"
+
+/*
+ * Flat transform hierarchy. Nodes live in contiguous arrays and a parent is
+ * always stored before its children, so one linear pass computes every
+ * world matrix after the one of its parent. Setting a local transform only
+ * marks the node dirty. The update starts at the first dirty node and only
+ * recomputes the nodes that are dirty or whose parent moved, everything in
+ * front of the first dirty node cannot depend on it. A scene without
+ * changes costs nothing to update.
+ */
+
+#define SCENE_GRAPH_NULL (-1)
+
+#define SCENE_GRAPH_DIRTY 0x01 /* local transform changed since the last update */
+#define SCENE_GRAPH_MOVED 0x02 /* world matrix recomputed by the last update */
+
+typedef struct
+{
+    int32_t* parents;
+    vec3* translations;
+    quat* rotations;
+    vec3* scales;
+    mat4* locals;
+    mat4* worlds;   /* valid after scene_graph_update */
+    uint8_t* flags;
+    int32_t count;
+    int32_t capacity;
+
+    int32_t first_dirty; /* count if no node is dirty */
+    int32_t first_moved; /* first node the last update visited */
+} scene_graph;
+
+void scene_graph_init(scene_graph* graph);
+void scene_graph_destroy(scene_graph* graph);
+
+/* parent has to be an existing node or SCENE_GRAPH_NULL, returns SCENE_GRAPH_NULL if out of memory */
+int32_t scene_graph_add(scene_graph* graph, int32_t parent, vec3 translation, quat rotation, vec3 scale);
+
+void scene_graph_set_translation(scene_graph* graph, int32_t node, vec3 translation);
+void scene_graph_set_rotation(scene_graph* graph, int32_t node, quat rotation);
+void scene_graph_set_scale(scene_graph* graph, int32_t node, vec3 scale);
+
+/* returns the number of world matrices recomputed */
+int32_t scene_graph_update(scene_graph* graph);
+
+#endif // !SCENE_GRAPH_H
@@ -0,0 +1,186 @@
+#include "spatial_hash.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+static uint32_t spatial_hash_slot(const spatial_hash* hash, int32_t x, int32_t y)
+{
+    uint32_t h = ((uint32_t)x * 73856093u) ^ ((uint32_t)y * 19349663u);
+    return h & (hash->table_size - 1);
+}
+
+static int32_t spatial_hash_cell(const spatial_hash* hash, float f)
+{
+    return (int32_t)floorf(f * hash->inv_cell_size);
+}
+
+static uint8_t spatial_hash_reserve(void** buffer, size_t* capacity, size_t size, size_t element)
+{
+    if (size <= *capacity) return 1;
+
+    size_t new_capacity = *capacity ? *capacity : 64;
+    while (new_capacity < size) new_capacity *= 2;
+
+    void* new_buffer = realloc(*buffer, new_capacity * element);
+    if (!new_buffer) return 0;
+
+    *buffer = new_buffer;
+    *capacity = new_capacity;
+    return 1;
+}
+
+void spatial_hash_init(spatial_hash* hash, float cell_size)
+{
+    hash->cell_size = cell_size;
+    hash->inv_cell_size = 1.0f / cell_size;
+
+    hash->cell_start = NULL;
+    hash->table_size = 0;
+
+    hash->entries = NULL;
+    hash->entry_count = 0;
+    hash->entry_capacity = 0;
+
+    hash->aabbs = NULL;
+    hash->cells = NULL;
+    hash->shape_count = 0;
+    hash->shape_capacity = 0;
+
+    hash->pairs = NULL;
+    hash->pair_count = 0;
+    hash->pair_capacity = 0;
+}
+
+void spatial_hash_destroy(spatial_hash* hash)
+{
+    free(hash->cell_start);
+    free(hash->entries);
+    free(hash->aabbs);
+    free(hash->cells);
+    free(hash->pairs);
+    spatial_hash_init(hash, hash->cell_size);
+}
+
+uint8_t spatial_hash_build(spatial_hash* hash, const gjk_shape* shapes, size_t count)
+{
+    hash->shape_count = 0;
+    hash->entry_count = 0;
+    hash->pair_count = 0;
+
+    size_t capacity = hash->shape_capacity;
+    if (!spatial_hash_reserve((void**)&hash->aabbs, &capacity, count, sizeof(gjk_aabb))) return 0;
+    if (capacity != hash->shape_capacity)
+    {
+        int32_t* cells = realloc(hash->cells, capacity * 4 * sizeof(int32_t));
+        if (!cells) return 0;
+        hash->cells = cells;
+        hash->shape_capacity = capacity;
+    }
+
+    /* compute the cell range of every shape */
+    size_t entry_count = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        gjk_aabb aabb = gjk_shape_aabb(&shapes[i]);
+        int32_t* cells = hash->cells + i * 4;
+
+        cells[0] = spatial_hash_cell(hash, aabb.min.x);
+        cells[1] = spatial_hash_cell(hash, aabb.min.y);
+        cells[2] = spatial_hash_cell(hash, aabb.max.x);
+        cells[3] = spatial_hash_cell(hash, aabb.max.y);
+
+        hash->aabbs[i] = aabb;
+        entry_count += (size_t)(cells[2] - cells[0] + 1) * (size_t)(cells[3] - cells[1] + 1);
+    }
+    hash->shape_count = count;
+
+    /* keep the table at least twice as large as the number of entries */
+    uint32_t table_size = 64;
+    while (table_size < 2 * entry_count) table_size *= 2;
+
+    if (table_size != hash->table_size)
+    {
+        uint32_t* cell_start = realloc(hash->cell_start, (table_size + 1) * sizeof(uint32_t));
+        if (!cell_start) return 0;
+        hash->cell_start = cell_start;
+        hash->table_size = table_size;
+    }
+
+    if (!spatial_hash_reserve((void**)&hash->entries, &hash->entry_capacity, entry_count, sizeof(uint32_t))) return 0;
+
+    /* counting sort of the entries by slot */
+    uint32_t* cell_start = hash->cell_start;
+    for (uint32_t i = 0; i <= table_size; ++i)
+        cell_start[i] = 0;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const int32_t* cells = hash->cells + i * 4;
+        for (int32_t y = cells[1]; y <= cells[3]; ++y)
+            for (int32_t x = cells[0]; x <= cells[2]; ++x)
+                cell_start[spatial_hash_slot(hash, x, y)]++;
+    }
+
+    /* inclusive prefix sum, cell_start[i] is the end of slot i and moves down to its start while filling */
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i <= table_size; ++i)
+    {
+        sum += cell_start[i];
+        cell_start[i] = sum;
+    }
+
+    /* shapes are inserted back to front so entries end up sorted per slot */
+    for (size_t i = count; i-- > 0;)
+    {
+        const int32_t* cells = hash->cells + i * 4;
+        for (int32_t y = cells[1]; y <= cells[3]; ++y)
+            for (int32_t x = cells[0]; x <= cells[2]; ++x)
+                hash->entries[--cell_start[spatial_hash_slot(hash, x, y)]] = (uint32_t)i;
+    }
+
+    hash->entry_count = entry_count;
+    return 1;
+}
+
+size_t spatial_hash_update_pairs(spatial_hash* hash)
+{
+    hash->pair_count = 0;
+
+    for (uint32_t slot = 0; slot < hash->table_size; ++slot)
+    {
+        uint32_t start = hash->cell_start[slot];
+        uint32_t end = hash->cell_start[slot + 1];
+
+        for (uint32_t i = start; i < end; ++i)
+        {
+            uint32_t a = hash->entries[i];
+
+            /* a shape covering multiple cells with the same slot */
+            if (i > start && hash->entries[i - 1] == a) continue;
+
+            gjk_aabb aabb = hash->aabbs[a];
+            for (uint32_t j = i + 1; j < end; ++j)
+            {
+                uint32_t b = hash->entries[j];
+                if (b == hash->entries[j - 1]) continue;
+
+                gjk_aabb other = hash->aabbs[b];
+                if (!gjk_aabb_overlap(aabb, other)) continue;
+
+                /* only report the pair in the slot of the first cell both shapes share */
+                int32_t x = spatial_hash_cell(hash, aabb.min.x > other.min.x ? aabb.min.x : other.min.x);
+                int32_t y = spatial_hash_cell(hash, aabb.min.y > other.min.y ? aabb.min.y : other.min.y);
+                if (spatial_hash_slot(hash, x, y) != slot) continue;
+
+                if (!spatial_hash_reserve((void**)&hash->pairs, &hash->pair_capacity, hash->pair_count + 1, sizeof(gjk_pair)))
+                    return hash->pair_count;
+
+                hash->pairs[hash->pair_count].a = a;
+                hash->pairs[hash->pair_count].b = b;
+                hash->pair_count++;
+            }
+        }
+    }
+
+    return hash->pair_count;
+}
@@ -0,0 +1,49 @@
+#ifndef SPATIAL_HASH_H
+#define SPATIAL_HASH_H
+
+#include "gjk.h"
+
+/*
+ * Uniform grid broadphase for scenes of similar sized shapes. The grid is
+ * rebuilt every frame in linear time with a counting sort, storing shape
+ * indices grouped by hashed cell in flat arrays.
+ */
+
+typedef struct
+{
+    float cell_size;
+    float inv_cell_size;
+
+    /* entries of slot i are entries[cell_start[i]] to entries[cell_start[i + 1]] */
+    uint32_t* cell_start;
+    uint32_t table_size; /* power of two */
+
+    uint32_t* entries;
+    size_t entry_count;
+    size_t entry_capacity;
+
+    /* per shape data of the last build */
+    gjk_aabb* aabbs;
+    int32_t* cells; /* min and max cell of every shape */
+    size_t shape_count;
+    size_t shape_capacity;
+
+    /* candidate pairs found by the last call to spatial_hash_update_pairs */
+    gjk_pair* pairs;
+    size_t pair_count;
+    size_t pair_capacity;
+} spatial_hash;
+
+void spatial_hash_init(spatial_hash* hash, float cell_size);
+void spatial_hash_destroy(spatial_hash* hash);
+
+/* inserts every shape into the grid, replacing the previous content */
+uint8_t spatial_hash_build(spatial_hash* hash, const gjk_shape* shapes, size_t count);
+
+/*
+ * collects all pairs of shapes with overlapping aabbs in hash->pairs.
+ * Every pair is reported once, even if both shapes share multiple cells.
+ */
+size_t spatial_hash_update_pairs(spatial_hash* hash);
+
+#endif // !SPATIAL_HASH_H
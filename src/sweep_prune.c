@@ -0,0 +1,492 @@
+#include "sweep_prune.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define SWEEP_PRUNE_EMPTY UINT32_MAX
+
+static uint8_t sweep_prune_reserve(void** buffer, size_t* capacity, size_t size, size_t element)
+{
+    if (size <= *capacity) return 1;
+
+    size_t new_capacity = *capacity ? *capacity : 64;
+    while (new_capacity < size) new_capacity *= 2;
+
+    void* new_buffer = realloc(*buffer, new_capacity * element);
+    if (!new_buffer) return 0;
+
+    *buffer = new_buffer;
+    *capacity = new_capacity;
+    return 1;
+}
+
+static void sweep_prune_push_event(gjk_pair** events, size_t* count, size_t* capacity, gjk_pair pair)
+{
+    if (!sweep_prune_reserve((void**)events, capacity, *count + 1, sizeof(gjk_pair))) return;
+    (*events)[(*count)++] = pair;
+}
+
+static uint8_t sweep_prune_reserve_shapes(sweep_prune* sp, size_t count)
+{
+    if (count <= sp->capacity) return 1;
+
+    size_t capacity = sp->capacity ? sp->capacity : 64;
+    while (capacity < count) capacity *= 2;
+
+    gjk_aabb* aabbs = realloc(sp->aabbs, sizeof(gjk_aabb) * capacity);
+    if (!aabbs) return 0;
+    sp->aabbs = aabbs;
+
+    uint8_t* active = realloc(sp->active, capacity);
+    if (!active) return 0;
+    memset(active + sp->capacity, 0, capacity - sp->capacity);
+    sp->active = active;
+
+    for (int axis = 0; axis < 2; ++axis)
+    {
+        sweep_prune_endpoint* endpoints = realloc(sp->endpoints[axis], sizeof(sweep_prune_endpoint) * 2 * capacity);
+        if (!endpoints) return 0;
+        sp->endpoints[axis] = endpoints;
+
+        uint32_t* positions = realloc(sp->positions[axis], sizeof(uint32_t) * 2 * capacity);
+        if (!positions) return 0;
+        sp->positions[axis] = positions;
+    }
+
+    sp->capacity = capacity;
+    return 1;
+}
+
+// ---------------| pair set |-------------------------------------
+
+static gjk_pair sweep_prune_make_pair(uint32_t a, uint32_t b)
+{
+    gjk_pair pair = { a < b ? a : b, a < b ? b : a };
+    return pair;
+}
+
+static size_t sweep_prune_hash(const sweep_prune* sp, gjk_pair pair)
+{
+    uint32_t h = (pair.a * 0x9E3779B1u) ^ (pair.b * 0x85EBCA6Bu);
+    h ^= h >> 15;
+    return h & (sp->slot_count - 1);
+}
+
+/* returns the slot of the pair or the empty slot it would be inserted at */
+static size_t sweep_prune_find_slot(const sweep_prune* sp, gjk_pair pair)
+{
+    size_t mask = sp->slot_count - 1;
+    size_t i = sweep_prune_hash(sp, pair);
+    while (sp->slots[i].index != SWEEP_PRUNE_EMPTY)
+    {
+        if (sp->slots[i].pair.a == pair.a && sp->slots[i].pair.b == pair.b) break;
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+static uint8_t sweep_prune_rehash(sweep_prune* sp, size_t slot_count)
+{
+    sweep_prune_slot* slots = malloc(sizeof(sweep_prune_slot) * slot_count);
+    if (!slots) return 0;
+
+    free(sp->slots);
+    sp->slots = slots;
+    sp->slot_count = slot_count;
+
+    for (size_t i = 0; i < slot_count; ++i)
+        slots[i].index = SWEEP_PRUNE_EMPTY;
+
+    for (size_t i = 0; i < sp->pair_count; ++i)
+    {
+        size_t slot = sweep_prune_find_slot(sp, sp->pairs[i]);
+        slots[slot].pair = sp->pairs[i];
+        slots[slot].index = (uint32_t)i;
+    }
+    return 1;
+}
+
+static void sweep_prune_add_pair(sweep_prune* sp, uint32_t a, uint32_t b)
+{
+    gjk_pair pair = sweep_prune_make_pair(a, b);
+
+    /* keep the load factor below one half */
+    if (2 * (sp->pair_count + 1) > sp->slot_count)
+    {
+        if (!sweep_prune_rehash(sp, sp->slot_count ? sp->slot_count * 2 : 128)) return;
+    }
+
+    size_t slot = sweep_prune_find_slot(sp, pair);
+    if (sp->slots[slot].index != SWEEP_PRUNE_EMPTY) return;
+
+    if (sp->pair_count + 1 > sp->pair_capacity)
+    {
+        size_t capacity = sp->pair_capacity;
+        if (!sweep_prune_reserve((void**)&sp->pairs, &capacity, sp->pair_count + 1, sizeof(gjk_pair))) return;
+
+        gjk_cache* caches = realloc(sp->caches, sizeof(gjk_cache) * capacity);
+        if (!caches) return;
+
+        sp->caches = caches;
+        sp->pair_capacity = capacity;
+    }
+
+    sp->slots[slot].pair = pair;
+    sp->slots[slot].index = (uint32_t)sp->pair_count;
+    gjk_cache_reset(&sp->caches[sp->pair_count]);
+    sp->pairs[sp->pair_count++] = pair;
+
+    sweep_prune_push_event(&sp->added, &sp->added_count, &sp->added_capacity, pair);
+}
+
+static void sweep_prune_remove_pair(sweep_prune* sp, uint32_t a, uint32_t b)
+{
+    if (!sp->slot_count) return;
+
+    gjk_pair pair = sweep_prune_make_pair(a, b);
+    size_t slot = sweep_prune_find_slot(sp, pair);
+    uint32_t index = sp->slots[slot].index;
+    if (index == SWEEP_PRUNE_EMPTY) return;
+
+    /* move the last pair into the gap of the dense array */
+    gjk_pair last = sp->pairs[--sp->pair_count];
+    if (index != sp->pair_count)
+    {
+        sp->pairs[index] = last;
+        sp->caches[index] = sp->caches[sp->pair_count];
+        sp->slots[sweep_prune_find_slot(sp, last)].index = index;
+    }
+
+    /* backward shift deletion keeps the probe sequences intact */
+    size_t mask = sp->slot_count - 1;
+    size_t hole = slot;
+    size_t i = (slot + 1) & mask;
+    while (sp->slots[i].index != SWEEP_PRUNE_EMPTY)
+    {
+        size_t home = sweep_prune_hash(sp, sp->slots[i].pair);
+        /* move the entry if its home is not between the hole and its slot */
+        if (((i - home) & mask) >= ((i - hole) & mask))
+        {
+            sp->slots[hole] = sp->slots[i];
+            hole = i;
+        }
+        i = (i + 1) & mask;
+    }
+    sp->slots[hole].index = SWEEP_PRUNE_EMPTY;
+
+    sweep_prune_push_event(&sp->removed, &sp->removed_count, &sp->removed_capacity, pair);
+}
+
+// ---------------| endpoints |------------------------------------
+
+static float sweep_prune_value(gjk_aabb aabb, int axis, uint32_t max)
+{
+    gjk_vec2 v = max ? aabb.max : aabb.min;
+    return axis ? v.y : v.x;
+}
+
+/*
+ * order of the endpoints on an axis, shared by the insertion sorts and the
+ * full sort: by value, min endpoints before max endpoints on equal values
+ * so touching aabbs count as overlapping
+ */
+static int sweep_prune_less(sweep_prune_endpoint a, sweep_prune_endpoint b)
+{
+    if (a.value != b.value) return a.value < b.value;
+    return !(a.id & 1) && (b.id & 1);
+}
+
+/* moves the endpoint at pos to the left until the axis is sorted again */
+static void sweep_prune_sort_down(sweep_prune* sp, int axis, size_t pos)
+{
+    sweep_prune_endpoint* endpoints = sp->endpoints[axis];
+    uint32_t* positions = sp->positions[axis];
+    sweep_prune_endpoint endpoint = endpoints[pos];
+
+    uint32_t shape = endpoint.id >> 1;
+    while (pos > 0 && sweep_prune_less(endpoint, endpoints[pos - 1]))
+    {
+        sweep_prune_endpoint prev = endpoints[pos - 1];
+        uint32_t other = prev.id >> 1;
+
+        if (other != shape)
+        {
+            uint32_t is_max = endpoint.id & 1;
+            uint32_t prev_max = prev.id & 1;
+
+            /* min passing a max starts overlapping on this axis, max passing a min stops */
+            if (!is_max && prev_max)
+            {
+                if (gjk_aabb_overlap(sp->aabbs[shape], sp->aabbs[other]))
+                    sweep_prune_add_pair(sp, shape, other);
+            }
+            else if (is_max && !prev_max)
+            {
+                sweep_prune_remove_pair(sp, shape, other);
+            }
+        }
+
+        endpoints[pos] = prev;
+        positions[prev.id] = (uint32_t)pos;
+        pos--;
+    }
+
+    endpoints[pos] = endpoint;
+    positions[endpoint.id] = (uint32_t)pos;
+}
+
+/* moves the endpoint at pos to the right until the axis is sorted again */
+static void sweep_prune_sort_up(sweep_prune* sp, int axis, size_t pos)
+{
+    sweep_prune_endpoint* endpoints = sp->endpoints[axis];
+    uint32_t* positions = sp->positions[axis];
+    sweep_prune_endpoint endpoint = endpoints[pos];
+
+    uint32_t shape = endpoint.id >> 1;
+    while (pos + 1 < sp->endpoint_count && sweep_prune_less(endpoints[pos + 1], endpoint))
+    {
+        sweep_prune_endpoint next = endpoints[pos + 1];
+        uint32_t other = next.id >> 1;
+
+        if (other != shape)
+        {
+            uint32_t is_max = endpoint.id & 1;
+            uint32_t next_max = next.id & 1;
+
+            /* max passing a min starts overlapping on this axis, min passing a max stops */
+            if (is_max && !next_max)
+            {
+                if (gjk_aabb_overlap(sp->aabbs[shape], sp->aabbs[other]))
+                    sweep_prune_add_pair(sp, shape, other);
+            }
+            else if (!is_max && next_max)
+            {
+                sweep_prune_remove_pair(sp, shape, other);
+            }
+        }
+
+        endpoints[pos] = next;
+        positions[next.id] = (uint32_t)pos;
+        pos++;
+    }
+
+    endpoints[pos] = endpoint;
+    positions[endpoint.id] = (uint32_t)pos;
+}
+
+static void sweep_prune_update_endpoint(sweep_prune* sp, int axis, uint32_t id, float value)
+{
+    size_t pos = sp->positions[axis][id];
+    float old = sp->endpoints[axis][pos].value;
+    sp->endpoints[axis][pos].value = value;
+
+    if (value < old)      sweep_prune_sort_down(sp, axis, pos);
+    else if (value > old) sweep_prune_sort_up(sp, axis, pos);
+}
+
+// ---------------| public |---------------------------------------
+
+void sweep_prune_init(sweep_prune* sp)
+{
+    memset(sp, 0, sizeof(sweep_prune));
+}
+
+void sweep_prune_destroy(sweep_prune* sp)
+{
+    for (int axis = 0; axis < 2; ++axis)
+    {
+        free(sp->endpoints[axis]);
+        free(sp->positions[axis]);
+    }
+    free(sp->aabbs);
+    free(sp->active);
+    free(sp->pairs);
+    free(sp->caches);
+    free(sp->slots);
+    free(sp->added);
+    free(sp->removed);
+    sweep_prune_init(sp);
+}
+
+static int sweep_prune_compare(const void* a, const void* b)
+{
+    const sweep_prune_endpoint* ea = a;
+    const sweep_prune_endpoint* eb = b;
+    if (sweep_prune_less(*ea, *eb)) return -1;
+    if (sweep_prune_less(*eb, *ea)) return 1;
+    return 0;
+}
+
+uint8_t sweep_prune_build(sweep_prune* sp, const gjk_shape* shapes, size_t count)
+{
+    if (!sweep_prune_reserve_shapes(sp, count)) return 0;
+
+    /* clear the pair set */
+    sp->pair_count = 0;
+    for (size_t i = 0; i < sp->slot_count; ++i)
+        sp->slots[i].index = SWEEP_PRUNE_EMPTY;
+
+    memset(sp->active, 0, sp->capacity);
+    for (size_t i = 0; i < count; ++i)
+    {
+        sp->aabbs[i] = gjk_shape_aabb(&shapes[i]);
+        sp->active[i] = 1;
+    }
+
+    sp->endpoint_count = 2 * count;
+    for (int axis = 0; axis < 2; ++axis)
+    {
+        sweep_prune_endpoint* endpoints = sp->endpoints[axis];
+        for (uint32_t id = 0; id < 2 * count; ++id)
+        {
+            endpoints[id].value = sweep_prune_value(sp->aabbs[id >> 1], axis, id & 1);
+            endpoints[id].id = id;
+        }
+
+        qsort(endpoints, sp->endpoint_count, sizeof(sweep_prune_endpoint), sweep_prune_compare);
+
+        for (size_t pos = 0; pos < sp->endpoint_count; ++pos)
+            sp->positions[axis][endpoints[pos].id] = (uint32_t)pos;
+    }
+
+    /* sweep the x axis once, keeping a list of open intervals */
+    uint32_t* open = malloc(sizeof(uint32_t) * (count + 1));
+    uint32_t* open_index = malloc(sizeof(uint32_t) * (count + 1));
+    if (!open || !open_index)
+    {
+        free(open);
+        free(open_index);
+        return 0;
+    }
+
+    size_t open_count = 0;
+    for (size_t pos = 0; pos < sp->endpoint_count; ++pos)
+    {
+        uint32_t id = sp->endpoints[0][pos].id;
+        uint32_t shape = id >> 1;
+
+        if (id & 1)
+        {
+            /* close the interval */
+            uint32_t index = open_index[shape];
+            open[index] = open[--open_count];
+            open_index[open[index]] = index;
+            continue;
+        }
+
+        gjk_aabb aabb = sp->aabbs[shape];
+        for (size_t i = 0; i < open_count; ++i)
+        {
+            gjk_aabb other = sp->aabbs[open[i]];
+            if (aabb.min.y <= other.max.y && aabb.max.y >= other.min.y)
+                sweep_prune_add_pair(sp, shape, open[i]);
+        }
+
+        open_index[shape] = (uint32_t)open_count;
+        open[open_count++] = shape;
+    }
+
+    free(open);
+    free(open_index);
+    return 1;
+}
+
+uint8_t sweep_prune_insert(sweep_prune* sp, uint32_t shape, gjk_aabb aabb)
+{
+    if (!sweep_prune_reserve_shapes(sp, (size_t)shape + 1)) return 0;
+    if (sp->active[shape]) return 0;
+
+    sp->aabbs[shape] = aabb;
+    sp->active[shape] = 1;
+
+    /* append both endpoints and let them sort down from the end */
+    size_t pos = sp->endpoint_count;
+    sp->endpoint_count += 2;
+
+    for (int axis = 0; axis < 2; ++axis)
+    {
+        uint32_t min_id = shape << 1;
+        uint32_t max_id = min_id | 1;
+
+        sp->endpoints[axis][pos].value = sweep_prune_value(aabb, axis, 0);
+        sp->endpoints[axis][pos].id = min_id;
+        sp->endpoints[axis][pos + 1].value = sweep_prune_value(aabb, axis, 1);
+        sp->endpoints[axis][pos + 1].id = max_id;
+        sp->positions[axis][min_id] = (uint32_t)pos;
+        sp->positions[axis][max_id] = (uint32_t)pos + 1;
+
+        /* the min is sorted first, the max would stop at it otherwise */
+        sweep_prune_sort_down(sp, axis, pos);
+        sweep_prune_sort_down(sp, axis, pos + 1);
+    }
+
+    return 1;
+}
+
+void sweep_prune_remove(sweep_prune* sp, uint32_t shape)
+{
+    if (shape >= sp->capacity || !sp->active[shape]) return;
+
+    for (int axis = 0; axis < 2; ++axis)
+    {
+        sweep_prune_endpoint* endpoints = sp->endpoints[axis];
+        size_t write = 0;
+        for (size_t read = 0; read < sp->endpoint_count; ++read)
+        {
+            if ((endpoints[read].id >> 1) == shape) continue;
+
+            endpoints[write] = endpoints[read];
+            sp->positions[axis][endpoints[write].id] = (uint32_t)write;
+            write++;
+        }
+    }
+    sp->endpoint_count -= 2;
+    sp->active[shape] = 0;
+
+    for (size_t i = sp->pair_count; i-- > 0;)
+    {
+        gjk_pair pair = sp->pairs[i];
+        if (pair.a == shape || pair.b == shape)
+            sweep_prune_remove_pair(sp, pair.a, pair.b);
+    }
+}
+
+void sweep_prune_move(sweep_prune* sp, uint32_t shape, gjk_aabb aabb)
+{
+    if (shape >= sp->capacity || !sp->active[shape]) return;
+
+    gjk_aabb old = sp->aabbs[shape];
+    sp->aabbs[shape] = aabb;
+
+    uint32_t min_id = shape << 1;
+    uint32_t max_id = min_id | 1;
+
+    /* update the leading endpoint first so min and max never cross */
+    if (aabb.min.x < old.min.x)
+    {
+        sweep_prune_update_endpoint(sp, 0, min_id, aabb.min.x);
+        sweep_prune_update_endpoint(sp, 0, max_id, aabb.max.x);
+    }
+    else
+    {
+        sweep_prune_update_endpoint(sp, 0, max_id, aabb.max.x);
+        sweep_prune_update_endpoint(sp, 0, min_id, aabb.min.x);
+    }
+
+    if (aabb.min.y < old.min.y)
+    {
+        sweep_prune_update_endpoint(sp, 1, min_id, aabb.min.y);
+        sweep_prune_update_endpoint(sp, 1, max_id, aabb.max.y);
+    }
+    else
+    {
+        sweep_prune_update_endpoint(sp, 1, max_id, aabb.max.y);
+        sweep_prune_update_endpoint(sp, 1, min_id, aabb.min.y);
+    }
+}
+
+void sweep_prune_clear_events(sweep_prune* sp)
+{
+    sp->added_count = 0;
+    sp->removed_count = 0;
+}
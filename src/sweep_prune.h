@@ -0,0 +1,75 @@
+#ifndef SWEEP_PRUNE_H
+#define SWEEP_PRUNE_H
+
+#include "gjk.h"
+
+/*
+ * Incremental sweep and prune broadphase. Endpoints of the aabbs are kept
+ * sorted per axis and are only moved by insertion sort when a shape moves,
+ * so scenes with little movement between frames cost close to O(n + k).
+ * Overlapping pairs are kept in a persistent set and changes are reported
+ * as add and remove events.
+ */
+
+typedef struct
+{
+    float value;
+    uint32_t id; /* shape << 1, lowest bit set for max endpoints */
+} sweep_prune_endpoint;
+
+typedef struct
+{
+    gjk_pair pair;
+    uint32_t index; /* index into the pairs array, UINT32_MAX for empty slots */
+} sweep_prune_slot;
+
+typedef struct
+{
+    sweep_prune_endpoint* endpoints[2];
+    uint32_t* positions[2]; /* position of every endpoint id in its axis */
+    size_t endpoint_count;
+
+    /* indexed by shape */
+    gjk_aabb* aabbs;
+    uint8_t* active;
+    size_t capacity;
+
+    /* 
+     * set of overlapping pairs, the pairs array can be passed to gjk_collide_batch.
+     * caches[i] keeps the gjk state of pairs[i] alive while the pair overlaps.
+     */
+    gjk_pair* pairs;
+    gjk_cache* caches;
+    size_t pair_count;
+    size_t pair_capacity;
+
+    sweep_prune_slot* slots;
+    size_t slot_count; /* power of two */
+
+    /* events since the last call to sweep_prune_clear_events */
+    gjk_pair* added;
+    size_t added_count;
+    size_t added_capacity;
+
+    gjk_pair* removed;
+    size_t removed_count;
+    size_t removed_capacity;
+} sweep_prune;
+
+void sweep_prune_init(sweep_prune* sp);
+void sweep_prune_destroy(sweep_prune* sp);
+
+/* replaces the content with all shapes, sorting from scratch */
+uint8_t sweep_prune_build(sweep_prune* sp, const gjk_shape* shapes, size_t count);
+
+uint8_t sweep_prune_insert(sweep_prune* sp, uint32_t shape, gjk_aabb aabb);
+
+/* compacts the endpoints of both axes, O(n) in the number of shapes */
+void sweep_prune_remove(sweep_prune* sp, uint32_t shape);
+
+/* call after moving a shape, e.g. with gjk_set_center */
+void sweep_prune_move(sweep_prune* sp, uint32_t shape, gjk_aabb aabb);
+
+void sweep_prune_clear_events(sweep_prune* sp);
+
+#endif // !SWEEP_PRUNE_H
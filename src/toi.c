@@ -0,0 +1,81 @@
+#include "toi.h"
+
+#include <math.h>
+
+/*
+ * largest distance of a point of the core from the center, bounds the speed
+ * of rotating points. The radius of round shapes is rotation invariant.
+ */
+static float toi_extent(const gjk_shape* shape)
+{
+    return shape->bounding_radius - shape->radius;
+}
+
+gjk_shape toi_advance(const gjk_shape* shape, toi_motion motion, float t)
+{
+    gjk_shape result = *shape;
+    gjk_vec2 center = { shape->center.x + motion.velocity.x * t, shape->center.y + motion.velocity.y * t };
+
+    gjk_rot r = gjk_rotation(motion.angular_velocity * t);
+    gjk_rot rot = { shape->rot.c * r.c - shape->rot.s * r.s, shape->rot.s * r.c + shape->rot.c * r.s };
+    gjk_set_transform(&result, center, rot);
+    return result;
+}
+
+toi_state toi_query(const gjk_shape* s1, toi_motion m1, const gjk_shape* s2, toi_motion m2, float dt, float tolerance, toi_result* result)
+{
+    float spin = fabsf(m1.angular_velocity) * toi_extent(s1) + fabsf(m2.angular_velocity) * toi_extent(s2);
+    gjk_vec2 relative = gjk_sub(m1.velocity, m2.velocity);
+
+    /* advance to half the tolerance, so a hit ends up between 0 and tolerance */
+    float target = 0.5f * tolerance;
+
+    result->state = TOI_FAILED;
+    result->time = 0.0f;
+    result->normal = (gjk_vec2) { 0.0f, 0.0f };
+
+    float t = 0.0f;
+    for (uint32_t iteration = 0; iteration < TOI_MAX_ITERATIONS; ++iteration)
+    {
+        result->iterations = iteration + 1;
+
+        gjk_shape a = toi_advance(s1, m1, t);
+        gjk_shape b = toi_advance(s2, m2, t);
+
+        gjk_vec2 normal;
+        float distance = gjk_distance(&a, &b, &normal);
+        if (distance <= 0.0f)
+        {
+            /* only possible at the start, every advance stops short of contact */
+            result->state = t == 0.0f ? TOI_OVERLAP : TOI_HIT;
+            result->time = t;
+            return result->state;
+        }
+
+        if (distance < tolerance)
+        {
+            result->state = TOI_HIT;
+            result->time = t;
+            result->normal = normal;
+            return TOI_HIT;
+        }
+
+        /* upper bound of the speed at which any two points close the gap */
+        float speed = gjk_dot_product(relative, normal) + spin;
+        if (speed <= 0.0f)
+        {
+            result->state = TOI_SEPARATED;
+            return TOI_SEPARATED;
+        }
+
+        t += (distance - target) / speed;
+        if (t > dt)
+        {
+            result->state = TOI_SEPARATED;
+            return TOI_SEPARATED;
+        }
+        result->time = t;
+    }
+
+    return result->state;
+}
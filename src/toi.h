@@ -0,0 +1,50 @@
+#ifndef TOI_H
+#define TOI_H
+
+#include "gjk.h"
+
+/*
+ * Time of impact by conservative advancement. Both shapes move with constant
+ * linear and angular velocity over the step. Every iteration measures the
+ * distance with gjk_distance and advances time by the distance divided by an
+ * upper bound of the closing speed, so the shapes never pass through each
+ * other between two iterations, no matter how thin they are.
+ */
+
+typedef struct
+{
+    gjk_vec2 velocity;
+    float angular_velocity; /* radians per second around the center */
+} toi_motion;
+
+typedef enum
+{
+    TOI_SEPARATED, /* no contact within the step */
+    TOI_HIT,       /* surfaces closer than the tolerance at time */
+    TOI_OVERLAP,   /* already overlapping at the start of the step */
+    TOI_FAILED     /* out of iterations, time is a safe lower bound */
+} toi_state;
+
+typedef struct
+{
+    toi_state state;
+    float time;      /* in [0, dt] */
+    gjk_vec2 normal; /* from s1 towards s2 at time, only for hits */
+    uint32_t iterations;
+} toi_result;
+
+/*
+ * Most queries take 2 or 3 iterations. The slow case is the tip of a fast
+ * spinning shape grazing past another: the angular velocity times the extent
+ * overestimates the closing speed, so every iteration only advances a little.
+ * After this many iterations the query gives up with TOI_FAILED at a time
+ * the shapes do not touch before.
+ */
+#define TOI_MAX_ITERATIONS 256
+
+toi_state toi_query(const gjk_shape* s1, toi_motion m1, const gjk_shape* s2, toi_motion m2, float dt, float tolerance, toi_result* result);
+
+/* the shape at time t of its motion */
+gjk_shape toi_advance(const gjk_shape* shape, toi_motion motion, float t);
+
+#endif // !TOI_H
@@ -0,0 +1,623 @@
+#include "world.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <math.h>
+
+/* distance the aabbs in the broadphase are fattened by */
+#define WORLD_AABB_MARGIN 0.1f
+
+#define WORLD_INITIAL_CAPACITY 64
+
+struct world_constraint
+{
+    uint32_t a, b;
+    int32_t contact;
+    gjk_vec2 normal;
+    float friction;
+    struct
+    {
+        gjk_vec2 ra, rb; /* anchors relative to the centers */
+        float normal_mass;
+        float tangent_mass;
+        float bias;
+        float normal_impulse;
+        float tangent_impulse;
+    } points[2];
+    uint8_t count;
+};
+
+static float world_cross(gjk_vec2 a, gjk_vec2 b)         { return a.x * b.y - a.y * b.x; }
+static gjk_vec2 world_cross_sv(float s, gjk_vec2 v)     { return (gjk_vec2) { -s * v.y, s * v.x }; }
+static gjk_vec2 world_scale(gjk_vec2 v, float s)        { return (gjk_vec2) { v.x * s, v.y * s }; }
+
+// ---------------| MASS |-------------------------------
+void world_mass(const gjk_shape* shape, float density, float* mass, float* inertia)
+{
+    float r = shape->radius;
+    switch (shape->type)
+    {
+    case GJK_CIRCLE:
+        *mass = density * 3.14159265f * r * r;
+        *inertia = 0.5f * *mass * r * r;
+        return;
+    case GJK_BOX:
+    {
+        gjk_vec2 e = shape->extents;
+        *mass = density * 4.0f * e.x * e.y;
+        *inertia = *mass * (e.x * e.x + e.y * e.y) / 3.0f;
+        return;
+    }
+    case GJK_ELLIPSE:
+    {
+        gjk_vec2 e = shape->extents;
+        *mass = density * 3.14159265f * e.x * e.y;
+        *inertia = 0.25f * *mass * (e.x * e.x + e.y * e.y);
+        return;
+    }
+    case GJK_CAPSULE:
+    {
+        /* a box between two half circles, the half circles are treated as a circle at the middle */
+        float h = shape->half_length;
+        float box = density * 4.0f * h * r;
+        float circle = density * 3.14159265f * r * r;
+        *mass = box + circle;
+        *inertia = box * (h * h + r * r) / 3.0f + circle * (0.5f * r * r + h * h);
+        return;
+    }
+    case GJK_POLY:
+    case GJK_ROUNDED:
+    {
+        /* triangle fan around the centroid, the radius of rounded polygons is ignored */
+        float area = 0.0f, moment = 0.0f;
+        for (size_t i = 0; i < shape->count; ++i)
+        {
+            gjk_vec2 e1 = gjk_sub(shape->vertices[i], shape->centroid);
+            gjk_vec2 e2 = gjk_sub(shape->vertices[i + 1 < shape->count ? i + 1 : 0], shape->centroid);
+            float d = world_cross(e1, e2);
+            area += 0.5f * d;
+            moment += d * (gjk_dot_product(e1, e1) + gjk_dot_product(e1, e2) + gjk_dot_product(e2, e2)) / 12.0f;
+        }
+        *mass = density * fabsf(area);
+        *inertia = density * fabsf(moment);
+        return;
+    }
+    default:
+        *mass = 0.0f;
+        *inertia = 0.0f;
+        return;
+    }
+}
+
+// ---------------| STORAGE |----------------------------
+void world_init(world* world, gjk_vec2 gravity)
+{
+    memset(world, 0, sizeof(*world));
+    world->contact_free = WORLD_NULL;
+    world->gravity = gravity;
+    world->iterations = WORLD_DEFAULT_ITERATIONS;
+    world->allow_sleep = 1;
+    aabb_tree_init(&world->tree, WORLD_AABB_MARGIN);
+}
+
+void world_destroy(world* world)
+{
+    aabb_tree_destroy(&world->tree);
+    free(world->bodies);
+    free(world->contacts);
+    free(world->awake);
+    free(world->islands);
+    free(world->heads);
+    free(world->island_sleep);
+    free(world->touching);
+    free(world->constraints);
+    memset(world, 0, sizeof(*world));
+}
+
+static uint8_t world_reserve_bodies(world* world)
+{
+    if (world->body_count < world->body_capacity) return 1;
+
+    uint32_t capacity = world->body_capacity ? world->body_capacity * 2 : WORLD_INITIAL_CAPACITY;
+
+    world_body* bodies = realloc(world->bodies, sizeof(world_body) * capacity);
+    if (bodies) world->bodies = bodies;
+    uint32_t* awake = realloc(world->awake, sizeof(uint32_t) * capacity);
+    if (awake) world->awake = awake;
+    uint32_t* islands = realloc(world->islands, sizeof(uint32_t) * capacity);
+    if (islands) world->islands = islands;
+    int32_t* heads = realloc(world->heads, sizeof(int32_t) * capacity);
+    if (heads) world->heads = heads;
+    float* island_sleep = realloc(world->island_sleep, sizeof(float) * capacity);
+    if (island_sleep) world->island_sleep = island_sleep;
+
+    if (!bodies || !awake || !islands || !heads || !island_sleep) return 0;
+
+    world->body_capacity = capacity;
+    return 1;
+}
+
+static int32_t world_alloc_contact(world* world)
+{
+    if (world->contact_free == WORLD_NULL)
+    {
+        int32_t capacity = world->contact_capacity ? world->contact_capacity * 2 : WORLD_INITIAL_CAPACITY;
+
+        world_contact* contacts = realloc(world->contacts, sizeof(world_contact) * capacity);
+        if (contacts) world->contacts = contacts;
+        int32_t* touching = realloc(world->touching, sizeof(int32_t) * capacity);
+        if (touching) world->touching = touching;
+        world_constraint* constraints = realloc(world->constraints, sizeof(world_constraint) * capacity);
+        if (constraints) world->constraints = constraints;
+
+        if (!contacts || !touching || !constraints) return WORLD_NULL;
+
+        for (int32_t i = world->contact_capacity; i < capacity; ++i)
+            contacts[i].next[0] = i + 1 < capacity ? i + 1 : WORLD_NULL;
+
+        world->contact_free = world->contact_capacity;
+        world->contact_capacity = capacity;
+    }
+
+    int32_t index = world->contact_free;
+    world->contact_free = world->contacts[index].next[0];
+    world->contact_count++;
+    return index;
+}
+
+/* which of the two lists of contact c belongs to body */
+static int world_side(const world* world, int32_t c, uint32_t body)
+{
+    return world->contacts[c].a == body ? 0 : 1;
+}
+
+static void world_link_contact(world* world, int32_t c)
+{
+    world_contact* contact = &world->contacts[c];
+    for (int s = 0; s < 2; ++s)
+    {
+        uint32_t body = s ? contact->b : contact->a;
+        int32_t head = world->bodies[body].contacts;
+
+        contact->prev[s] = WORLD_NULL;
+        contact->next[s] = head;
+        if (head != WORLD_NULL) world->contacts[head].prev[world_side(world, head, body)] = c;
+        world->bodies[body].contacts = c;
+    }
+}
+
+static void world_destroy_contact(world* world, int32_t c)
+{
+    world_contact* contact = &world->contacts[c];
+    for (int s = 0; s < 2; ++s)
+    {
+        uint32_t body = s ? contact->b : contact->a;
+        int32_t prev = contact->prev[s];
+        int32_t next = contact->next[s];
+
+        if (prev != WORLD_NULL) world->contacts[prev].next[world_side(world, prev, body)] = next;
+        else                    world->bodies[body].contacts = next;
+
+        if (next != WORLD_NULL) world->contacts[next].prev[world_side(world, next, body)] = prev;
+    }
+
+    contact->next[0] = world->contact_free;
+    world->contact_free = c;
+    world->contact_count--;
+}
+
+typedef struct
+{
+    world* world;
+    uint32_t body;
+} world_pair_query;
+
+/* creates a contact for a new overlap in the broadphase */
+static void world_add_pair(void* user, uint32_t other)
+{
+    world_pair_query* query = user;
+    world* world = query->world;
+    uint32_t body = query->body;
+
+    if (other == body) return;
+    if (world->bodies[body].type != WORLD_DYNAMIC && world->bodies[other].type != WORLD_DYNAMIC) return;
+
+    /* search the list of the dynamic body, static bodies can have long lists */
+    uint32_t owner = world->bodies[body].type == WORLD_DYNAMIC ? body : other;
+    uint32_t partner = owner == body ? other : body;
+    for (int32_t c = world->bodies[owner].contacts; c != WORLD_NULL; c = world->contacts[c].next[world_side(world, c, owner)])
+    {
+        const world_contact* contact = &world->contacts[c];
+        if (contact->a == partner || contact->b == partner) return;
+    }
+
+    int32_t c = world_alloc_contact(world);
+    if (c == WORLD_NULL) return;
+
+    world_contact* contact = &world->contacts[c];
+    memset(contact, 0, sizeof(*contact));
+    contact->a = body < other ? body : other;
+    contact->b = body < other ? other : body;
+    world_link_contact(world, c);
+}
+
+static void world_query_pairs(world* world, uint32_t body)
+{
+    world_pair_query query = { world, body };
+    aabb_tree_query(&world->tree, world->tree.nodes[world->bodies[body].proxy].aabb, world_add_pair, &query);
+}
+
+// ---------------| BODIES |-----------------------------
+int32_t world_add_body(world* world, const gjk_shape* shape, world_body_type type, float density, float friction)
+{
+    if (!world_reserve_bodies(world)) return WORLD_NULL;
+
+    uint32_t index = world->body_count;
+    world_body* body = &world->bodies[index];
+    memset(body, 0, sizeof(*body));
+
+    body->shape = *shape;
+    body->type = type;
+    body->friction = friction;
+    body->contacts = WORLD_NULL;
+    body->island = WORLD_NULL;
+    body->island_next = WORLD_NULL;
+
+    if (type == WORLD_DYNAMIC)
+    {
+        float mass, inertia;
+        world_mass(shape, density, &mass, &inertia);
+        body->inv_mass = mass > 0.0f ? 1.0f / mass : 0.0f;
+        body->inv_inertia = inertia > 0.0f ? 1.0f / inertia : 0.0f;
+    }
+
+    body->proxy = aabb_tree_insert(&world->tree, gjk_shape_aabb(shape), index);
+    if (body->proxy == AABB_TREE_NULL) return WORLD_NULL;
+
+    world->body_count++;
+    if (type == WORLD_DYNAMIC)
+    {
+        body->awake = 1;
+        world->awake[world->awake_count++] = index;
+    }
+
+    world_query_pairs(world, index);
+    return (int32_t)index;
+}
+
+void world_wake_body(world* world, uint32_t body)
+{
+    world_body* b = &world->bodies[body];
+    if (b->type != WORLD_DYNAMIC || b->awake) return;
+
+    int32_t i = b->island;
+    while (i != WORLD_NULL)
+    {
+        world_body* member = &world->bodies[i];
+        int32_t next = member->island_next;
+
+        member->awake = 1;
+        member->sleep_time = 0.0f;
+        member->island = WORLD_NULL;
+        member->island_next = WORLD_NULL;
+        world->awake[world->awake_count++] = (uint32_t)i;
+
+        i = next;
+    }
+}
+
+void world_apply_impulse(world* world, uint32_t body, gjk_vec2 impulse, gjk_vec2 point)
+{
+    world_wake_body(world, body);
+
+    world_body* b = &world->bodies[body];
+    b->velocity = gjk_add(b->velocity, world_scale(impulse, b->inv_mass));
+    b->angular_velocity += b->inv_inertia * world_cross(gjk_sub(point, b->shape.center), impulse);
+}
+
+// ---------------| STEP |-------------------------------
+/*
+ * updates the contacts of the awake bodies and collects the touching ones.
+ * A touching contact wakes the island on the other side, whose bodies are
+ * appended to the awake list and collided in the same loop.
+ */
+static void world_collide(world* world)
+{
+    world->touching_count = 0;
+
+    for (uint32_t i = 0; i < world->awake_count; ++i)
+    {
+        uint32_t body = world->awake[i];
+
+        int32_t c = world->bodies[body].contacts;
+        while (c != WORLD_NULL)
+        {
+            world_contact* contact = &world->contacts[c];
+            int32_t next = contact->next[world_side(world, c, body)];
+
+            if (contact->tick == world->tick)
+            {
+                c = next;
+                continue;
+            }
+            contact->tick = world->tick;
+
+            world_body* a = &world->bodies[contact->a];
+            world_body* b = &world->bodies[contact->b];
+
+            /* the fattened aabbs stopped overlapping */
+            if (!gjk_aabb_overlap(world->tree.nodes[a->proxy].aabb, world->tree.nodes[b->proxy].aabb))
+            {
+                world_destroy_contact(world, c);
+                c = next;
+                continue;
+            }
+
+            contact->touching = manifold_collide(&a->shape, &b->shape, &contact->cache) > 0;
+            if (contact->touching)
+            {
+                world_wake_body(world, contact->a == body ? contact->b : contact->a);
+                world->touching[world->touching_count++] = c;
+            }
+
+            c = next;
+        }
+    }
+}
+
+static void world_apply(world_body* a, world_body* b, gjk_vec2 ra, gjk_vec2 rb, gjk_vec2 impulse)
+{
+    a->velocity = gjk_sub(a->velocity, world_scale(impulse, a->inv_mass));
+    a->angular_velocity -= a->inv_inertia * world_cross(ra, impulse);
+    b->velocity = gjk_add(b->velocity, world_scale(impulse, b->inv_mass));
+    b->angular_velocity += b->inv_inertia * world_cross(rb, impulse);
+}
+
+static gjk_vec2 world_relative_velocity(const world_body* a, const world_body* b, gjk_vec2 ra, gjk_vec2 rb)
+{
+    gjk_vec2 va = gjk_add(a->velocity, world_cross_sv(a->angular_velocity, ra));
+    gjk_vec2 vb = gjk_add(b->velocity, world_cross_sv(b->angular_velocity, rb));
+    return gjk_sub(vb, va);
+}
+
+static void world_prepare(world* world, float dt)
+{
+    for (uint32_t i = 0; i < world->touching_count; ++i)
+    {
+        world_constraint* constraint = &world->constraints[i];
+        world_contact* contact = &world->contacts[world->touching[i]];
+        const manifold* m = &contact->cache.manifold;
+
+        world_body* a = &world->bodies[contact->a];
+        world_body* b = &world->bodies[contact->b];
+
+        constraint->a = contact->a;
+        constraint->b = contact->b;
+        constraint->contact = world->touching[i];
+        constraint->normal = m->normal;
+        constraint->friction = sqrtf(a->friction * b->friction);
+        constraint->count = m->count;
+
+        gjk_vec2 n = m->normal;
+        gjk_vec2 t = gjk_perpendicular(n);
+        float inv_mass = a->inv_mass + b->inv_mass;
+
+        for (uint8_t p = 0; p < m->count; ++p)
+        {
+            const manifold_point* mp = &m->points[p];
+            gjk_vec2 ra = gjk_sub(mp->point, a->shape.center);
+            gjk_vec2 rb = gjk_sub(mp->point, b->shape.center);
+
+            float rna = world_cross(ra, n), rnb = world_cross(rb, n);
+            float rta = world_cross(ra, t), rtb = world_cross(rb, t);
+            float kn = inv_mass + a->inv_inertia * rna * rna + b->inv_inertia * rnb * rnb;
+            float kt = inv_mass + a->inv_inertia * rta * rta + b->inv_inertia * rtb * rtb;
+
+            constraint->points[p].ra = ra;
+            constraint->points[p].rb = rb;
+            constraint->points[p].normal_mass = kn > 0.0f ? 1.0f / kn : 0.0f;
+            constraint->points[p].tangent_mass = kt > 0.0f ? 1.0f / kt : 0.0f;
+
+            /* baumgarte stabilization pushes out the penetration beyond the slop */
+            float separation = mp->separation + WORLD_LINEAR_SLOP;
+            constraint->points[p].bias = separation < 0.0f ? -WORLD_BAUMGARTE / dt * separation : 0.0f;
+
+            /* warm start with the impulses matched by manifold_collide */
+            constraint->points[p].normal_impulse = mp->normal_impulse;
+            constraint->points[p].tangent_impulse = mp->tangent_impulse;
+
+            gjk_vec2 impulse = gjk_add(world_scale(n, mp->normal_impulse), world_scale(t, mp->tangent_impulse));
+            world_apply(a, b, ra, rb, impulse);
+        }
+    }
+}
+
+static void world_solve(world* world)
+{
+    for (uint32_t i = 0; i < world->touching_count; ++i)
+    {
+        world_constraint* constraint = &world->constraints[i];
+        world_body* a = &world->bodies[constraint->a];
+        world_body* b = &world->bodies[constraint->b];
+
+        gjk_vec2 n = constraint->normal;
+        gjk_vec2 t = gjk_perpendicular(n);
+
+        for (uint8_t p = 0; p < constraint->count; ++p)
+        {
+            gjk_vec2 ra = constraint->points[p].ra;
+            gjk_vec2 rb = constraint->points[p].rb;
+
+            /* normal impulse, the accumulated impulse stays positive */
+            float vn = gjk_dot_product(world_relative_velocity(a, b, ra, rb), n);
+            float lambda = -constraint->points[p].normal_mass * (vn - constraint->points[p].bias);
+            float old = constraint->points[p].normal_impulse;
+            float accumulated = old + lambda > 0.0f ? old + lambda : 0.0f;
+            constraint->points[p].normal_impulse = accumulated;
+            world_apply(a, b, ra, rb, world_scale(n, accumulated - old));
+
+            /* friction, clamped by the normal impulse */
+            float vt = gjk_dot_product(world_relative_velocity(a, b, ra, rb), t);
+            float max = constraint->friction * accumulated;
+            lambda = -constraint->points[p].tangent_mass * vt;
+            old = constraint->points[p].tangent_impulse;
+            accumulated = old + lambda;
+            accumulated = accumulated < -max ? -max : (accumulated > max ? max : accumulated);
+            constraint->points[p].tangent_impulse = accumulated;
+            world_apply(a, b, ra, rb, world_scale(t, accumulated - old));
+        }
+    }
+}
+
+/* keeps the impulses for warm starting the next step */
+static void world_store_impulses(world* world)
+{
+    for (uint32_t i = 0; i < world->touching_count; ++i)
+    {
+        const world_constraint* constraint = &world->constraints[i];
+        manifold* m = &world->contacts[constraint->contact].cache.manifold;
+        for (uint8_t p = 0; p < constraint->count; ++p)
+        {
+            m->points[p].normal_impulse = constraint->points[p].normal_impulse;
+            m->points[p].tangent_impulse = constraint->points[p].tangent_impulse;
+        }
+    }
+}
+
+static void world_integrate_velocities(world* world, float dt)
+{
+    for (uint32_t i = 0; i < world->awake_count; ++i)
+    {
+        world_body* body = &world->bodies[world->awake[i]];
+        gjk_vec2 acceleration = gjk_add(world->gravity, world_scale(body->force, body->inv_mass));
+        body->velocity = gjk_add(body->velocity, world_scale(acceleration, dt));
+        body->angular_velocity += dt * body->inv_inertia * body->torque;
+    }
+}
+
+/* moves the awake bodies and looks for new pairs of the ones that left their fattened aabb */
+static void world_integrate_positions(world* world, float dt)
+{
+    for (uint32_t i = 0; i < world->awake_count; ++i)
+    {
+        uint32_t index = world->awake[i];
+        world_body* body = &world->bodies[index];
+        gjk_shape* shape = &body->shape;
+
+        gjk_vec2 displacement = world_scale(body->velocity, dt);
+
+        /* compose the rotations and normalize against drift */
+        gjk_rot r = gjk_rotation(body->angular_velocity * dt);
+        gjk_rot rot = { shape->rot.c * r.c - shape->rot.s * r.s, shape->rot.s * r.c + shape->rot.c * r.s };
+        float length = sqrtf(rot.c * rot.c + rot.s * rot.s);
+        gjk_set_transform(shape, gjk_add(shape->center, displacement), (gjk_rot) { rot.c / length, rot.s / length });
+
+        body->force = (gjk_vec2) { 0.0f, 0.0f };
+        body->torque = 0.0f;
+
+        if (aabb_tree_move(&world->tree, body->proxy, gjk_shape_aabb(shape), displacement))
+            world_query_pairs(world, index);
+    }
+}
+
+static uint32_t world_find(uint32_t* parents, uint32_t i)
+{
+    while (parents[i] != i)
+    {
+        parents[i] = parents[parents[i]];
+        i = parents[i];
+    }
+    return i;
+}
+
+/*
+ * builds the islands of the awake bodies with union-find over the touching
+ * contacts. Islands whose bodies all rested long enough fall asleep and are
+ * linked into a list for waking, the other bodies stay in the awake list.
+ */
+static void world_update_sleep(world* world, float dt)
+{
+    uint32_t* parents = world->islands;
+
+    for (uint32_t i = 0; i < world->awake_count; ++i)
+    {
+        uint32_t index = world->awake[i];
+        world_body* body = &world->bodies[index];
+
+        float v = gjk_length_Squared(body->velocity);
+        if (v > WORLD_SLEEP_LINEAR * WORLD_SLEEP_LINEAR || fabsf(body->angular_velocity) > WORLD_SLEEP_ANGULAR)
+            body->sleep_time = 0.0f;
+        else
+            body->sleep_time += dt;
+
+        parents[index] = index;
+        world->island_sleep[index] = FLT_MAX;
+        world->heads[index] = WORLD_NULL;
+    }
+
+    /* static bodies do not connect islands */
+    for (uint32_t i = 0; i < world->touching_count; ++i)
+    {
+        const world_contact* contact = &world->contacts[world->touching[i]];
+        if (world->bodies[contact->a].type != WORLD_DYNAMIC || world->bodies[contact->b].type != WORLD_DYNAMIC) continue;
+
+        uint32_t ra = world_find(parents, contact->a);
+        uint32_t rb = world_find(parents, contact->b);
+        if (ra != rb) parents[ra] = rb;
+    }
+
+    for (uint32_t i = 0; i < world->awake_count; ++i)
+    {
+        uint32_t index = world->awake[i];
+        uint32_t root = world_find(parents, index);
+        float t = world->bodies[index].sleep_time;
+        if (t < world->island_sleep[root]) world->island_sleep[root] = t;
+    }
+
+    /* link the islands going to sleep */
+    for (uint32_t i = 0; i < world->awake_count; ++i)
+    {
+        uint32_t index = world->awake[i];
+        uint32_t root = world_find(parents, index);
+        if (world->island_sleep[root] < WORLD_TIME_TO_SLEEP) continue;
+
+        world_body* body = &world->bodies[index];
+        body->awake = 0;
+        body->velocity = (gjk_vec2) { 0.0f, 0.0f };
+        body->angular_velocity = 0.0f;
+        body->island_next = world->heads[root];
+        world->heads[root] = (int32_t)index;
+    }
+
+    /* every sleeping body points to the first body of its island, the others stay awake */
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < world->awake_count; ++i)
+    {
+        uint32_t index = world->awake[i];
+        world_body* body = &world->bodies[index];
+
+        if (body->awake) world->awake[count++] = index;
+        else             body->island = world->heads[world_find(parents, index)];
+    }
+
+    world->awake_count = count;
+}
+
+void world_step(world* world, float dt)
+{
+    if (dt <= 0.0f) return;
+    world->tick++;
+
+    world_collide(world);
+
+    world_integrate_velocities(world, dt);
+    world_prepare(world, dt);
+    for (uint32_t i = 0; i < world->iterations; ++i)
+        world_solve(world);
+    world_store_impulses(world);
+
+    world_integrate_positions(world, dt);
+
+    if (world->allow_sleep) world_update_sleep(world, dt);
+}
@@ -0,0 +1,121 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include "gjk.h"
+#include "aabb_tree.h"
+#include "manifold.h"
+
+/*
+ * Rigid body world with one gjk_shape per body. A step collides the awake
+ * bodies, solves the contacts with sequential impulses warm started from the
+ * impulses of the last step and integrates the velocities.
+ * Bodies that touch form islands, found with union-find over the touching
+ * contacts. An island falls asleep once all of its bodies were slow for
+ * WORLD_TIME_TO_SLEEP, after that its bodies and contacts are not visited
+ * by a step until an awake body touches one of them. The work of a step
+ * only depends on the awake bodies and their contacts.
+ */
+
+#define WORLD_NULL (-1)
+
+typedef enum
+{
+    WORLD_STATIC,  /* never moves, infinite mass */
+    WORLD_DYNAMIC
+} world_body_type;
+
+typedef struct
+{
+    gjk_shape shape;  /* center and rotation are the pose of the body */
+    world_body_type type;
+
+    gjk_vec2 velocity;
+    float angular_velocity;
+    gjk_vec2 force;   /* cleared after every step */
+    float torque;
+
+    float inv_mass;
+    float inv_inertia;
+    float friction;
+
+    int32_t proxy;    /* leaf in the broadphase tree */
+    int32_t contacts; /* first contact of the body */
+
+    /* sleeping */
+    float sleep_time;
+    int32_t island;      /* first body of the sleeping island */
+    int32_t island_next; /* next body of the sleeping island */
+    uint8_t awake;
+} world_body;
+
+typedef struct
+{
+    uint32_t a, b;     /* bodies, a < b */
+    int32_t next[2];   /* next contact in the lists of a and b, also the free list */
+    int32_t prev[2];
+    manifold_cache cache;
+    uint64_t tick;     /* last step that collided the contact */
+    uint8_t touching;
+} world_contact;
+
+typedef struct world_constraint world_constraint;
+
+typedef struct
+{
+    world_body* bodies;
+    uint32_t body_count;
+    uint32_t body_capacity;
+
+    world_contact* contacts;
+    int32_t contact_count;
+    int32_t contact_capacity;
+    int32_t contact_free;
+
+    aabb_tree tree;
+
+    gjk_vec2 gravity;
+    uint32_t iterations; /* velocity iterations of the solver */
+    uint8_t allow_sleep;
+    uint64_t tick;
+
+    /* bodies visited by a step */
+    uint32_t* awake;
+    uint32_t awake_count;
+
+    /* per step scratch, sized by body and contact capacity */
+    uint32_t* islands;   /* union-find parents */
+    int32_t* heads;      /* first body of every island going to sleep */
+    float* island_sleep; /* minimum sleep time of every island */
+    int32_t* touching;   /* contacts to solve */
+    uint32_t touching_count;
+    world_constraint* constraints;
+} world;
+
+#define WORLD_TIME_TO_SLEEP      0.5f
+#define WORLD_SLEEP_LINEAR       0.05f  /* velocity below which a body counts as resting */
+#define WORLD_SLEEP_ANGULAR      0.035f /* radians per second */
+#define WORLD_BAUMGARTE          0.2f   /* fraction of the penetration resolved per step */
+#define WORLD_LINEAR_SLOP        0.005f
+#define WORLD_DEFAULT_ITERATIONS 8
+
+void world_init(world* world, gjk_vec2 gravity);
+void world_destroy(world* world);
+
+/*
+ * adds a body with the shape placed at its pose and returns its index.
+ * Polygons keep pointing to their vertices, which have to outlive the body.
+ * The mass follows from the area of the shape and density, shapes without
+ * area like segments only work as static bodies.
+ */
+int32_t world_add_body(world* world, const gjk_shape* shape, world_body_type type, float density, float friction);
+
+/* wakes the island of the body */
+void world_wake_body(world* world, uint32_t body);
+void world_apply_impulse(world* world, uint32_t body, gjk_vec2 impulse, gjk_vec2 point);
+
+void world_step(world* world, float dt);
+
+/* mass and rotational inertia about the center of a shape */
+void world_mass(const gjk_shape* shape, float density, float* mass, float* inertia);
+
+#endif // !WORLD_H